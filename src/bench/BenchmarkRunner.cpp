@@ -0,0 +1,236 @@
+﻿#include "bench/BenchmarkRunner.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace pat::bench {
+
+bool BenchmarkState::KeepRunning() {
+    if (!started_) {
+        started_ = true;
+        timer_.start();
+    }
+    if (remaining_ > 0 && error_.isEmpty()) {
+        --remaining_;
+        return true;
+    }
+    if (!paused_) elapsedNs_ += timer_.nsecsElapsed();
+    paused_ = true;
+    return false;
+}
+
+void BenchmarkState::PauseTiming() {
+    if (paused_ || !started_) return;
+    elapsedNs_ += timer_.nsecsElapsed();
+    paused_ = true;
+}
+
+void BenchmarkState::ResumeTiming() {
+    if (!paused_) return;
+    paused_ = false;
+    timer_.restart();
+}
+
+void BenchmarkRunner::Register(const QString& name, BenchmarkFunction function) {
+    entries_.append(Entry{name, std::move(function)});
+}
+
+QVector<BenchmarkResult> BenchmarkRunner::Run(QTextStream& log) const {
+    QVector<BenchmarkResult> results;
+    log << QStringLiteral("%1 %2 %3 %4\n")
+               .arg(QStringLiteral("Benchmark"), -44)
+               .arg(QStringLiteral("Time/iter"), 14)
+               .arg(QStringLiteral("Iterations"), 12)
+               .arg(QStringLiteral("Throughput"), 24);
+    log.flush();
+    for (const auto& entry : entries_) {
+        if (!filter_.isEmpty() && !entry.name.contains(filter_)) continue;
+        const BenchmarkResult result = RunOne(entry);
+        if (!result.error.isEmpty()) {
+            log << QStringLiteral("%1 ERROR: %2\n").arg(result.name, -44).arg(result.error);
+        } else {
+            QString throughput;
+            if (result.bytesPerSecond > 0.0) {
+                throughput = QStringLiteral("%1 MB/s").arg(result.bytesPerSecond / (1024.0 * 1024.0), 0, 'f', 1);
+            } else if (result.itemsPerSecond > 0.0) {
+                throughput = QStringLiteral("%1 M items/s").arg(result.itemsPerSecond * 1e-6, 0, 'f', 2);
+            }
+            log << QStringLiteral("%1 %2 %3 %4\n")
+                       .arg(result.name, -44)
+                       .arg(QStringLiteral("%1 us").arg(result.nsPerIteration * 1e-3, 0, 'f', 1), 14)
+                       .arg(result.iterations, 12)
+                       .arg(throughput, 24);
+        }
+        log.flush();
+        results.append(result);
+    }
+    return results;
+}
+
+BenchmarkResult BenchmarkRunner::RunOne(const Entry& entry) const {
+    BenchmarkResult result;
+    result.name = entry.name;
+
+    // 先单次运行估计耗时，再决定每轮迭代次数以满足最短时间
+    qint64 iterations = 1;
+    {
+        BenchmarkState probe(1);
+        entry.function(probe);
+        if (!probe.Error().isEmpty()) {
+            result.error = probe.Error();
+            return result;
+        }
+        const double probeNs = std::max<double>(1.0, static_cast<double>(probe.ElapsedNs()));
+        const double target = minTimeSeconds_ * 1e9 / std::max(1, repetitions_);
+        iterations = std::clamp<qint64>(static_cast<qint64>(target / probeNs), 1, 1000000000);
+    }
+
+    QVector<double> perIteration;
+    qint64 items = 0;
+    qint64 bytes = 0;
+    for (int rep = 0; rep < std::max(1, repetitions_); ++rep) {
+        BenchmarkState state(iterations);
+        entry.function(state);
+        if (!state.Error().isEmpty()) {
+            result.error = state.Error();
+            return result;
+        }
+        perIteration.append(static_cast<double>(state.ElapsedNs()) / static_cast<double>(state.Iterations()));
+        items = state.ItemsPerIteration();
+        bytes = state.BytesPerIteration();
+    }
+
+    std::sort(perIteration.begin(), perIteration.end());
+    const int n = static_cast<int>(perIteration.size());
+    const double median = (n % 2 == 1) ? perIteration[n / 2] : 0.5 * (perIteration[n / 2 - 1] + perIteration[n / 2]);
+    double mean = 0.0;
+    for (double v : perIteration) mean += v;
+    mean /= n;
+    double variance = 0.0;
+    for (double v : perIteration) variance += (v - mean) * (v - mean);
+
+    result.iterations = iterations;
+    result.repetitions = n;
+    result.nsPerIteration = median;
+    result.minNsPerIteration = perIteration.first();
+    result.stddevNsPerIteration = n > 1 ? std::sqrt(variance / (n - 1)) : 0.0;
+    if (median > 0.0) {
+        result.itemsPerSecond = static_cast<double>(items) * 1e9 / median;
+        result.bytesPerSecond = static_cast<double>(bytes) * 1e9 / median;
+    }
+    return result;
+}
+
+bool WriteResultsJson(const QString& path,
+                      const QJsonObject& context,
+                      const QVector<BenchmarkResult>& results,
+                      QString& errorMessage) {
+    QJsonArray benchmarks;
+    for (const auto& result : results) {
+        QJsonObject obj;
+        obj.insert(QStringLiteral("name"), result.name);
+        if (!result.error.isEmpty()) {
+            obj.insert(QStringLiteral("error"), result.error);
+            benchmarks.append(obj);
+            continue;
+        }
+        obj.insert(QStringLiteral("iterations"), result.iterations);
+        obj.insert(QStringLiteral("repetitions"), result.repetitions);
+        obj.insert(QStringLiteral("real_time_ns"), result.nsPerIteration);
+        obj.insert(QStringLiteral("min_time_ns"), result.minNsPerIteration);
+        obj.insert(QStringLiteral("stddev_ns"), result.stddevNsPerIteration);
+        obj.insert(QStringLiteral("items_per_second"), result.itemsPerSecond);
+        obj.insert(QStringLiteral("bytes_per_second"), result.bytesPerSecond);
+        benchmarks.append(obj);
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("context"), context);
+    root.insert(QStringLiteral("benchmarks"), benchmarks);
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorMessage = QStringLiteral("无法写入结果文件：%1").arg(path);
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    if (!file.commit()) {
+        errorMessage = QStringLiteral("结果文件写入失败：%1").arg(file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool LoadResultsJson(const QString& path, QVector<BenchmarkResult>& outResults, QString& errorMessage) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorMessage = QStringLiteral("无法打开基线文件：%1").arg(path);
+        return false;
+    }
+    QJsonParseError parseError{};
+    const auto doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        errorMessage = QStringLiteral("基线 JSON 解析失败：%1").arg(parseError.errorString());
+        return false;
+    }
+
+    outResults.clear();
+    const auto benchmarks = doc.object().value(QStringLiteral("benchmarks")).toArray();
+    for (const auto& value : benchmarks) {
+        const auto obj = value.toObject();
+        BenchmarkResult result;
+        result.name = obj.value(QStringLiteral("name")).toString();
+        result.error = obj.value(QStringLiteral("error")).toString();
+        result.iterations = obj.value(QStringLiteral("iterations")).toInteger();
+        result.repetitions = obj.value(QStringLiteral("repetitions")).toInt();
+        result.nsPerIteration = obj.value(QStringLiteral("real_time_ns")).toDouble();
+        result.minNsPerIteration = obj.value(QStringLiteral("min_time_ns")).toDouble();
+        result.stddevNsPerIteration = obj.value(QStringLiteral("stddev_ns")).toDouble();
+        result.itemsPerSecond = obj.value(QStringLiteral("items_per_second")).toDouble();
+        result.bytesPerSecond = obj.value(QStringLiteral("bytes_per_second")).toDouble();
+        if (!result.name.isEmpty()) outResults.append(result);
+    }
+    return true;
+}
+
+int CompareResults(const QVector<BenchmarkResult>& baseline,
+                   const QVector<BenchmarkResult>& current,
+                   double maxRegressionPercent,
+                   QTextStream& out) {
+    int regressions = 0;
+    out << QStringLiteral("\n%1 %2 %3 %4\n")
+               .arg(QStringLiteral("Benchmark"), -44)
+               .arg(QStringLiteral("Baseline us"), 14)
+               .arg(QStringLiteral("Current us"), 14)
+               .arg(QStringLiteral("Delta"), 10);
+    for (const auto& cur : current) {
+        if (!cur.error.isEmpty()) continue;
+        const auto it = std::find_if(baseline.begin(), baseline.end(),
+                                     [&cur](const BenchmarkResult& b) { return b.name == cur.name; });
+        if (it == baseline.end() || !it->error.isEmpty() || it->nsPerIteration <= 0.0) {
+            out << QStringLiteral("%1 %2\n").arg(cur.name, -44).arg(QStringLiteral("（基线中无此项）"));
+            continue;
+        }
+        const double delta = (cur.nsPerIteration - it->nsPerIteration) / it->nsPerIteration * 100.0;
+        const bool regressed = delta > maxRegressionPercent;
+        if (regressed) ++regressions;
+        out << QStringLiteral("%1 %2 %3 %4%5\n")
+                   .arg(cur.name, -44)
+                   .arg(it->nsPerIteration * 1e-3, 14, 'f', 1)
+                   .arg(cur.nsPerIteration * 1e-3, 14, 'f', 1)
+                   .arg(QStringLiteral("%1%").arg(delta, 0, 'f', 1), 10)
+                   .arg(regressed ? QStringLiteral("  << 回退") : QString());
+    }
+    out.flush();
+    return regressions;
+}
+
+}  // namespace pat::bench
@@ -0,0 +1,101 @@
+﻿#pragma once
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+class QTextStream;
+
+namespace pat::bench {
+
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    __asm__ __volatile__("" : : "g"(&value) : "memory");
+#else
+    static const volatile void* sink = nullptr;
+    sink = &value;
+#endif
+}
+
+class BenchmarkState {
+public:
+    explicit BenchmarkState(qint64 iterations) : iterations_(iterations), remaining_(iterations) {}
+
+    bool KeepRunning();
+    void PauseTiming();
+    void ResumeTiming();
+    void SetItemsPerIteration(qint64 items) { itemsPerIteration_ = items; }
+    void SetBytesPerIteration(qint64 bytes) { bytesPerIteration_ = bytes; }
+    void SkipWithError(const QString& message) { error_ = message; }
+
+    qint64 Iterations() const { return iterations_; }
+    qint64 ElapsedNs() const { return elapsedNs_; }
+    qint64 ItemsPerIteration() const { return itemsPerIteration_; }
+    qint64 BytesPerIteration() const { return bytesPerIteration_; }
+    const QString& Error() const { return error_; }
+
+private:
+    qint64 iterations_ = 1;
+    qint64 remaining_ = 1;
+    bool started_ = false;
+    bool paused_ = false;
+    QElapsedTimer timer_;
+    qint64 elapsedNs_ = 0;
+    qint64 itemsPerIteration_ = 0;
+    qint64 bytesPerIteration_ = 0;
+    QString error_;
+};
+
+using BenchmarkFunction = std::function<void(BenchmarkState&)>;
+
+struct BenchmarkResult {
+    QString name;
+    qint64 iterations = 0;
+    int repetitions = 0;
+    double nsPerIteration = 0.0;  // 各轮的中位数
+    double minNsPerIteration = 0.0;
+    double stddevNsPerIteration = 0.0;
+    double itemsPerSecond = 0.0;
+    double bytesPerSecond = 0.0;
+    QString error;
+};
+
+class BenchmarkRunner {
+public:
+    void Register(const QString& name, BenchmarkFunction function);
+    void SetFilter(const QString& filter) { filter_ = filter; }
+    void SetMinTimeSeconds(double seconds) { minTimeSeconds_ = seconds; }
+    void SetRepetitions(int repetitions) { repetitions_ = repetitions; }
+
+    QVector<BenchmarkResult> Run(QTextStream& log) const;
+
+private:
+    struct Entry {
+        QString name;
+        BenchmarkFunction function;
+    };
+
+    BenchmarkResult RunOne(const Entry& entry) const;
+
+    QVector<Entry> entries_;
+    QString filter_;
+    double minTimeSeconds_ = 0.5;
+    int repetitions_ = 3;
+};
+
+bool WriteResultsJson(const QString& path,
+                      const QJsonObject& context,
+                      const QVector<BenchmarkResult>& results,
+                      QString& errorMessage);
+bool LoadResultsJson(const QString& path, QVector<BenchmarkResult>& outResults, QString& errorMessage);
+// 返回超过阈值（百分比）的回退项数量
+int CompareResults(const QVector<BenchmarkResult>& baseline,
+                   const QVector<BenchmarkResult>& current,
+                   double maxRegressionPercent,
+                   QTextStream& out);
+
+}  // namespace pat::bench
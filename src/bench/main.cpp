@@ -0,0 +1,317 @@
+﻿#include "bench/BenchmarkRunner.h"
+#include "core/Compression.h"
+#include "core/DataSession.h"
+#include "core/FileReader.h"
+#include "core/FormatDefinition.h"
+#include "core/RecordParser.h"
+#include "core/SeriesExport.h"
+#include "core/SeriesQuery.h"
+#include "synth/SyntheticRecording.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+struct BenchOptions {
+    pat::SyntheticSpec spec;
+    QString filter;
+    QString outPath;
+    QString baselinePath;
+    double minTime = 0.5;
+    int repetitions = 3;
+    double maxRegression = 10.0;
+    int maxPoints = 5000;
+};
+
+bool ParseOptions(const QCoreApplication& app, BenchOptions& options, QString& errorMessage) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("PAT 核心热点路径性能基准"));
+    parser.addHelpOption();
+
+    const QCommandLineOption signalsOption(QStringLiteral("signals"), QStringLiteral("信号数"), QStringLiteral("n"), QStringLiteral("64"));
+    const QCommandLineOption recordOption(QStringLiteral("record-size"), QStringLiteral("记录长度（0 为紧凑排布）"), QStringLiteral("bytes"), QStringLiteral("0"));
+    const QCommandLineOption mixOption(QStringLiteral("type-mix"), QStringLiteral("类型配比，如 int16:4,float32:2"), QStringLiteral("mix"), options.spec.typeMix);
+    const QCommandLineOption sizeOption(QStringLiteral("file-mb"), QStringLiteral("数据文件大小（MB）"), QStringLiteral("mb"), QStringLiteral("32"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("随机种子"), QStringLiteral("n"), QStringLiteral("1"));
+    const QCommandLineOption filterOption(QStringLiteral("filter"), QStringLiteral("只运行名称包含该子串的基准"), QStringLiteral("text"));
+    const QCommandLineOption minTimeOption(QStringLiteral("min-time"), QStringLiteral("每项最短运行时间（秒）"), QStringLiteral("s"), QStringLiteral("0.5"));
+    const QCommandLineOption repsOption(QStringLiteral("repetitions"), QStringLiteral("重复轮数"), QStringLiteral("n"), QStringLiteral("3"));
+    const QCommandLineOption outOption(QStringLiteral("out"), QStringLiteral("结果 JSON 输出路径"), QStringLiteral("path"));
+    const QCommandLineOption baselineOption(QStringLiteral("baseline"), QStringLiteral("与基线 JSON 对比"), QStringLiteral("path"));
+    const QCommandLineOption regressionOption(QStringLiteral("max-regression"), QStringLiteral("允许的最大回退百分比"), QStringLiteral("pct"), QStringLiteral("10"));
+    const QCommandLineOption pointsOption(QStringLiteral("max-points"), QStringLiteral("抽稀目标点数"), QStringLiteral("n"), QStringLiteral("5000"));
+    for (const auto* option : {&signalsOption, &recordOption, &mixOption, &sizeOption, &seedOption, &filterOption,
+                               &minTimeOption, &repsOption, &outOption, &baselineOption, &regressionOption, &pointsOption}) {
+        parser.addOption(*option);
+    }
+    parser.process(app);
+
+    bool ok = true;
+    auto toInt = [&](const QCommandLineOption& option) {
+        bool valueOk = false;
+        const int value = parser.value(option).toInt(&valueOk);
+        ok = ok && valueOk;
+        return value;
+    };
+    auto toDouble = [&](const QCommandLineOption& option) {
+        bool valueOk = false;
+        const double value = parser.value(option).toDouble(&valueOk);
+        ok = ok && valueOk;
+        return value;
+    };
+
+    options.spec.signalCount = toInt(signalsOption);
+    options.spec.recordSize = toInt(recordOption);
+    options.spec.typeMix = parser.value(mixOption);
+    options.spec.fileBytes = static_cast<qint64>(toDouble(sizeOption) * 1024.0 * 1024.0);
+    bool seedOk = false;
+    options.spec.seed = parser.value(seedOption).toULongLong(&seedOk);
+    ok = ok && seedOk;
+    options.minTime = toDouble(minTimeOption);
+    options.repetitions = toInt(repsOption);
+    options.maxRegression = toDouble(regressionOption);
+    options.maxPoints = toInt(pointsOption);
+    options.filter = parser.value(filterOption);
+    options.outPath = parser.value(outOption);
+    options.baselinePath = parser.value(baselineOption);
+    if (!ok || options.repetitions <= 0 || options.maxPoints <= 0) {
+        errorMessage = QStringLiteral("参数非法");
+        return false;
+    }
+    return true;
+}
+
+QJsonObject BuildContext(const BenchOptions& options, const pat::SyntheticRecording& recording) {
+    QJsonObject context;
+    context.insert(QStringLiteral("date"), QDateTime::currentDateTime().toString(Qt::ISODate));
+    context.insert(QStringLiteral("host"), QSysInfo::machineHostName());
+    context.insert(QStringLiteral("os"), QSysInfo::prettyProductName());
+    context.insert(QStringLiteral("cpu_arch"), QSysInfo::currentCpuArchitecture());
+    context.insert(QStringLiteral("num_cpus"), QThread::idealThreadCount());
+    context.insert(QStringLiteral("io_uring"), pat::IsUringAvailable());
+#ifdef NDEBUG
+    context.insert(QStringLiteral("build_type"), QStringLiteral("release"));
+#else
+    context.insert(QStringLiteral("build_type"), QStringLiteral("debug"));
+#endif
+    context.insert(QStringLiteral("signals"), options.spec.signalCount);
+    context.insert(QStringLiteral("record_size"), recording.Format().recordSize);
+    context.insert(QStringLiteral("type_mix"), options.spec.typeMix);
+    context.insert(QStringLiteral("records"), recording.RecordCount());
+    context.insert(QStringLiteral("seed"), QString::number(options.spec.seed));
+    context.insert(QStringLiteral("max_points"), options.maxPoints);
+    return context;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("pat_bench"));
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    BenchOptions options;
+    QString error;
+    if (!ParseOptions(app, options, error)) {
+        err << error << '\n';
+        return 2;
+    }
+
+    pat::SyntheticRecording recording;
+    if (!recording.Configure(options.spec, error)) {
+        err << error << '\n';
+        return 2;
+    }
+
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        err << QStringLiteral("无法创建临时目录\n");
+        return 2;
+    }
+    const QString dataPath = tempDir.filePath(QStringLiteral("bench.bin"));
+    err << QStringLiteral("生成数据：%1 条记录 × %2 字节，%3 个信号\n")
+               .arg(recording.RecordCount())
+               .arg(recording.Format().recordSize)
+               .arg(options.spec.signalCount);
+    err.flush();
+    if (!recording.WriteDataFile(dataPath, error)) {
+        err << error << '\n';
+        return 2;
+    }
+
+    const pat::FormatDefinition& format = recording.Format();
+    const qint64 fileBytes = recording.RecordCount() * format.recordSize;
+    const qint64 sampleCount = recording.RecordCount() * static_cast<qint64>(format.signalFormats.size());
+
+    pat::DataSession session;
+    if (!session.Load(dataPath, format, error)) {
+        err << error << '\n';
+        return 2;
+    }
+    const auto& series = session.Series();
+    const double maxX = session.Statistics().maxX;
+
+    pat::bench::BenchmarkRunner runner;
+    runner.SetFilter(options.filter);
+    runner.SetMinTimeSeconds(options.minTime);
+    runner.SetRepetitions(options.repetitions);
+
+    runner.Register(QStringLiteral("format_load"), [&](pat::bench::BenchmarkState& state) {
+        while (state.KeepRunning()) {
+            pat::FormatDefinition loaded;
+            QString loadError;
+            if (!pat::LoadFormatFromJsonData(recording.FormatJson(), loaded, loadError)) state.SkipWithError(loadError);
+        }
+        state.SetItemsPerIteration(static_cast<qint64>(format.signalFormats.size()));
+        state.SetBytesPerIteration(recording.FormatJson().size());
+    });
+
+    runner.Register(QStringLiteral("parse_file"), [&](pat::bench::BenchmarkState& state) {
+        const pat::RecordParser parser(format);
+        while (state.KeepRunning()) {
+            QVector<pat::Series> parsed;
+            QString parseError;
+            if (!parser.ParseFile(dataPath, parsed, parseError)) state.SkipWithError(parseError);
+            pat::bench::DoNotOptimize(parsed);
+        }
+        state.SetItemsPerIteration(recording.RecordCount());
+        state.SetBytesPerIteration(fileBytes);
+    });
+
+    // 同一文件换读取方式：parse_file 为整文件映射，对照同步分块读与 Async 预读流水线
+    for (const pat::ReadBackend backend : {pat::ReadBackend::Buffered, pat::ReadBackend::Async}) {
+        runner.Register(QStringLiteral("parse_file/%1").arg(pat::ReadBackendName(backend)), [&, backend](pat::bench::BenchmarkState& state) {
+            pat::RecordParser parser(format);
+            parser.SetReadBackend(backend);
+            while (state.KeepRunning()) {
+                QVector<pat::Series> parsed;
+                QString parseError;
+                if (!parser.ParseFile(dataPath, parsed, parseError)) state.SkipWithError(parseError);
+                pat::bench::DoNotOptimize(parsed);
+            }
+            state.SetItemsPerIteration(recording.RecordCount());
+            state.SetBytesPerIteration(fileBytes);
+        });
+    }
+
+    // 压缩变体只在被选中时生成一次；生成发生在 KeepRunning 之前，不计入耗时
+    for (const pat::CompressionKind kind : {pat::CompressionKind::Gzip, pat::CompressionKind::Zstd}) {
+        if (!pat::IsCompressionSupported(kind)) continue;
+        const QString name = QStringLiteral("parse_file/%1").arg(pat::CompressionName(kind));
+        const QString compressedPath = tempDir.filePath(QStringLiteral("bench.bin.%1").arg(pat::CompressionName(kind)));
+        runner.Register(name, [&, kind, compressedPath](pat::bench::BenchmarkState& state) {
+            QString writeError;
+            if (!QFileInfo::exists(compressedPath) &&
+                !recording.WriteDataFile(compressedPath, writeError, pat::SyntheticRecording::ProgressCallback(), kind)) {
+                state.SkipWithError(writeError);
+            }
+            const pat::RecordParser parser(format);
+            while (state.KeepRunning()) {
+                QVector<pat::Series> parsed;
+                QString parseError;
+                if (!parser.ParseFile(compressedPath, parsed, parseError)) state.SkipWithError(parseError);
+                pat::bench::DoNotOptimize(parsed);
+            }
+            state.SetItemsPerIteration(recording.RecordCount());
+            state.SetBytesPerIteration(fileBytes);
+        });
+    }
+
+    runner.Register(QStringLiteral("compute_statistics"), [&](pat::bench::BenchmarkState& state) {
+        while (state.KeepRunning()) {
+            session.ComputeStatistics();
+        }
+        state.SetItemsPerIteration(sampleCount);
+    });
+
+    auto registerDecimate = [&](const QString& name, double fraction) {
+        runner.Register(name, [&, fraction](pat::bench::BenchmarkState& state) {
+            const double span = maxX * fraction;
+            const double minX = (maxX - span) * 0.5;
+            while (state.KeepRunning()) {
+                for (const auto& s : series) {
+                    const QVector<QPointF> decimated = pat::DecimateSamples(s, minX, minX + span, options.maxPoints);
+                    pat::bench::DoNotOptimize(decimated);
+                }
+            }
+            state.SetItemsPerIteration(static_cast<qint64>(static_cast<double>(sampleCount) * fraction));
+        });
+    };
+    registerDecimate(QStringLiteral("decimate/full_range"), 1.0);
+    registerDecimate(QStringLiteral("decimate/zoom_10pct"), 0.1);
+    registerDecimate(QStringLiteral("decimate/zoom_0.1pct"), 0.001);
+
+    runner.Register(QStringLiteral("cursor_lookup"), [&](pat::bench::BenchmarkState& state) {
+        constexpr int kLookups = 4096;
+        QVector<double> positions;
+        positions.reserve(kLookups);
+        quint64 lcg = options.spec.seed;
+        for (int i = 0; i < kLookups; ++i) {
+            lcg = lcg * 6364136223846793005ull + 1442695040888963407ull;
+            positions.append(static_cast<double>(lcg >> 11) * (1.0 / 9007199254740992.0) * maxX);
+        }
+        while (state.KeepRunning()) {
+            for (const auto& s : series) {
+                for (double x : positions) {
+                    double value = 0.0;
+                    pat::InterpolateSample(s, x, value);
+                    pat::bench::DoNotOptimize(value);
+                }
+            }
+        }
+        state.SetItemsPerIteration(static_cast<qint64>(series.size()) * kLookups);
+    });
+
+    auto registerExport = [&](const QString& name, pat::ExportFileFormat fileFormat, const QString& fileName) {
+        runner.Register(name, [&, fileFormat, fileName](pat::bench::BenchmarkState& state) {
+            pat::ExportOptions exportOptions;
+            exportOptions.fileFormat = fileFormat;
+            const QString exportPath = tempDir.filePath(fileName);
+            while (state.KeepRunning()) {
+                QString exportError;
+                if (!pat::ExportSeries(exportPath, series, exportOptions, exportError)) state.SkipWithError(exportError);
+            }
+            state.SetItemsPerIteration(sampleCount);
+            state.SetBytesPerIteration(QFileInfo(exportPath).size());
+        });
+    };
+    registerExport(QStringLiteral("export/csv"), pat::ExportFileFormat::Csv, QStringLiteral("export.csv"));
+    registerExport(QStringLiteral("export/binary"), pat::ExportFileFormat::Binary, QStringLiteral("export.patx"));
+    registerExport(QStringLiteral("export/arrow"), pat::ExportFileFormat::Arrow, QStringLiteral("export.arrow"));
+
+    const QVector<pat::bench::BenchmarkResult> results = runner.Run(out);
+
+    if (!options.outPath.isEmpty() &&
+        !pat::bench::WriteResultsJson(options.outPath, BuildContext(options, recording), results, error)) {
+        err << error << '\n';
+        return 1;
+    }
+
+    if (!options.baselinePath.isEmpty()) {
+        QVector<pat::bench::BenchmarkResult> baseline;
+        if (!pat::bench::LoadResultsJson(options.baselinePath, baseline, error)) {
+            err << error << '\n';
+            return 1;
+        }
+        const int regressions = pat::bench::CompareResults(baseline, results, options.maxRegression, out);
+        if (regressions > 0) {
+            err << QStringLiteral("%1 项超过 %2% 回退阈值\n").arg(regressions).arg(options.maxRegression);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,416 @@
+﻿#include "core/DataSession.h"
+#include "core/PerfCounters.h"
+#include "core/Trace.h"
+#include "synth/SyntheticRecording.h"
+#include "ui/ChartArea.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QEventLoop>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace {
+
+struct RenderOptions {
+    int charts = 4;
+    int signalsPerChart = 4;
+    qint64 points = 1000000;
+    int steps = 60;
+    int warmup = 3;
+    int maxPoints = 5000;
+    int width = 1600;
+    int height = 1200;
+    double frameTimeout = 2.0;
+    quint64 seed = 1;
+    QString typeMix = QStringLiteral("int16:2,float32:1,float64:1");
+    QString filter;
+    QString outPath;
+};
+
+// 一帧：从发起缩放/平移/游标移动到所有露出的图表绘完
+struct FrameSample {
+    qint64 frameNs = 0;
+    qint64 decimateNs = 0;
+    qint64 uploadNs = 0;
+    qint64 renderNs = 0;
+    qint64 points = 0;
+};
+
+struct ScenarioResult {
+    QString name;
+    QVector<FrameSample> frames;
+    int timeouts = 0;
+};
+
+bool ParseOptions(const QApplication& app, RenderOptions& options, QString& errorMessage) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("PAT 图表层离屏渲染基准"));
+    parser.addHelpOption();
+
+    const QCommandLineOption chartsOption(QStringLiteral("charts"), QStringLiteral("图表数"), QStringLiteral("n"), QStringLiteral("4"));
+    const QCommandLineOption signalsOption(QStringLiteral("signals-per-chart"), QStringLiteral("每个图表的信号数"), QStringLiteral("n"), QStringLiteral("4"));
+    const QCommandLineOption pointsOption(QStringLiteral("points"), QStringLiteral("每个信号的采样点数"), QStringLiteral("n"), QStringLiteral("1000000"));
+    const QCommandLineOption mixOption(QStringLiteral("type-mix"), QStringLiteral("类型配比，如 int16:4,float32:2"), QStringLiteral("mix"), options.typeMix);
+    const QCommandLineOption stepsOption(QStringLiteral("steps"), QStringLiteral("每个场景的帧数"), QStringLiteral("n"), QStringLiteral("60"));
+    const QCommandLineOption warmupOption(QStringLiteral("warmup"), QStringLiteral("每个场景开头不计入统计的帧数"), QStringLiteral("n"), QStringLiteral("3"));
+    const QCommandLineOption maxPointsOption(QStringLiteral("max-points"), QStringLiteral("抽稀目标点数"), QStringLiteral("n"), QStringLiteral("5000"));
+    const QCommandLineOption sizeOption(QStringLiteral("size"), QStringLiteral("窗口尺寸"), QStringLiteral("WxH"), QStringLiteral("1600x1200"));
+    const QCommandLineOption timeoutOption(QStringLiteral("frame-timeout"), QStringLiteral("单帧等待重绘的上限（秒）"), QStringLiteral("s"), QStringLiteral("2"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("随机种子"), QStringLiteral("n"), QStringLiteral("1"));
+    const QCommandLineOption filterOption(QStringLiteral("filter"), QStringLiteral("只运行名称包含该子串的场景"), QStringLiteral("text"));
+    const QCommandLineOption outOption(QStringLiteral("out"), QStringLiteral("结果 JSON 输出路径"), QStringLiteral("path"));
+    for (const auto* option : {&chartsOption, &signalsOption, &pointsOption, &mixOption, &stepsOption, &warmupOption,
+                               &maxPointsOption, &sizeOption, &timeoutOption, &seedOption, &filterOption, &outOption}) {
+        parser.addOption(*option);
+    }
+    parser.process(app);
+
+    bool ok = true;
+    auto toInt = [&](const QCommandLineOption& option) {
+        bool valueOk = false;
+        const int value = parser.value(option).toInt(&valueOk);
+        ok = ok && valueOk;
+        return value;
+    };
+
+    options.charts = toInt(chartsOption);
+    options.signalsPerChart = toInt(signalsOption);
+    bool pointsOk = false;
+    options.points = parser.value(pointsOption).toLongLong(&pointsOk);
+    ok = ok && pointsOk;
+    options.typeMix = parser.value(mixOption);
+    options.steps = toInt(stepsOption);
+    options.warmup = toInt(warmupOption);
+    options.maxPoints = toInt(maxPointsOption);
+    const QStringList size = parser.value(sizeOption).split(QLatin1Char('x'));
+    if (size.size() == 2) {
+        bool widthOk = false;
+        bool heightOk = false;
+        options.width = size[0].toInt(&widthOk);
+        options.height = size[1].toInt(&heightOk);
+        ok = ok && widthOk && heightOk;
+    } else {
+        ok = false;
+    }
+    bool timeoutOk = false;
+    options.frameTimeout = parser.value(timeoutOption).toDouble(&timeoutOk);
+    ok = ok && timeoutOk;
+    bool seedOk = false;
+    options.seed = parser.value(seedOption).toULongLong(&seedOk);
+    ok = ok && seedOk;
+    options.filter = parser.value(filterOption);
+    options.outPath = parser.value(outOption);
+    if (!ok || options.charts <= 0 || options.signalsPerChart <= 0 || options.points <= 0 || options.steps <= 0 ||
+        options.warmup < 0 || options.maxPoints <= 0 || options.width <= 0 || options.height <= 0 || options.frameTimeout <= 0.0) {
+        errorMessage = QStringLiteral("参数非法");
+        return false;
+    }
+    return true;
+}
+
+// 先按信号配比得到记录长度，再按每个信号的点数定文件大小
+bool ConfigureRecording(const RenderOptions& options, pat::SyntheticRecording& recording, QString& errorMessage) {
+    pat::SyntheticSpec spec;
+    spec.signalCount = options.charts * options.signalsPerChart;
+    spec.typeMix = options.typeMix;
+    spec.groupCount = 0;
+    spec.mixedTimeUnits = false;
+    spec.seed = options.seed;
+    if (!recording.Configure(spec, errorMessage)) return false;
+    spec.fileBytes = options.points * recording.Format().recordSize;
+    return recording.Configure(spec, errorMessage);
+}
+
+QVector<DisplayGroup> BuildGroups(const RenderOptions& options, const pat::FormatDefinition& format) {
+    QVector<DisplayGroup> groups;
+    for (int chart = 0; chart < options.charts; ++chart) {
+        DisplayGroup group;
+        for (int i = 0; i < options.signalsPerChart; ++i) group.signalIndices.append(chart * options.signalsPerChart + i);
+        group.title = QStringLiteral("图表 %1").arg(chart + 1);
+        group.unit = format.signalFormats[group.signalIndices.first()].unit;
+        group.merged = options.signalsPerChart > 1;
+        groups.append(group);
+    }
+    return groups;
+}
+
+// 处理事件直到当前帧的图表都绘完；超时返回 false
+bool WaitForFrame(qint64 timeoutNs, FrameSample& out) {
+    const qint64 deadline = pat::TraceRecorder::NowNs() + timeoutNs;
+    while (true) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents);
+        const pat::PerfSnapshot snapshot = pat::PerfCounters::Instance().Snapshot();
+        if (snapshot.frameNs >= 0) {
+            out.frameNs = snapshot.frameNs;
+            out.decimateNs = snapshot.decimateNs;
+            out.uploadNs = snapshot.uploadNs;
+            out.renderNs = snapshot.renderNs;
+            out.points = snapshot.decimatedPoints;
+            return true;
+        }
+        if (pat::TraceRecorder::NowNs() >= deadline) return false;
+    }
+}
+
+// 空闲时把上一帧遗留的重绘处理完，避免计入下一帧
+void DrainEvents() {
+    QCoreApplication::processEvents(QEventLoop::AllEvents);
+    QCoreApplication::sendPostedEvents();
+    QCoreApplication::processEvents(QEventLoop::AllEvents);
+}
+
+qint64 Percentile(const QVector<qint64>& sorted, double fraction) {
+    if (sorted.isEmpty()) return 0;
+    // 最近秩法
+    const auto rank = static_cast<qsizetype>(std::ceil(fraction * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<qsizetype>(rank - 1, 0, sorted.size() - 1)];
+}
+
+double Mean(const QVector<FrameSample>& frames, qint64 FrameSample::*field) {
+    if (frames.isEmpty()) return 0.0;
+    double total = 0.0;
+    for (const auto& frame : frames) total += static_cast<double>(frame.*field);
+    return total / static_cast<double>(frames.size());
+}
+
+QVector<qint64> SortedFrameTimes(const ScenarioResult& result) {
+    QVector<qint64> times;
+    times.reserve(result.frames.size());
+    for (const auto& frame : result.frames) times.append(frame.frameNs);
+    std::sort(times.begin(), times.end());
+    return times;
+}
+
+QString FormatMs(double ns) {
+    return QString::number(ns / 1e6, 'f', 2);
+}
+
+void PrintResults(const QVector<ScenarioResult>& results, QTextStream& out) {
+    out << QStringLiteral("%1 %2 %3 %4 %5 %6 %7 %8 %9\n")
+               .arg(QStringLiteral("scenario"), -10)
+               .arg(QStringLiteral("frames"), 7)
+               .arg(QStringLiteral("p50 ms"), 9)
+               .arg(QStringLiteral("p90 ms"), 9)
+               .arg(QStringLiteral("p99 ms"), 9)
+               .arg(QStringLiteral("max ms"), 9)
+               .arg(QStringLiteral("decim ms"), 9)
+               .arg(QStringLiteral("upload ms"), 10)
+               .arg(QStringLiteral("paint ms"), 9);
+    for (const auto& result : results) {
+        const QVector<qint64> times = SortedFrameTimes(result);
+        out << QStringLiteral("%1 %2 %3 %4 %5 %6 %7 %8 %9")
+                   .arg(result.name, -10)
+                   .arg(result.frames.size(), 7)
+                   .arg(FormatMs(static_cast<double>(Percentile(times, 0.50))), 9)
+                   .arg(FormatMs(static_cast<double>(Percentile(times, 0.90))), 9)
+                   .arg(FormatMs(static_cast<double>(Percentile(times, 0.99))), 9)
+                   .arg(FormatMs(static_cast<double>(times.isEmpty() ? 0 : times.last())), 9)
+                   .arg(FormatMs(Mean(result.frames, &FrameSample::decimateNs)), 9)
+                   .arg(FormatMs(Mean(result.frames, &FrameSample::uploadNs)), 10)
+                   .arg(FormatMs(Mean(result.frames, &FrameSample::renderNs)), 9);
+        if (result.timeouts > 0) out << QStringLiteral("  （%1 帧超时）").arg(result.timeouts);
+        out << '\n';
+    }
+    out.flush();
+}
+
+QJsonObject BuildContext(const RenderOptions& options, const pat::SyntheticRecording& recording) {
+    QJsonObject context;
+    context.insert(QStringLiteral("date"), QDateTime::currentDateTime().toString(Qt::ISODate));
+    context.insert(QStringLiteral("host"), QSysInfo::machineHostName());
+    context.insert(QStringLiteral("os"), QSysInfo::prettyProductName());
+    context.insert(QStringLiteral("cpu_arch"), QSysInfo::currentCpuArchitecture());
+    context.insert(QStringLiteral("num_cpus"), QThread::idealThreadCount());
+    context.insert(QStringLiteral("qpa_platform"), QGuiApplication::platformName());
+    context.insert(QStringLiteral("qt_version"), QString::fromLatin1(qVersion()));
+#ifdef NDEBUG
+    context.insert(QStringLiteral("build_type"), QStringLiteral("release"));
+#else
+    context.insert(QStringLiteral("build_type"), QStringLiteral("debug"));
+#endif
+    context.insert(QStringLiteral("charts"), options.charts);
+    context.insert(QStringLiteral("signals_per_chart"), options.signalsPerChart);
+    context.insert(QStringLiteral("points"), recording.RecordCount());
+    context.insert(QStringLiteral("type_mix"), options.typeMix);
+    context.insert(QStringLiteral("max_points"), options.maxPoints);
+    context.insert(QStringLiteral("width"), options.width);
+    context.insert(QStringLiteral("height"), options.height);
+    context.insert(QStringLiteral("steps"), options.steps);
+    context.insert(QStringLiteral("warmup"), options.warmup);
+    context.insert(QStringLiteral("seed"), QString::number(options.seed));
+    return context;
+}
+
+bool WriteResults(const QString& path, const QJsonObject& context, const QVector<ScenarioResult>& results, QString& errorMessage) {
+    QJsonArray scenarios;
+    for (const auto& result : results) {
+        const QVector<qint64> times = SortedFrameTimes(result);
+        QJsonObject obj;
+        obj.insert(QStringLiteral("name"), result.name);
+        obj.insert(QStringLiteral("frames"), result.frames.size());
+        obj.insert(QStringLiteral("timeouts"), result.timeouts);
+        obj.insert(QStringLiteral("frame_p50_ns"), Percentile(times, 0.50));
+        obj.insert(QStringLiteral("frame_p90_ns"), Percentile(times, 0.90));
+        obj.insert(QStringLiteral("frame_p99_ns"), Percentile(times, 0.99));
+        obj.insert(QStringLiteral("frame_max_ns"), times.isEmpty() ? 0 : times.last());
+        obj.insert(QStringLiteral("frame_mean_ns"), Mean(result.frames, &FrameSample::frameNs));
+        obj.insert(QStringLiteral("decimate_mean_ns"), Mean(result.frames, &FrameSample::decimateNs));
+        obj.insert(QStringLiteral("upload_mean_ns"), Mean(result.frames, &FrameSample::uploadNs));
+        obj.insert(QStringLiteral("paint_mean_ns"), Mean(result.frames, &FrameSample::renderNs));
+        obj.insert(QStringLiteral("points_mean"), Mean(result.frames, &FrameSample::points));
+        scenarios.append(obj);
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("context"), context);
+    root.insert(QStringLiteral("scenarios"), scenarios);
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorMessage = QStringLiteral("无法写入结果文件：%1").arg(path);
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    if (!file.commit()) {
+        errorMessage = QStringLiteral("结果文件写入失败：%1").arg(file.errorString());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    // 默认离屏运行，无显示的构建机上也能出结果；显式指定平台时（如在桌面上观察）尊重调用方
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("pat_render_bench"));
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    RenderOptions options;
+    QString error;
+    if (!ParseOptions(app, options, error)) {
+        err << error << '\n';
+        return 2;
+    }
+
+    pat::SyntheticRecording recording;
+    if (!ConfigureRecording(options, recording, error)) {
+        err << error << '\n';
+        return 2;
+    }
+
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        err << QStringLiteral("无法创建临时目录\n");
+        return 2;
+    }
+    const QString dataPath = tempDir.filePath(QStringLiteral("render.bin"));
+    err << QStringLiteral("生成数据：%1 个图表 × %2 个信号 × %3 点\n")
+               .arg(options.charts)
+               .arg(options.signalsPerChart)
+               .arg(recording.RecordCount());
+    err.flush();
+    if (!recording.WriteDataFile(dataPath, error)) {
+        err << error << '\n';
+        return 2;
+    }
+
+    pat::DataSession session;
+    if (!session.Load(dataPath, recording.Format(), error)) {
+        err << error << '\n';
+        return 2;
+    }
+    const double minX = session.Statistics().minX;
+    const double maxX = session.Statistics().maxX;
+    const double fullSpan = maxX - minX;
+
+    ChartArea area;
+    area.resize(options.width, options.height);
+    area.SetDisplayGroups(BuildGroups(options, recording.Format()));
+    area.SetStatistics(session.Statistics());
+    area.SetSeries(&session.Series());
+    area.SetTimeUnit(session.TimeUnit());
+    area.SetMaxVisiblePoints(options.maxPoints);
+    area.show();
+    area.RefreshCharts();
+    DrainEvents();
+    if (area.VisibleChartCount() == 0) {
+        err << QStringLiteral("没有可见的图表，无法计时\n");
+        return 2;
+    }
+
+    const qint64 timeoutNs = static_cast<qint64>(options.frameTimeout * 1e9);
+    QVector<ScenarioResult> results;
+
+    // 每一步执行一次交互并等这一帧绘完；cursorFrame 为 true 时由这里开始一帧（游标移动不经过抽稀）
+    auto runScenario = [&](const QString& name, bool cursorFrame, const std::function<void(int step)>& action) {
+        if (!options.filter.isEmpty() && !name.contains(options.filter)) return;
+        area.ResetXRange();
+        DrainEvents();
+        ScenarioResult result;
+        result.name = name;
+        for (int step = 0; step < options.warmup + options.steps; ++step) {
+            DrainEvents();
+            if (cursorFrame) pat::PerfCounters::Instance().BeginFrame(area.VisibleChartCount());
+            action(step);
+            FrameSample frame;
+            if (!WaitForFrame(timeoutNs, frame)) {
+                ++result.timeouts;
+                continue;
+            }
+            if (step >= options.warmup) result.frames.append(frame);
+        }
+        results.append(result);
+    };
+
+    // 缩放：以 37% 处为中心逐步放大到全程的约千分之一，再逐步还原
+    const int total = options.warmup + options.steps;
+    runScenario(QStringLiteral("zoom"), false, [&](int step) {
+        const int half = std::max(1, total / 2);
+        const int depth = step < half ? step + 1 : std::max(0, total - step - 1);
+        const double span = fullSpan * std::pow(0.001, static_cast<double>(depth) / static_cast<double>(half));
+        const double center = minX + fullSpan * 0.37;
+        area.SetXRange(center - span * 0.5, center + span * 0.5);
+    });
+
+    // 平移：5% 宽的窗口从头扫到尾
+    runScenario(QStringLiteral("pan"), false, [&](int step) {
+        const double span = fullSpan * 0.05;
+        const double start = minX + (fullSpan - span) * static_cast<double>(step) / static_cast<double>(std::max(1, total - 1));
+        area.SetXRange(start, start + span);
+    });
+
+    // 游标：全程视图下游标从左扫到右
+    runScenario(QStringLiteral("cursor"), true, [&](int step) {
+        area.SetCursorX(minX + fullSpan * (static_cast<double>(step) + 0.5) / static_cast<double>(total));
+    });
+
+    PrintResults(results, out);
+
+    if (!options.outPath.isEmpty() && !WriteResults(options.outPath, BuildContext(options, recording), results, error)) {
+        err << error << '\n';
+        return 1;
+    }
+    for (const auto& result : results) {
+        if (result.frames.isEmpty()) {
+            err << QStringLiteral("场景 %1 没有完成的帧\n").arg(result.name);
+            return 1;
+        }
+    }
+    return 0;
+}
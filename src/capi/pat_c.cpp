@@ -0,0 +1,316 @@
+﻿#include "capi/pat_c.h"
+
+#include "core/DataSession.h"
+#include "core/FormatDefinition.h"
+#include "core/MemoryGovernor.h"
+
+#include <QByteArray>
+#include <QString>
+
+#include <algorithm>
+#include <new>
+#include <string>
+#include <vector>
+
+struct pat_format {
+    pat::FormatDefinition definition;
+    // 字符串按信号缓存一份 UTF-8，供 pat_signal_info 返回稳定指针
+    struct SignalText {
+        QByteArray name;
+        QByteArray unit;
+        QByteArray description;
+        QByteArray group;
+        QByteArray valueType;
+    };
+    std::vector<SignalText> texts;
+};
+
+struct pat_session {
+    pat::DataSession session;
+    std::vector<QByteArray> names;
+    QByteArray timeUnit;
+};
+
+namespace {
+
+thread_local std::string lastError;
+
+pat_status Fail(pat_status status, const QString& message) {
+    lastError = message.toStdString();
+    return status;
+}
+
+pat_status Succeed() {
+    lastError.clear();
+    return PAT_OK;
+}
+
+// C 边界不允许异常穿出（核心仅可能抛出 bad_alloc）
+template <typename Fn>
+pat_status Guard(Fn&& fn) {
+    try {
+        return fn();
+    } catch (const std::bad_alloc&) {
+        return Fail(PAT_ERROR_INTERNAL, QStringLiteral("内存不足"));
+    } catch (...) {
+        return Fail(PAT_ERROR_INTERNAL, QStringLiteral("内部错误"));
+    }
+}
+
+pat_status MakeFormat(pat::FormatDefinition definition, pat_format** outFormat) {
+    auto* format = new pat_format;
+    format->definition = std::move(definition);
+    format->texts.reserve(format->definition.signalFormats.size());
+    for (const auto& sig : format->definition.signalFormats) {
+        format->texts.push_back({sig.name.toUtf8(), sig.unit.toUtf8(), sig.description.toUtf8(),
+                                 sig.groupPath.toUtf8(), sig.valueType.toUtf8()});
+    }
+    *outFormat = format;
+    return Succeed();
+}
+
+}  // namespace
+
+extern "C" {
+
+uint32_t pat_api_version(void) {
+    return PAT_C_API_VERSION;
+}
+
+const char* pat_last_error(void) {
+    return lastError.c_str();
+}
+
+pat_status pat_format_open(const char* path, pat_format** out_format) {
+    if (!path || !out_format) return Fail(PAT_ERROR_INVALID_ARGUMENT, QStringLiteral("参数为空"));
+    *out_format = nullptr;
+    return Guard([&]() {
+        pat::FormatDefinition definition;
+        QString error;
+        if (!pat::LoadFormatFromJson(QString::fromUtf8(path), definition, error)) {
+            return Fail(PAT_ERROR_FORMAT, error);
+        }
+        return MakeFormat(std::move(definition), out_format);
+    });
+}
+
+pat_status pat_format_open_json(const char* json, size_t length, pat_format** out_format) {
+    if (!json || !out_format) return Fail(PAT_ERROR_INVALID_ARGUMENT, QStringLiteral("参数为空"));
+    *out_format = nullptr;
+    return Guard([&]() {
+        pat::FormatDefinition definition;
+        QString error;
+        const QByteArray data(json, static_cast<qsizetype>(length));
+        if (!pat::LoadFormatFromJsonData(data, definition, error)) return Fail(PAT_ERROR_FORMAT, error);
+        return MakeFormat(std::move(definition), out_format);
+    });
+}
+
+void pat_format_close(pat_format* format) {
+    delete format;
+}
+
+int32_t pat_format_record_size(const pat_format* format) {
+    return format ? format->definition.recordSize : 0;
+}
+
+int32_t pat_format_signal_count(const pat_format* format) {
+    return format ? static_cast<int32_t>(format->definition.signalFormats.size()) : 0;
+}
+
+pat_status pat_format_signal_info(const pat_format* format, int32_t index, pat_signal_info* out_info) {
+    if (!format || !out_info) return Fail(PAT_ERROR_INVALID_ARGUMENT, QStringLiteral("参数为空"));
+    if (index < 0 || index >= pat_format_signal_count(format)) {
+        return Fail(PAT_ERROR_OUT_OF_RANGE, QStringLiteral("信号索引越界：%1").arg(index));
+    }
+    const auto& sig = format->definition.signalFormats[static_cast<size_t>(index)];
+    const auto& text = format->texts[static_cast<size_t>(index)];
+    out_info->name = text.name.constData();
+    out_info->unit = text.unit.constData();
+    out_info->description = text.description.constData();
+    out_info->group = text.group.constData();
+    out_info->value_type = text.valueType.constData();
+    out_info->byte_offset = sig.byteOffset;
+    out_info->scale = sig.scale;
+    out_info->bias = sig.bias;
+    out_info->time_scale = sig.timeScale;
+    return Succeed();
+}
+
+pat_status pat_session_open(const pat_format* format, const char* data_path, pat_session** out_session) {
+    if (!format || !data_path || !out_session) return Fail(PAT_ERROR_INVALID_ARGUMENT, QStringLiteral("参数为空"));
+    *out_session = nullptr;
+    return Guard([&]() {
+        auto* session = new pat_session;
+        QString error;
+        if (!session->session.Load(QString::fromUtf8(data_path), format->definition, error)) {
+            delete session;
+            return Fail(PAT_ERROR_DATA, error);
+        }
+        session->names.reserve(static_cast<size_t>(session->session.Series().size()));
+        for (const auto& series : session->session.Series()) session->names.push_back(series.name.toUtf8());
+        session->timeUnit = session->session.TimeUnit().toUtf8();
+        *out_session = session;
+        return Succeed();
+    });
+}
+
+void pat_session_close(pat_session* session) {
+    delete session;
+}
+
+int32_t pat_session_signal_count(const pat_session* session) {
+    return session ? static_cast<int32_t>(session->session.Series().size()) : 0;
+}
+
+int64_t pat_session_record_count(const pat_session* session) {
+    if (!session || session->session.Series().isEmpty()) return 0;
+    return session->session.Series().first().Size();
+}
+
+const char* pat_session_time_unit(const pat_session* session) {
+    return session ? session->timeUnit.constData() : "";
+}
+
+int32_t pat_session_find_signal(const pat_session* session, const char* name) {
+    if (!session || !name) return -1;
+    for (size_t i = 0; i < session->names.size(); ++i) {
+        if (session->names[i] == name) return static_cast<int32_t>(i);
+    }
+    return -1;
+}
+
+const char* pat_session_signal_name(const pat_session* session, int32_t index) {
+    if (!session || index < 0 || index >= pat_session_signal_count(session)) return nullptr;
+    return session->names[static_cast<size_t>(index)].constData();
+}
+
+pat_status pat_session_statistics(const pat_session* session, int32_t index, pat_signal_statistics* out_statistics) {
+    if (!session || !out_statistics) return Fail(PAT_ERROR_INVALID_ARGUMENT, QStringLiteral("参数为空"));
+    const auto& all = session->session.PerSignalStatistics();
+    if (index < 0 || index >= all.size()) {
+        return Fail(PAT_ERROR_OUT_OF_RANGE, QStringLiteral("信号索引越界：%1").arg(index));
+    }
+    const pat::SignalStatistics& stats = all[index];
+    out_statistics->count = stats.count;
+    out_statistics->min_value = stats.minValue;
+    out_statistics->max_value = stats.maxValue;
+    out_statistics->mean = stats.mean;
+    out_statistics->std_dev = stats.stdDev;
+    out_statistics->rms = stats.rms;
+    out_statistics->first_time = stats.firstTime;
+    out_statistics->last_time = stats.lastTime;
+    return Succeed();
+}
+
+pat_status pat_session_column(const pat_session* session, int32_t index, pat_column_view* out_view) {
+    if (!session || !out_view) return Fail(PAT_ERROR_INVALID_ARGUMENT, QStringLiteral("参数为空"));
+    if (index < 0 || index >= pat_session_signal_count(session)) {
+        return Fail(PAT_ERROR_OUT_OF_RANGE, QStringLiteral("信号索引越界：%1").arg(index));
+    }
+    const pat::Series& series = session->session.Series()[index];
+    if (!series.IsPlain()) {
+        return Fail(PAT_ERROR_INVALID_ARGUMENT, QStringLiteral("外存模式、压缩列或单精度存储的信号不提供零拷贝列视图，请改用 pat_session_read"));
+    }
+    out_view->values = series.values.constData();
+    out_view->times = series.IsUniform() ? nullptr : series.times.constData();
+    out_view->length = series.Size();
+    out_view->time_origin = series.timeOrigin;
+    out_view->time_step = series.timeStep;
+    return Succeed();
+}
+
+pat_status pat_session_read(const pat_session* session,
+                            int32_t index,
+                            int64_t first,
+                            int64_t count,
+                            double* values,
+                            double* times) {
+    if (!session) return Fail(PAT_ERROR_INVALID_ARGUMENT, QStringLiteral("参数为空"));
+    if (index < 0 || index >= pat_session_signal_count(session)) {
+        return Fail(PAT_ERROR_OUT_OF_RANGE, QStringLiteral("信号索引越界：%1").arg(index));
+    }
+    const pat::Series& series = session->session.Series()[index];
+    if (first < 0 || count < 0 || first > series.Size() || count > series.Size() - first) {
+        return Fail(PAT_ERROR_OUT_OF_RANGE, QStringLiteral("样本范围越界：[%1, %2)，共 %3 个样本").arg(first).arg(first + count).arg(series.Size()));
+    }
+    return Guard([&]() {
+        const qsizetype begin = static_cast<qsizetype>(first);
+        const qsizetype end = begin + static_cast<qsizetype>(count);
+        pat::SeriesReader reader(series);
+        if (values) {
+            qsizetype copied = 0;
+            // 单精度列整段以 float 交出，直接展开到调用方缓冲区，不经读取器的窗口
+            reader.ForEachValueSpan(begin, end, [&](qsizetype spanFirst, const auto* data, qsizetype spanCount) {
+                std::copy(data, data + spanCount, values + (spanFirst - begin));
+                copied += spanCount;
+            });
+            if (copied != end - begin) return Fail(PAT_ERROR_DATA, QStringLiteral("读取外存块失败"));
+        }
+        if (times) {
+            if (series.IsUniform()) {
+                for (qsizetype i = begin; i < end; ++i) times[i - begin] = series.timeOrigin + series.timeStep * static_cast<double>(i);
+            } else {
+                for (qsizetype i = begin; i < end;) {
+                    qsizetype spanFirst = 0;
+                    qsizetype spanCount = 0;
+                    const double* data = reader.TimeSpan(i, spanFirst, spanCount);
+                    const qsizetype stop = std::min(end, spanFirst + spanCount);
+                    if (!data || stop <= i) return Fail(PAT_ERROR_DATA, QStringLiteral("读取外存块失败"));
+                    std::copy(data + (i - spanFirst), data + (stop - spanFirst), times + (i - begin));
+                    i = stop;
+                }
+            }
+        }
+        return Succeed();
+    });
+}
+
+int64_t pat_session_invalid_records(const pat_session* session) {
+    return session ? session->session.LastParseReport().invalidRecords : 0;
+}
+
+pat_status pat_session_column_validity(const pat_session* session, int32_t index, const uint64_t** out_bits) {
+    if (!session || !out_bits) return Fail(PAT_ERROR_INVALID_ARGUMENT, QStringLiteral("参数为空"));
+    if (index < 0 || index >= pat_session_signal_count(session)) {
+        return Fail(PAT_ERROR_OUT_OF_RANGE, QStringLiteral("信号索引越界：%1").arg(index));
+    }
+    const pat::Series& series = session->session.Series()[index];
+    *out_bits = series.HasInvalid() ? reinterpret_cast<const uint64_t*>(series.validity.constData()) : nullptr;
+    return Succeed();
+}
+
+pat_status pat_session_memory_usage(const pat_session* session, int32_t index, pat_memory_usage* out_usage) {
+    if (!session || !out_usage) return Fail(PAT_ERROR_INVALID_ARGUMENT, QStringLiteral("参数为空"));
+    if (index >= pat_session_signal_count(session)) {
+        return Fail(PAT_ERROR_OUT_OF_RANGE, QStringLiteral("信号索引越界：%1").arg(index));
+    }
+    const pat::SessionMemoryUsage usage = session->session.MemoryUsage();
+    if (index < 0) {
+        out_usage->value_bytes = usage.ValueBytes();
+        out_usage->time_bytes = usage.TimeBytes();
+        out_usage->index_bytes = usage.IndexBytes();
+        out_usage->validity_bytes = usage.ValidityBytes();
+        out_usage->chunk_bytes = usage.ChunkBytes();
+        out_usage->total_bytes = usage.TotalBytes();
+        return Succeed();
+    }
+    const pat::SignalMemoryUsage& signal = usage.signalUsage[index];
+    out_usage->value_bytes = signal.valueBytes;
+    out_usage->time_bytes = signal.timeBytes;
+    out_usage->index_bytes = signal.indexBytes;
+    out_usage->validity_bytes = signal.validityBytes;
+    out_usage->chunk_bytes = signal.chunkBytes;
+    out_usage->total_bytes = signal.TotalBytes();
+    return Succeed();
+}
+
+void pat_set_memory_limit(int64_t bytes) {
+    pat::MemoryGovernor::Instance().SetBudget(bytes > 0 ? bytes : 0);
+}
+
+int64_t pat_memory_total(void) {
+    return pat::MemoryGovernor::Instance().TotalBytes();
+}
+
+}  // extern "C"
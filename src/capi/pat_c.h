@@ -0,0 +1,135 @@
+﻿#ifndef PAT_C_H
+#define PAT_C_H
+
+/*
+ * PAT 核心 C API。
+ *
+ * - 所有字符串均为 UTF-8；返回的 const char* 由对应句柄持有，句柄关闭前有效。
+ * - pat_column_view 为零拷贝视图，直接指向会话内已解码的列，会话关闭前有效；只有常驻内存的普通列提供，
+ *   外存模式（超出内存上限时自动启用）、压缩列与单精度存储（格式中 "precision": "float32" 或 "auto"）
+ *   用 pat_session_read 复制读取（单精度样本展开为 double），该接口对所有列可用。
+ * - 会话打开后独立于格式句柄，格式句柄可以先行关闭。
+ * - 不同句柄可在不同线程并发使用；同一句柄的只读查询也可并发。
+ * - 失败时返回非 PAT_OK，可用 pat_last_error() 取本线程最近一次错误描述。
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(PAT_C_BUILDING)
+#    define PAT_C_API __declspec(dllexport)
+#  else
+#    define PAT_C_API __declspec(dllimport)
+#  endif
+#else
+#  define PAT_C_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PAT_C_API_VERSION 2
+
+typedef enum pat_status {
+    PAT_OK = 0,
+    PAT_ERROR_INVALID_ARGUMENT = 1,
+    PAT_ERROR_FORMAT = 2,
+    PAT_ERROR_DATA = 3,
+    PAT_ERROR_OUT_OF_RANGE = 4,
+    PAT_ERROR_INTERNAL = 5
+} pat_status;
+
+typedef struct pat_format pat_format;
+typedef struct pat_session pat_session;
+
+typedef struct pat_signal_info {
+    const char* name;
+    const char* unit;
+    const char* description;
+    const char* group;
+    const char* value_type;
+    int32_t byte_offset;
+    double scale;
+    double bias;
+    double time_scale;
+} pat_signal_info;
+
+typedef struct pat_signal_statistics {
+    int64_t count;
+    double min_value;
+    double max_value;
+    double mean;
+    double std_dev;
+    double rms;
+    double first_time;
+    double last_time;
+} pat_signal_statistics;
+
+/* times 为 NULL 时时间轴均匀：t[i] = time_origin + time_step * i */
+typedef struct pat_column_view {
+    const double* values;
+    const double* times;
+    int64_t length;
+    double time_origin;
+    double time_step;
+} pat_column_view;
+
+/* 常驻内存（字节），共享的时间轴只计入一次；chunk_bytes 为外存模式当前换入的块 */
+typedef struct pat_memory_usage {
+    int64_t value_bytes;
+    int64_t time_bytes;
+    int64_t index_bytes;
+    int64_t validity_bytes;
+    int64_t chunk_bytes;
+    int64_t total_bytes;
+} pat_memory_usage;
+
+PAT_C_API uint32_t pat_api_version(void);
+PAT_C_API const char* pat_last_error(void);
+
+PAT_C_API pat_status pat_format_open(const char* path, pat_format** out_format);
+PAT_C_API pat_status pat_format_open_json(const char* json, size_t length, pat_format** out_format);
+PAT_C_API void pat_format_close(pat_format* format);
+PAT_C_API int32_t pat_format_record_size(const pat_format* format);
+PAT_C_API int32_t pat_format_signal_count(const pat_format* format);
+PAT_C_API pat_status pat_format_signal_info(const pat_format* format, int32_t index, pat_signal_info* out_info);
+
+PAT_C_API pat_status pat_session_open(const pat_format* format, const char* data_path, pat_session** out_session);
+PAT_C_API void pat_session_close(pat_session* session);
+PAT_C_API int32_t pat_session_signal_count(const pat_session* session);
+PAT_C_API int64_t pat_session_record_count(const pat_session* session);
+PAT_C_API const char* pat_session_time_unit(const pat_session* session);
+PAT_C_API int32_t pat_session_find_signal(const pat_session* session, const char* name);
+PAT_C_API const char* pat_session_signal_name(const pat_session* session, int32_t index);
+PAT_C_API pat_status pat_session_statistics(const pat_session* session,
+                                            int32_t index,
+                                            pat_signal_statistics* out_statistics);
+/* 零拷贝列视图，仅常驻内存的普通列可用，其他存储返回 PAT_ERROR_INVALID_ARGUMENT */
+PAT_C_API pat_status pat_session_column(const pat_session* session, int32_t index, pat_column_view* out_view);
+/* 把第 index 个信号的样本 [first, first + count) 复制到调用方缓冲区，任何存储形式均可用（版本 2 起）。
+ * values、times 各需 count 个 double，为 NULL 的一项不读；均匀时间轴按 time_origin + time_step * i 展开 */
+PAT_C_API pat_status pat_session_read(const pat_session* session,
+                                      int32_t index,
+                                      int64_t first,
+                                      int64_t count,
+                                      double* values,
+                                      double* times);
+/* 校验失败的记录数；格式未定义 checksum 时为 0 */
+PAT_C_API int64_t pat_session_invalid_records(const pat_session* session);
+/* 列的有效位图：第 i 个样本有效当且仅当 (bits[i / 64] >> (i % 64)) & 1；
+ * 全部有效时 *out_bits 为 NULL。与 pat_column_view 同样零拷贝，会话关闭前有效。 */
+PAT_C_API pat_status pat_session_column_validity(const pat_session* session, int32_t index, const uint64_t** out_bits);
+/* index < 0 时统计整个会话（含统计量） */
+PAT_C_API pat_status pat_session_memory_usage(const pat_session* session, int32_t index, pat_memory_usage* out_usage);
+
+/* 进程内所有会话合计的解码内存上限，0 表示不限；之后打开的会话估计放不下时改用外存模式 */
+PAT_C_API void pat_set_memory_limit(int64_t bytes);
+PAT_C_API int64_t pat_memory_total(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PAT_C_H */
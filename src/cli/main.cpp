@@ -0,0 +1,577 @@
+﻿#include "core/DataSession.h"
+#include "core/FormatDefinition.h"
+#include "core/MemoryGovernor.h"
+#include "core/ProcessMemory.h"
+#include "core/SeriesExport.h"
+#include "core/TaskScheduler.h"
+#include "core/Trace.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+namespace {
+
+struct CliOptions {
+    QString formatPath;
+    QStringList dataPaths;
+    QStringList signalNames;
+    QString exportDir;
+    pat::ExportFileFormat exportFormat = pat::ExportFileFormat::Csv;
+    QString reportPath;
+    QString tracePath;
+    int jobs = 1;
+    pat::ReadBackend readBackend = pat::ReadBackend::Mmap;
+    QString compression;  // 为空时按格式文件的 compression
+    qint64 memoryBudget = 0;
+    qint64 memoryLimit = 0;
+    bool packColumns = false;
+    pat::ValuePrecision precision = pat::ValuePrecision::Float64;
+    bool hasTimeWindow = false;
+    double startTime = 0.0;
+    double endTime = 0.0;
+    bool quiet = false;
+};
+
+struct FileReport {
+    QString path;
+    bool ok = false;
+    QString error;
+    qint64 fileBytes = 0;
+    qint64 recordCount = 0;
+    qint64 skippedBytes = 0;
+    qint64 missingRecords = 0;
+    int syncGaps = 0;
+    qint64 invalidRecords = 0;
+    double elapsedSeconds = 0.0;
+    qint64 decodedBytes = 0;
+    qint64 spilledBytes = 0;  // 外存模式写入临时文件的字节数
+    pat::SessionMemoryUsage memory;
+    qint64 peakResidentBytes = -1;
+    bool peakIsPerFile = false;
+    QString exportPath;
+    QVector<QString> signalNames;
+    QVector<QString> signalUnits;
+    QVector<pat::SignalStatistics> signalStatistics;
+};
+
+double RecordsPerSecond(const FileReport& report) {
+    return report.elapsedSeconds > 0.0 ? static_cast<double>(report.recordCount) / report.elapsedSeconds : 0.0;
+}
+
+double MegabytesPerSecond(const FileReport& report) {
+    return report.elapsedSeconds > 0.0 ? static_cast<double>(report.fileBytes) / (1024.0 * 1024.0) / report.elapsedSeconds
+                                       : 0.0;
+}
+
+QString FormatBytes(qint64 bytes) {
+    if (bytes < 0) return QStringLiteral("n/a");
+    return QStringLiteral("%1 MB").arg(static_cast<double>(bytes) / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+bool ParseOptions(const QCoreApplication& app, CliOptions& options, QString& errorMessage) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("PAT 批处理工具：按格式文件并行解析数据文件，输出信号统计并可导出"));
+    parser.addHelpOption();
+
+    const QCommandLineOption formatOption({QStringLiteral("f"), QStringLiteral("format")},
+                                          QStringLiteral("格式文件（JSON）"),
+                                          QStringLiteral("path"));
+    const QCommandLineOption jobsOption({QStringLiteral("j"), QStringLiteral("jobs")},
+                                        QStringLiteral("同时处理的文件数，默认等于 CPU 核数；文件在共享任务池中执行，实际并发不超过任务池线程数"),
+                                        QStringLiteral("n"));
+    const QCommandLineOption ioOption(QStringLiteral("io"),
+                                      QStringLiteral("读取方式：mmap、buffered 或 async（io_uring 预读流水线，不可用时用 pread 线程），默认 mmap"),
+                                      QStringLiteral("backend"),
+                                      QStringLiteral("mmap"));
+    const QCommandLineOption compressionOption(QStringLiteral("compression"),
+                                               QStringLiteral("压缩识别：auto（按文件头识别 gzip/zstd）或 none（一律按原始记录解析），覆盖格式文件的 compression"),
+                                               QStringLiteral("mode"));
+    const QCommandLineOption memoryBudgetOption(QStringLiteral("memory-budget"),
+                                                QStringLiteral("每个文件解码数据的常驻内存上限（MB），超出部分换出到临时文件；默认不限"),
+                                                QStringLiteral("mb"));
+    const QCommandLineOption memoryLimitOption(QStringLiteral("memory-limit"),
+                                               QStringLiteral("所有并行处理的文件合计的解码内存上限（MB），估计放不下的文件自动改用外存模式；默认不限"),
+                                               QStringLiteral("mb"));
+    const QCommandLineOption packColumnsOption(QStringLiteral("pack-columns"),
+                                               QStringLiteral("长时间不变的信号按游程存储，其余整数类型的信号按差分 + 位打包压缩存储"));
+    const QCommandLineOption precisionOption(QStringLiteral("precision"),
+                                             QStringLiteral("未在格式中指定 precision 的信号的存储精度：float64、auto（按 value_type 与 scale 选择）或 float32，默认 float64"),
+                                             QStringLiteral("precision"),
+                                             QStringLiteral("float64"));
+    const QCommandLineOption signalsOption({QStringLiteral("s"), QStringLiteral("signals")},
+                                           QStringLiteral("导出的信号名，逗号分隔；默认全部"),
+                                           QStringLiteral("names"));
+    const QCommandLineOption startOption(QStringLiteral("t0"),
+                                         QStringLiteral("导出时间窗起点（时间轴单位）"),
+                                         QStringLiteral("time"));
+    const QCommandLineOption endOption(QStringLiteral("t1"),
+                                       QStringLiteral("导出时间窗终点（时间轴单位）"),
+                                       QStringLiteral("time"));
+    const QCommandLineOption exportOption({QStringLiteral("e"), QStringLiteral("export-dir")},
+                                          QStringLiteral("导出目录，每个数据文件一个导出文件"),
+                                          QStringLiteral("dir"));
+    const QCommandLineOption exportFormatOption(QStringLiteral("export-format"),
+                                                QStringLiteral("导出格式：csv、bin（PATX 二进制）或 arrow（Arrow IPC），默认 csv"),
+                                                QStringLiteral("format"),
+                                                QStringLiteral("csv"));
+    const QCommandLineOption reportOption({QStringLiteral("r"), QStringLiteral("report")},
+                                          QStringLiteral("JSON 报告输出路径（含吞吐量、内存与信号统计）"),
+                                          QStringLiteral("path"));
+    const QCommandLineOption traceOption(QStringLiteral("trace"),
+                                         QStringLiteral("把解析、统计、导出等阶段的耗时区间写成 Chrome trace_event JSON"),
+                                         QStringLiteral("path"));
+    const QCommandLineOption quietOption({QStringLiteral("q"), QStringLiteral("quiet")},
+                                         QStringLiteral("不在标准输出打印逐信号统计"));
+    parser.addOption(formatOption);
+    parser.addOption(jobsOption);
+    parser.addOption(ioOption);
+    parser.addOption(compressionOption);
+    parser.addOption(memoryBudgetOption);
+    parser.addOption(memoryLimitOption);
+    parser.addOption(packColumnsOption);
+    parser.addOption(precisionOption);
+    parser.addOption(signalsOption);
+    parser.addOption(startOption);
+    parser.addOption(endOption);
+    parser.addOption(exportOption);
+    parser.addOption(exportFormatOption);
+    parser.addOption(reportOption);
+    parser.addOption(traceOption);
+    parser.addOption(quietOption);
+    parser.addPositionalArgument(QStringLiteral("data"), QStringLiteral("数据文件"), QStringLiteral("data..."));
+    parser.process(app);
+
+    options.formatPath = parser.value(formatOption);
+    if (options.formatPath.isEmpty()) {
+        errorMessage = QStringLiteral("缺少 --format");
+        return false;
+    }
+    options.dataPaths = parser.positionalArguments();
+    if (options.dataPaths.isEmpty()) {
+        errorMessage = QStringLiteral("缺少数据文件");
+        return false;
+    }
+
+    options.jobs = std::max(1, QThread::idealThreadCount());
+    if (parser.isSet(jobsOption)) {
+        bool ok = false;
+        options.jobs = parser.value(jobsOption).toInt(&ok);
+        if (!ok || options.jobs <= 0) {
+            errorMessage = QStringLiteral("--jobs 非法：%1").arg(parser.value(jobsOption));
+            return false;
+        }
+    }
+
+    if (!pat::ParseReadBackend(parser.value(ioOption), options.readBackend)) {
+        errorMessage = QStringLiteral("--io 非法：%1").arg(parser.value(ioOption));
+        return false;
+    }
+
+    if (parser.isSet(compressionOption)) {
+        options.compression = parser.value(compressionOption).toLower();
+        if (options.compression != QStringLiteral("auto") && options.compression != QStringLiteral("none")) {
+            errorMessage = QStringLiteral("--compression 非法：%1").arg(parser.value(compressionOption));
+            return false;
+        }
+    }
+    if (parser.isSet(memoryBudgetOption)) {
+        bool ok = false;
+        const qint64 megabytes = parser.value(memoryBudgetOption).toLongLong(&ok);
+        if (!ok || megabytes < 0) {
+            errorMessage = QStringLiteral("--memory-budget 非法：%1").arg(parser.value(memoryBudgetOption));
+            return false;
+        }
+        options.memoryBudget = megabytes * 1024 * 1024;
+    }
+
+    if (parser.isSet(memoryLimitOption)) {
+        bool ok = false;
+        const qint64 megabytes = parser.value(memoryLimitOption).toLongLong(&ok);
+        if (!ok || megabytes < 0) {
+            errorMessage = QStringLiteral("--memory-limit 非法：%1").arg(parser.value(memoryLimitOption));
+            return false;
+        }
+        options.memoryLimit = megabytes * 1024 * 1024;
+    }
+
+    options.packColumns = parser.isSet(packColumnsOption);
+    if (!pat::ParseValuePrecision(parser.value(precisionOption), options.precision)) {
+        errorMessage = QStringLiteral("--precision 非法：%1").arg(parser.value(precisionOption));
+        return false;
+    }
+
+    if (parser.isSet(signalsOption)) {
+        options.signalNames = parser.value(signalsOption).split(',', Qt::SkipEmptyParts);
+    }
+
+    if (parser.isSet(startOption) || parser.isSet(endOption)) {
+        bool okStart = true;
+        bool okEnd = true;
+        options.hasTimeWindow = true;
+        options.startTime = parser.isSet(startOption) ? parser.value(startOption).toDouble(&okStart)
+                                                      : -std::numeric_limits<double>::infinity();
+        options.endTime = parser.isSet(endOption) ? parser.value(endOption).toDouble(&okEnd)
+                                                  : std::numeric_limits<double>::infinity();
+        if (!okStart || !okEnd || options.endTime < options.startTime) {
+            errorMessage = QStringLiteral("时间窗 --t0/--t1 非法");
+            return false;
+        }
+    }
+
+    options.exportDir = parser.value(exportOption);
+    const QString exportFormat = parser.value(exportFormatOption).toLower();
+    if (exportFormat == "bin" || exportFormat == "patx") {
+        options.exportFormat = pat::ExportFileFormat::Binary;
+    } else if (exportFormat == "arrow" || exportFormat == "feather") {
+        options.exportFormat = pat::ExportFileFormat::Arrow;
+    } else if (exportFormat != "csv") {
+        errorMessage = QStringLiteral("--export-format 非法：%1").arg(exportFormat);
+        return false;
+    }
+    options.reportPath = parser.value(reportOption);
+    options.tracePath = parser.value(traceOption);
+    options.quiet = parser.isSet(quietOption);
+    return true;
+}
+
+bool ResolveSignalIndices(const pat::FormatDefinition& format,
+                          const QStringList& names,
+                          QVector<int>& outIndices,
+                          QString& errorMessage) {
+    outIndices.clear();
+    for (const auto& rawName : names) {
+        const QString name = rawName.trimmed();
+        int found = -1;
+        for (int i = 0; i < static_cast<int>(format.signalFormats.size()); ++i) {
+            if (format.signalFormats[static_cast<size_t>(i)].name == name) {
+                found = i;
+                break;
+            }
+        }
+        if (found < 0) {
+            errorMessage = QStringLiteral("格式中不存在信号：%1").arg(name);
+            return false;
+        }
+        outIndices.append(found);
+    }
+    return true;
+}
+
+FileReport ProcessFile(const QString& path,
+                       const pat::FormatDefinition& format,
+                       const CliOptions& options,
+                       const QVector<int>& exportIndices,
+                       bool measurePeakPerFile) {
+    FileReport report;
+    report.path = path;
+    report.fileBytes = QFileInfo(path).size();
+    report.peakIsPerFile = measurePeakPerFile && pat::ResetPeakResidentBytes();
+
+    QElapsedTimer timer;
+    timer.start();
+    pat::DataSession session;
+    session.SetReadBackend(options.readBackend);
+    session.SetMemoryBudget(options.memoryBudget);
+    session.SetPackColumns(options.packColumns);
+    session.SetValuePrecision(options.precision);
+    if (!session.Load(path, format, report.error)) {
+        report.elapsedSeconds = static_cast<double>(timer.nsecsElapsed()) * 1e-9;
+        return report;
+    }
+    report.elapsedSeconds = static_cast<double>(timer.nsecsElapsed()) * 1e-9;
+
+    const auto& series = session.Series();
+    report.recordCount = session.LastParseReport().recordCount;
+    report.skippedBytes = session.LastParseReport().skippedBytes;
+    report.missingRecords = session.LastParseReport().missingRecords;
+    report.syncGaps = static_cast<int>(session.LastParseReport().gaps.size());
+    report.invalidRecords = session.LastParseReport().invalidRecords;
+    for (const auto& s : series) {
+        report.signalNames.append(s.name);
+        report.signalUnits.append(s.unit);
+    }
+    report.memory = session.MemoryUsage();
+    report.decodedBytes = report.memory.TotalBytes();
+    report.spilledBytes = report.memory.spilledBytes;
+    report.signalStatistics = session.PerSignalStatistics();
+
+    if (!options.exportDir.isEmpty()) {
+        pat::ExportOptions exportOptions;
+        exportOptions.signalIndices = exportIndices;
+        exportOptions.hasTimeWindow = options.hasTimeWindow;
+        exportOptions.startTime = options.startTime;
+        exportOptions.endTime = options.endTime;
+        exportOptions.fileFormat = options.exportFormat;
+        exportOptions.timeUnit = session.TimeUnit();
+        QString suffix = QStringLiteral(".csv");
+        if (options.exportFormat == pat::ExportFileFormat::Binary) suffix = QStringLiteral(".patx");
+        if (options.exportFormat == pat::ExportFileFormat::Arrow) suffix = QStringLiteral(".arrow");
+        report.exportPath = QDir(options.exportDir).filePath(QFileInfo(path).completeBaseName() + suffix);
+        if (!pat::ExportSeries(report.exportPath, series, exportOptions, report.error)) {
+            report.peakResidentBytes = pat::PeakResidentBytes();
+            return report;
+        }
+    }
+
+    report.peakResidentBytes = pat::PeakResidentBytes();
+    report.ok = true;
+    return report;
+}
+
+void PrintReport(QTextStream& out, const FileReport& report, bool quiet) {
+    if (!report.ok) {
+        out << QStringLiteral("[失败] %1：%2\n").arg(report.path, report.error);
+        return;
+    }
+    out << QStringLiteral("[完成] %1  记录 %2  耗时 %3 s  %4 rec/s  %5 MB/s  解码内存 %6  峰值 %7%8\n")
+               .arg(report.path)
+               .arg(report.recordCount)
+               .arg(report.elapsedSeconds, 0, 'f', 3)
+               .arg(RecordsPerSecond(report), 0, 'f', 0)
+               .arg(MegabytesPerSecond(report), 0, 'f', 1)
+               .arg(FormatBytes(report.decodedBytes))
+               .arg(FormatBytes(report.peakResidentBytes))
+               .arg(report.peakIsPerFile ? QString() : QStringLiteral("（进程）"));
+    if (report.syncGaps > 0) {
+        out << QStringLiteral("       失步：%1 处，跳过 %2 字节，折合缺失 %3 条记录\n")
+                   .arg(report.syncGaps)
+                   .arg(report.skippedBytes)
+                   .arg(report.missingRecords);
+    }
+    if (report.invalidRecords > 0) {
+        out << QStringLiteral("       校验失败：%1 条记录\n").arg(report.invalidRecords);
+    }
+    if (!report.exportPath.isEmpty()) {
+        out << QStringLiteral("       导出：%1\n").arg(report.exportPath);
+    }
+    if (quiet) return;
+    for (int i = 0; i < report.signalStatistics.size(); ++i) {
+        const auto& stats = report.signalStatistics[i];
+        out << QStringLiteral("       %1 [%2]  n=%3  min=%4  max=%5  mean=%6  std=%7  rms=%8\n")
+                   .arg(report.signalNames.value(i), report.signalUnits.value(i))
+                   .arg(stats.count)
+                   .arg(stats.minValue, 0, 'g', 8)
+                   .arg(stats.maxValue, 0, 'g', 8)
+                   .arg(stats.mean, 0, 'g', 8)
+                   .arg(stats.stdDev, 0, 'g', 8)
+                   .arg(stats.rms, 0, 'g', 8);
+    }
+}
+
+QJsonObject ReportToJson(const FileReport& report) {
+    QJsonObject obj;
+    obj.insert(QStringLiteral("path"), report.path);
+    obj.insert(QStringLiteral("ok"), report.ok);
+    if (!report.error.isEmpty()) obj.insert(QStringLiteral("error"), report.error);
+    obj.insert(QStringLiteral("file_bytes"), report.fileBytes);
+    obj.insert(QStringLiteral("records"), report.recordCount);
+    obj.insert(QStringLiteral("sync_gaps"), report.syncGaps);
+    obj.insert(QStringLiteral("skipped_bytes"), report.skippedBytes);
+    obj.insert(QStringLiteral("missing_records"), report.missingRecords);
+    obj.insert(QStringLiteral("invalid_records"), report.invalidRecords);
+    obj.insert(QStringLiteral("elapsed_s"), report.elapsedSeconds);
+    obj.insert(QStringLiteral("records_per_s"), RecordsPerSecond(report));
+    obj.insert(QStringLiteral("mb_per_s"), MegabytesPerSecond(report));
+    obj.insert(QStringLiteral("decoded_bytes"), report.decodedBytes);
+    obj.insert(QStringLiteral("spilled_bytes"), report.spilledBytes);
+    QJsonObject memory;
+    memory.insert(QStringLiteral("values"), report.memory.ValueBytes());
+    memory.insert(QStringLiteral("times"), report.memory.TimeBytes());
+    memory.insert(QStringLiteral("time_index"), report.memory.IndexBytes());
+    memory.insert(QStringLiteral("validity"), report.memory.ValidityBytes());
+    memory.insert(QStringLiteral("chunks"), report.memory.ChunkBytes());
+    memory.insert(QStringLiteral("statistics"), report.memory.statisticsBytes);
+    memory.insert(QStringLiteral("chunk_budget"), report.memory.chunkBudget);
+    obj.insert(QStringLiteral("memory"), memory);
+    obj.insert(QStringLiteral("peak_rss_bytes"), report.peakResidentBytes);
+    obj.insert(QStringLiteral("peak_rss_per_file"), report.peakIsPerFile);
+    if (!report.exportPath.isEmpty()) obj.insert(QStringLiteral("export"), report.exportPath);
+
+    QJsonArray signalArray;
+    for (int i = 0; i < report.signalStatistics.size(); ++i) {
+        const auto& stats = report.signalStatistics[i];
+        QJsonObject sig;
+        sig.insert(QStringLiteral("name"), report.signalNames.value(i));
+        sig.insert(QStringLiteral("unit"), report.signalUnits.value(i));
+        sig.insert(QStringLiteral("count"), stats.count);
+        sig.insert(QStringLiteral("min"), stats.minValue);
+        sig.insert(QStringLiteral("max"), stats.maxValue);
+        sig.insert(QStringLiteral("mean"), stats.mean);
+        sig.insert(QStringLiteral("std"), stats.stdDev);
+        sig.insert(QStringLiteral("rms"), stats.rms);
+        sig.insert(QStringLiteral("first_time"), stats.firstTime);
+        sig.insert(QStringLiteral("last_time"), stats.lastTime);
+        if (i < report.memory.signalUsage.size()) {
+            const pat::SignalMemoryUsage& usage = report.memory.signalUsage[i];
+            sig.insert(QStringLiteral("storage"), usage.storage);
+            sig.insert(QStringLiteral("resident_bytes"), usage.TotalBytes());
+        }
+        signalArray.append(sig);
+    }
+    obj.insert(QStringLiteral("signals"), signalArray);
+    return obj;
+}
+
+bool WriteJsonReport(const QString& path,
+                     const CliOptions& options,
+                     const std::vector<FileReport>& reports,
+                     QString& errorMessage) {
+    QJsonObject root;
+    root.insert(QStringLiteral("format"), options.formatPath);
+    root.insert(QStringLiteral("jobs"), options.jobs);
+    root.insert(QStringLiteral("io"), pat::ReadBackendName(options.readBackend));
+    root.insert(QStringLiteral("memory_budget_bytes"), options.memoryBudget);
+    root.insert(QStringLiteral("memory_limit_bytes"), options.memoryLimit);
+    root.insert(QStringLiteral("pack_columns"), options.packColumns);
+    root.insert(QStringLiteral("precision"), pat::ValuePrecisionName(options.precision));
+    const pat::TaskSchedulerStats schedulerStats = pat::TaskScheduler::Instance().Stats();
+    QJsonObject scheduler;
+    scheduler.insert(QStringLiteral("workers"), schedulerStats.workerCount);
+    scheduler.insert(QStringLiteral("tasks"), schedulerStats.executed);
+    scheduler.insert(QStringLiteral("stolen"), schedulerStats.stolen);
+    scheduler.insert(QStringLiteral("steal_rate"), schedulerStats.StealRate());
+    root.insert(QStringLiteral("scheduler"), scheduler);
+    QJsonArray files;
+    for (const auto& report : reports) files.append(ReportToJson(report));
+    root.insert(QStringLiteral("files"), files);
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorMessage = QStringLiteral("无法写入报告：%1").arg(path);
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    if (!file.commit()) {
+        errorMessage = QStringLiteral("报告写入失败：%1").arg(file.errorString());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("pat_cli"));
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    CliOptions options;
+    QString error;
+    if (!ParseOptions(app, options, error)) {
+        err << error << '\n';
+        return 2;
+    }
+
+    pat::FormatDefinition format;
+    if (!pat::LoadFormatFromJson(options.formatPath, format, error)) {
+        err << QStringLiteral("格式加载失败：%1\n").arg(error);
+        return 2;
+    }
+    if (!options.compression.isEmpty()) format.detectCompression = options.compression == QStringLiteral("auto");
+
+    QVector<int> exportIndices;
+    if (!ResolveSignalIndices(format, options.signalNames, exportIndices, error)) {
+        err << error << '\n';
+        return 2;
+    }
+    if (!options.exportDir.isEmpty() && !QDir().mkpath(options.exportDir)) {
+        err << QStringLiteral("无法创建导出目录：%1\n").arg(options.exportDir);
+        return 2;
+    }
+
+    pat::MemoryGovernor::Instance().SetBudget(options.memoryLimit);
+
+    const int fileCount = static_cast<int>(options.dataPaths.size());
+    const int jobs = std::min(options.jobs, fileCount);
+    // 单任务时可以在每个文件开始前重置峰值 RSS，得到逐文件的峰值内存
+    const bool measurePeakPerFile = jobs == 1;
+
+    std::vector<FileReport> reports(static_cast<size_t>(fileCount));
+    QMutex outputMutex;
+    int finished = 0;
+
+    if (!options.tracePath.isEmpty()) pat::TraceRecorder::Instance().Start();
+    QElapsedTimer total;
+    total.start();
+
+    // 各文件作为共享任务池中的任务执行，与文件内部的并行解压、统计共用同一组线程；
+    // 主线程按 --jobs 控制同时在处理的文件数，有空位才提交下一个
+    QMutex slotMutex;
+    QWaitCondition slotFree;
+    int running = 0;
+    pat::TaskGroup group(pat::TaskPriority::Normal);
+    for (int i = 0; i < fileCount; ++i) {
+        {
+            QMutexLocker locker(&slotMutex);
+            while (running >= jobs) slotFree.wait(&slotMutex);
+            ++running;
+        }
+        group.Run([&, i]() {
+            FileReport report = ProcessFile(options.dataPaths.at(i), format, options, exportIndices, measurePeakPerFile);
+            {
+                QMutexLocker locker(&outputMutex);
+                ++finished;
+                err << QStringLiteral("(%1/%2) ").arg(finished).arg(fileCount);
+                err.flush();
+                PrintReport(out, report, options.quiet);
+                out.flush();
+                reports[static_cast<size_t>(i)] = std::move(report);
+            }
+            QMutexLocker locker(&slotMutex);
+            --running;
+            slotFree.wakeOne();
+        });
+    }
+    group.Wait();
+
+    qint64 totalBytes = 0;
+    qint64 totalRecords = 0;
+    int failed = 0;
+    for (const auto& report : reports) {
+        totalBytes += report.fileBytes;
+        totalRecords += report.recordCount;
+        if (!report.ok) ++failed;
+    }
+    const double totalSeconds = static_cast<double>(total.nsecsElapsed()) * 1e-9;
+    out << QStringLiteral("合计：%1 个文件（失败 %2），%3 条记录，%4 s，%5 rec/s，%6 MB/s，进程峰值 %7\n")
+               .arg(fileCount)
+               .arg(failed)
+               .arg(totalRecords)
+               .arg(totalSeconds, 0, 'f', 3)
+               .arg(totalSeconds > 0.0 ? static_cast<double>(totalRecords) / totalSeconds : 0.0, 0, 'f', 0)
+               .arg(totalSeconds > 0.0 ? static_cast<double>(totalBytes) / (1024.0 * 1024.0) / totalSeconds : 0.0, 0, 'f', 1)
+               .arg(FormatBytes(pat::PeakResidentBytes()));
+    out.flush();
+
+    if (!options.reportPath.isEmpty() && !WriteJsonReport(options.reportPath, options, reports, error)) {
+        err << error << '\n';
+        return 1;
+    }
+    if (!options.tracePath.isEmpty()) {
+        pat::TraceRecorder::Instance().Stop();
+        if (!pat::TraceRecorder::Instance().WriteChromeJson(options.tracePath, error)) {
+            err << error << '\n';
+            return 1;
+        }
+    }
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,202 @@
+﻿#include "codegen/DecoderGenerator.h"
+
+#include "core/CompiledDecoder.h"
+
+#include <QTextStream>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace pat {
+namespace {
+
+struct FieldType {
+    const char* cppType = nullptr;
+    int size = 0;
+};
+
+FieldType ResolveFieldType(const QString& type) {
+    const auto t = type.toLower();
+    if (t == "int8") return {"qint8", 1};
+    if (t == "uint8") return {"quint8", 1};
+    if (t == "int16") return {"qint16", 2};
+    if (t == "uint16") return {"quint16", 2};
+    if (t == "int32") return {"qint32", 4};
+    if (t == "uint32") return {"quint32", 4};
+    if (t == "float32") return {"float", 4};
+    if (t == "float64") return {"double", 8};
+    return {};
+}
+
+// 17 位有效数字保证 double 往返精确，指纹与运行时一致
+QString DoubleLiteral(double value) {
+    QString text = QString::number(value, 'g', 17);
+    if (!text.contains('.') && !text.contains('e') && !text.contains("inf") && !text.contains("nan")) text += QStringLiteral(".0");
+    return text;
+}
+
+}  // namespace
+
+QString SanitizeIdentifier(const QString& text) {
+    QString out;
+    out.reserve(text.size());
+    for (const QChar ch : text) {
+        const char16_t c = ch.unicode();
+        const bool ok = (c >= u'a' && c <= u'z') || (c >= u'A' && c <= u'Z') || (c >= u'0' && c <= u'9') || c == u'_';
+        out.append(ok ? ch : QChar('_'));
+    }
+    if (out.isEmpty() || out.front().isDigit()) out.prepend(QChar('_'));
+    return out;
+}
+
+bool GenerateDecoderHeader(const FormatDefinition& format,
+                           const QString& identifier,
+                           const QString& sourceName,
+                           QByteArray& outHeader,
+                           QString& errorMessage) {
+    if (format.signalFormats.empty()) {
+        errorMessage = QStringLiteral("格式未包含信号定义");
+        return false;
+    }
+    if (format.recordSize <= 0) {
+        errorMessage = QStringLiteral("record_size 非法");
+        return false;
+    }
+    if (format.endianness != QStringLiteral("little")) {
+        errorMessage = QStringLiteral("当前仅支持 little-endian");
+        return false;
+    }
+    if (format.recordTypes.enabled) {
+        errorMessage = QStringLiteral("编译期解码器不支持多记录类型格式");
+        return false;
+    }
+    for (const auto& sig : format.signalFormats) {
+        if (sig.recordStride != 1 || sig.recordPhase != 0 || sig.hasFrameId) {
+            errorMessage = QStringLiteral("信号 '%1' 为子换向信号，编译期解码器仅支持全速率格式").arg(sig.name);
+            return false;
+        }
+    }
+
+    const int signalCount = static_cast<int>(format.signalFormats.size());
+    std::vector<FieldType> types(signalCount);
+    for (int s = 0; s < signalCount; ++s) {
+        const auto& sig = format.signalFormats[s];
+        types[s] = ResolveFieldType(sig.valueType);
+        if (!types[s].cppType) {
+            errorMessage = QStringLiteral("信号 '%1' 类型不支持：%2").arg(sig.name, sig.valueType);
+            return false;
+        }
+        if (sig.byteOffset < 0 || sig.byteOffset + types[s].size > format.recordSize) {
+            errorMessage = QStringLiteral("信号 '%1' 超出记录长度").arg(sig.name);
+            return false;
+        }
+    }
+
+    // 结构体成员名：s<序号>_<信号名>，保证唯一
+    QStringList memberNames;
+    for (int s = 0; s < signalCount; ++s) {
+        memberNames.append(QStringLiteral("s%1_%2").arg(s).arg(SanitizeIdentifier(format.signalFormats[s].name)));
+    }
+
+    // 字段按偏移排序后无重叠时才能生成紧凑结构体
+    std::vector<int> order(signalCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return format.signalFormats[a].byteOffset < format.signalFormats[b].byteOffset;
+    });
+    bool packable = true;
+    for (int i = 1; i < signalCount; ++i) {
+        const int prev = order[i - 1];
+        if (format.signalFormats[prev].byteOffset + types[prev].size > format.signalFormats[order[i]].byteOffset) {
+            packable = false;
+            break;
+        }
+    }
+
+    const quint64 fingerprint = FormatFingerprint(format);
+    QString text;
+    QTextStream out(&text);
+    out << "// 由 pat_codegen 生成，请勿手工修改\n";
+    out << "// 源格式：" << sourceName << "\n";
+    out << "#pragma once\n\n";
+    out << "#include \"core/CompiledDecoder.h\"\n\n";
+    out << "namespace pat::generated::" << identifier << " {\n\n";
+    out << "inline constexpr quint64 kFingerprint = 0x" << QString::number(fingerprint, 16).rightJustified(16, '0') << "ull;\n";
+    out << "inline constexpr int kRecordSize = " << format.recordSize << ";\n";
+    out << "inline constexpr int kSignalCount = " << signalCount << ";\n\n";
+
+    if (packable) {
+        out << "// 记录的原始布局（小端主机上可直接按此结构体访问）\n";
+        out << "#pragma pack(push, 1)\n";
+        out << "struct Record {\n";
+        int cursor = 0;
+        int padIndex = 0;
+        for (int index : order) {
+            const auto& sig = format.signalFormats[index];
+            if (sig.byteOffset > cursor) {
+                out << "    quint8 pad" << padIndex++ << "_[" << (sig.byteOffset - cursor) << "];\n";
+            }
+            out << "    " << types[index].cppType << ' ' << memberNames[index] << ";\n";
+            cursor = sig.byteOffset + types[index].size;
+        }
+        if (cursor < format.recordSize) out << "    quint8 pad" << padIndex << "_[" << (format.recordSize - cursor) << "];\n";
+        out << "};\n";
+        out << "#pragma pack(pop)\n";
+        out << "static_assert(sizeof(Record) == kRecordSize);\n\n";
+    } else {
+        out << "// 存在重叠字段，不生成 Record 结构体\n\n";
+    }
+
+    out << "namespace fields {\n";
+    for (int s = 0; s < signalCount; ++s) {
+        const auto& sig = format.signalFormats[s];
+        out << "struct " << memberNames[s] << " {\n";
+        out << "    using Raw = " << types[s].cppType << ";\n";
+        out << "    static constexpr int kOffset = " << sig.byteOffset << ";\n";
+        out << "    static constexpr double kScale = " << DoubleLiteral(sig.scale) << ";\n";
+        out << "    static constexpr double kBias = " << DoubleLiteral(sig.bias) << ";\n";
+        out << "};\n";
+    }
+    out << "}  // namespace fields\n\n";
+
+    out << "inline void Decode(const char* records, qint64 count, double* const* out) {\n";
+    out << "    compiled::DecodeRecords<kRecordSize";
+    for (int s = 0; s < signalCount; ++s) out << ",\n                            fields::" << memberNames[s];
+    out << ">(records, count, out);\n";
+    out << "}\n\n";
+
+    out << "inline CompiledDecoder Descriptor() {\n";
+    out << "    CompiledDecoder decoder;\n";
+    out << "    decoder.fingerprint = kFingerprint;\n";
+    out << "    decoder.recordSize = kRecordSize;\n";
+    out << "    decoder.signalCount = kSignalCount;\n";
+    out << "    decoder.decode = &Decode;\n";
+    out << "    decoder.name = \"" << identifier << "\";\n";
+    out << "    return decoder;\n";
+    out << "}\n\n";
+    out << "}  // namespace pat::generated::" << identifier << "\n";
+    out.flush();
+
+    outHeader = text.toUtf8();
+    return true;
+}
+
+QByteArray GenerateRegistrySource(const QStringList& headerNames, const QStringList& identifiers) {
+    QString text;
+    QTextStream out(&text);
+    out << "// 由 pat_codegen 生成，请勿手工修改\n";
+    for (const auto& header : headerNames) out << "#include \"" << header << "\"\n";
+    out << "\nnamespace {\n\n";
+    out << "[[maybe_unused]] const bool kRegistered = [] {\n";
+    for (const auto& identifier : identifiers) {
+        out << "    pat::RegisterCompiledDecoder(pat::generated::" << identifier << "::Descriptor());\n";
+    }
+    out << "    return true;\n";
+    out << "}();\n\n";
+    out << "}  // namespace\n";
+    out.flush();
+    return text.toUtf8();
+}
+
+}  // namespace pat
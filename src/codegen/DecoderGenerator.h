@@ -0,0 +1,24 @@
+﻿#pragma once
+
+#include "core/FormatDefinition.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+namespace pat {
+
+// 格式名/信号名转为合法 C++ 标识符
+QString SanitizeIdentifier(const QString& text);
+
+// 生成单个格式的解码器头文件：紧凑结构体 + 全 constexpr 字段描述 + 模板解码函数
+bool GenerateDecoderHeader(const FormatDefinition& format,
+                           const QString& identifier,
+                           const QString& sourceName,
+                           QByteArray& outHeader,
+                           QString& errorMessage);
+
+// 生成注册源文件：包含各头文件，并在静态初始化时注册到 RecordParser 的分发表
+QByteArray GenerateRegistrySource(const QStringList& headerNames, const QStringList& identifiers);
+
+}  // namespace pat
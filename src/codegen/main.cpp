@@ -0,0 +1,103 @@
+﻿#include "codegen/DecoderGenerator.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+
+namespace {
+
+// 内容未变化时不改写文件，避免触发无谓的重新编译
+bool WriteIfChanged(const QString& path, const QByteArray& content, QString& errorMessage) {
+    QFile existing(path);
+    if (existing.open(QIODevice::ReadOnly) && existing.readAll() == content) return true;
+    existing.close();
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorMessage = QStringLiteral("无法写入文件：%1").arg(path);
+        return false;
+    }
+    file.write(content);
+    if (!file.commit()) {
+        errorMessage = QStringLiteral("文件写入失败：%1").arg(file.errorString());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("pat_codegen"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("PAT 解码器生成器：把格式 JSON 生成为编译期特化的 C++ 解码器头文件"));
+    parser.addHelpOption();
+    const QCommandLineOption outOption({QStringLiteral("o"), QStringLiteral("out-dir")}, QStringLiteral("输出目录"), QStringLiteral("dir"), QStringLiteral("."));
+    const QCommandLineOption registryOption(QStringLiteral("registry"),
+                                            QStringLiteral("同时生成注册源文件（相对输出目录）"),
+                                            QStringLiteral("file"));
+    parser.addOption(outOption);
+    parser.addOption(registryOption);
+    parser.addPositionalArgument(QStringLiteral("format"), QStringLiteral("格式文件（JSON）"), QStringLiteral("format..."));
+    parser.process(app);
+
+    QTextStream err(stderr);
+    const QStringList inputs = parser.positionalArguments();
+    if (inputs.isEmpty()) {
+        err << QStringLiteral("缺少格式文件\n");
+        return 2;
+    }
+
+    const QString outDir = parser.value(outOption);
+    const QDir dir(outDir);
+    if (!dir.exists() && !QDir().mkpath(outDir)) {
+        err << QStringLiteral("无法创建输出目录：%1\n").arg(outDir);
+        return 1;
+    }
+
+    QStringList headerNames;
+    QStringList identifiers;
+    for (const auto& input : inputs) {
+        QString error;
+        pat::FormatDefinition format;
+        if (!pat::LoadFormatFromJson(input, format, error)) {
+            err << input << ": " << error << '\n';
+            return 1;
+        }
+
+        const QFileInfo info(input);
+        const QString identifier = pat::SanitizeIdentifier(info.completeBaseName());
+        if (identifiers.contains(identifier)) {
+            err << QStringLiteral("%1: 格式名重复：%2\n").arg(input, identifier);
+            return 1;
+        }
+        QByteArray header;
+        if (!pat::GenerateDecoderHeader(format, identifier, info.fileName(), header, error)) {
+            err << input << ": " << error << '\n';
+            return 1;
+        }
+        const QString headerName = info.completeBaseName() + QStringLiteral("_decoder.h");
+        if (!WriteIfChanged(dir.filePath(headerName), header, error)) {
+            err << error << '\n';
+            return 1;
+        }
+        headerNames.append(headerName);
+        identifiers.append(identifier);
+    }
+
+    if (parser.isSet(registryOption)) {
+        QString error;
+        const QByteArray source = pat::GenerateRegistrySource(headerNames, identifiers);
+        if (!WriteIfChanged(dir.filePath(parser.value(registryOption)), source, error)) {
+            err << error << '\n';
+            return 1;
+        }
+    }
+    return 0;
+}
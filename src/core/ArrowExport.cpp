@@ -0,0 +1,615 @@
+﻿#include "core/ArrowExport.h"
+
+#include <QByteArray>
+#include <QPair>
+#include <QSaveFile>
+#include <QSysInfo>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace pat {
+namespace {
+
+// ---- 最小 FlatBuffers 序列化 ----
+// 只支持 Arrow 元数据用到的结构：表、字符串、结构体向量、偏移向量。
+// 按前序深度优先从前向后排布，保证所有 uoffset 都指向更高地址；
+// 对齐均相对于缓冲区起点，缓冲区本身在文件中按 8 字节对齐。
+class FlatBufferBuilder {
+public:
+    using Ref = int;
+
+    struct Field {
+        int slot = 0;
+        int size = 0;
+        QByteArray scalar;
+        Ref child = -1;
+    };
+
+    template <typename T>
+    static Field Scalar(int slot, T value) {
+        Field field;
+        field.slot = slot;
+        field.size = static_cast<int>(sizeof(T));
+        field.scalar.resize(field.size);
+        qToLittleEndian(value, field.scalar.data());
+        return field;
+    }
+
+    static Field Offset(int slot, Ref child) {
+        Field field;
+        field.slot = slot;
+        field.size = 4;
+        field.child = child;
+        return field;
+    }
+
+    Ref String(const QByteArray& utf8) {
+        Node node;
+        node.kind = Kind::String;
+        node.bytes = utf8;
+        return Add(std::move(node));
+    }
+
+    Ref StructVector(const QByteArray& elements, int count, int alignment) {
+        Node node;
+        node.kind = Kind::StructVector;
+        node.bytes = elements;
+        node.count = count;
+        node.alignment = alignment;
+        return Add(std::move(node));
+    }
+
+    Ref OffsetVector(const QVector<Ref>& items) {
+        Node node;
+        node.kind = Kind::OffsetVector;
+        node.children = items;
+        return Add(std::move(node));
+    }
+
+    Ref Table(const QVector<Field>& fields) {
+        Node node;
+        node.kind = Kind::Table;
+        node.fields = fields;
+        return Add(std::move(node));
+    }
+
+    QByteArray Finish(Ref root) const {
+        QByteArray out(4, '\0');
+        const qsizetype rootPos = Emit(root, out);
+        PutU32(out, 0, static_cast<quint32>(rootPos));
+        Pad(out, 8);
+        return out;
+    }
+
+private:
+    enum class Kind { String, StructVector, OffsetVector, Table };
+
+    struct Node {
+        Kind kind = Kind::Table;
+        QByteArray bytes;
+        int count = 0;
+        int alignment = 1;
+        QVector<Ref> children;
+        QVector<Field> fields;
+    };
+
+    Ref Add(Node node) {
+        nodes_.push_back(std::move(node));
+        return static_cast<Ref>(nodes_.size() - 1);
+    }
+
+    static qsizetype AlignUp(qsizetype value, qsizetype alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    static void Pad(QByteArray& out, qsizetype alignment) {
+        out.append(AlignUp(out.size(), alignment) - out.size(), '\0');
+    }
+
+    static void PutU32(QByteArray& out, qsizetype pos, quint32 value) {
+        qToLittleEndian(value, out.data() + pos);
+    }
+
+    template <typename T>
+    static void Append(QByteArray& out, T value) {
+        char bytes[sizeof(T)];
+        qToLittleEndian(value, bytes);
+        out.append(bytes, sizeof(T));
+    }
+
+    qsizetype Emit(Ref ref, QByteArray& out) const {
+        const Node& node = nodes_[static_cast<size_t>(ref)];
+        switch (node.kind) {
+        case Kind::String: {
+            Pad(out, 4);
+            const qsizetype pos = out.size();
+            Append(out, static_cast<quint32>(node.bytes.size()));
+            out.append(node.bytes);
+            out.append('\0');
+            return pos;
+        }
+        case Kind::StructVector: {
+            // 长度字段之后的元素需满足结构体对齐
+            Pad(out, 4);
+            while ((out.size() + 4) % node.alignment != 0) out.append(4, '\0');
+            const qsizetype pos = out.size();
+            Append(out, static_cast<quint32>(node.count));
+            out.append(node.bytes);
+            return pos;
+        }
+        case Kind::OffsetVector: {
+            Pad(out, 4);
+            const qsizetype pos = out.size();
+            Append(out, static_cast<quint32>(node.children.size()));
+            out.append(node.children.size() * 4, '\0');
+            for (int i = 0; i < node.children.size(); ++i) {
+                const qsizetype slotPos = pos + 4 + i * 4;
+                const qsizetype childPos = Emit(node.children[i], out);
+                PutU32(out, slotPos, static_cast<quint32>(childPos - slotPos));
+            }
+            return pos;
+        }
+        case Kind::Table:
+            break;
+        }
+
+        // vtable 紧贴在表之前：soffset = 表位置 - vtable 位置
+        int slotCount = 0;
+        for (const auto& field : node.fields) slotCount = std::max(slotCount, field.slot + 1);
+        const qsizetype vtableSize = 4 + 2 * slotCount;
+        Pad(out, 4);
+        const qsizetype vtablePos = out.size();
+        const qsizetype tablePos = AlignUp(vtablePos + vtableSize, 4);
+
+        QVector<int> order(node.fields.size());
+        for (int i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(),
+                         [&node](int a, int b) { return node.fields[a].size > node.fields[b].size; });
+        QVector<qsizetype> fieldPos(node.fields.size());
+        qsizetype cursor = tablePos + 4;
+        for (int i : order) {
+            cursor = AlignUp(cursor, node.fields[i].size);
+            fieldPos[i] = cursor;
+            cursor += node.fields[i].size;
+        }
+        const qsizetype tableEnd = cursor;
+
+        Append(out, static_cast<quint16>(vtableSize));
+        Append(out, static_cast<quint16>(tableEnd - tablePos));
+        QVector<quint16> vtableSlots(slotCount, 0);
+        for (int i = 0; i < node.fields.size(); ++i) {
+            vtableSlots[node.fields[i].slot] = static_cast<quint16>(fieldPos[i] - tablePos);
+        }
+        for (quint16 slot : vtableSlots) Append(out, slot);
+        out.append(tablePos - out.size(), '\0');
+        Append(out, static_cast<qint32>(tablePos - vtablePos));
+        out.append(tableEnd - out.size(), '\0');
+        for (int i = 0; i < node.fields.size(); ++i) {
+            if (node.fields[i].child < 0) {
+                std::memcpy(out.data() + fieldPos[i], node.fields[i].scalar.constData(),
+                            static_cast<size_t>(node.fields[i].size));
+            }
+        }
+        for (int i : order) {
+            if (node.fields[i].child < 0) continue;
+            const qsizetype childPos = Emit(node.fields[i].child, out);
+            PutU32(out, fieldPos[i], static_cast<quint32>(childPos - fieldPos[i]));
+        }
+        return tablePos;
+    }
+
+    std::vector<Node> nodes_;
+};
+
+using Fb = FlatBufferBuilder;
+
+// ---- Arrow 元数据（Schema.fbs / Message.fbs / File.fbs） ----
+constexpr char kArrowMagic[6] = {'A', 'R', 'R', 'O', 'W', '1'};
+constexpr qint16 kMetadataVersionV5 = 4;
+constexpr quint8 kMessageHeaderSchema = 1;
+constexpr quint8 kMessageHeaderRecordBatch = 3;
+constexpr quint8 kTypeFloatingPoint = 3;
+constexpr qint16 kPrecisionDouble = 2;
+constexpr qint64 kBufferAlignment = 64;
+constexpr qint64 kBatchRows = 1 << 20;
+
+struct ArrowColumn {
+    QString name;
+    QString unit;
+    bool nullable = false;
+};
+
+struct ArrowBlock {
+    qint64 offset = 0;
+    qint32 metadataLength = 0;
+    qint64 bodyLength = 0;
+};
+
+Fb::Ref KeyValueVector(Fb& fb, const QVector<QPair<QString, QString>>& pairs) {
+    QVector<Fb::Ref> items;
+    for (const auto& pair : pairs) {
+        const Fb::Ref key = fb.String(pair.first.toUtf8());
+        const Fb::Ref value = fb.String(pair.second.toUtf8());
+        items.append(fb.Table({Fb::Offset(0, key), Fb::Offset(1, value)}));
+    }
+    return fb.OffsetVector(items);
+}
+
+Fb::Ref BuildSchema(Fb& fb, const QVector<ArrowColumn>& columns, const QVector<QPair<QString, QString>>& metadata) {
+    QVector<Fb::Ref> fields;
+    fields.reserve(columns.size());
+    for (const auto& column : columns) {
+        QVector<Fb::Field> fieldEntries;
+        fieldEntries.append(Fb::Offset(0, fb.String(column.name.toUtf8())));
+        fieldEntries.append(Fb::Scalar<quint8>(1, column.nullable ? 1 : 0));
+        fieldEntries.append(Fb::Scalar<quint8>(2, kTypeFloatingPoint));
+        fieldEntries.append(Fb::Offset(3, fb.Table({Fb::Scalar<qint16>(0, kPrecisionDouble)})));
+        fieldEntries.append(Fb::Offset(5, fb.OffsetVector({})));  // children 必须存在
+        if (!column.unit.isEmpty()) {
+            fieldEntries.append(Fb::Offset(6, KeyValueVector(fb, {{QStringLiteral("unit"), column.unit}})));
+        }
+        fields.append(fb.Table(fieldEntries));
+    }
+
+    const qint16 endianness = QSysInfo::ByteOrder == QSysInfo::LittleEndian ? 0 : 1;
+    QVector<Fb::Field> schemaEntries;
+    schemaEntries.append(Fb::Scalar<qint16>(0, endianness));
+    schemaEntries.append(Fb::Offset(1, fb.OffsetVector(fields)));
+    if (!metadata.isEmpty()) schemaEntries.append(Fb::Offset(2, KeyValueVector(fb, metadata)));
+    return fb.Table(schemaEntries);
+}
+
+QByteArray BuildMessage(Fb& fb, quint8 headerType, Fb::Ref header, qint64 bodyLength) {
+    const Fb::Ref message = fb.Table({Fb::Scalar<qint16>(0, kMetadataVersionV5),
+                                      Fb::Scalar<quint8>(1, headerType),
+                                      Fb::Offset(2, header),
+                                      Fb::Scalar<qint64>(3, bodyLength)});
+    return fb.Finish(message);
+}
+
+template <typename... T>
+QByteArray PackStruct(T... values) {
+    QByteArray bytes;
+    (
+        [&bytes](auto value) {
+            char raw[sizeof(value)];
+            qToLittleEndian(value, raw);
+            bytes.append(raw, sizeof(value));
+        }(values),
+        ...);
+    return bytes;
+}
+
+class ArrowFileWriter {
+public:
+    explicit ArrowFileWriter(QSaveFile& file) : file_(file) {}
+
+    bool Begin(const QVector<ArrowColumn>& columns,
+               const QVector<QPair<QString, QString>>& metadata,
+               QString& errorMessage) {
+        columns_ = columns;
+        metadata_ = metadata;
+        QByteArray header(kArrowMagic, sizeof(kArrowMagic));
+        header.append(2, '\0');
+        if (!Write(header.constData(), header.size(), errorMessage)) return false;
+
+        Fb fb;
+        const Fb::Ref schema = BuildSchema(fb, columns_, metadata_);
+        ArrowBlock block;
+        return WriteMessage(BuildMessage(fb, kMessageHeaderSchema, schema, 0), block, errorMessage);
+    }
+
+    // 每列一组 (数据指针, validity 指针或空, null 数)
+    struct ColumnData {
+        const double* values = nullptr;
+        const uchar* validity = nullptr;
+        qint64 nullCount = 0;
+    };
+
+    bool WriteBatch(qint64 rows, const QVector<ColumnData>& columns, QString& errorMessage) {
+        const qint64 validityBytes = (rows + 7) / 8;
+        const qint64 valueBytes = rows * static_cast<qint64>(sizeof(double));
+
+        QByteArray nodes;
+        QByteArray buffers;
+        qint64 bodyLength = 0;
+        for (const auto& column : columns) {
+            nodes.append(PackStruct<qint64, qint64>(rows, column.nullCount));
+            const qint64 validityLength = column.validity ? validityBytes : 0;
+            buffers.append(PackStruct<qint64, qint64>(bodyLength, validityLength));
+            bodyLength += AlignBuffer(validityLength);
+            buffers.append(PackStruct<qint64, qint64>(bodyLength, valueBytes));
+            bodyLength += AlignBuffer(valueBytes);
+        }
+
+        Fb fb;
+        const Fb::Ref batch = fb.Table({Fb::Scalar<qint64>(0, rows),
+                                        Fb::Offset(1, fb.StructVector(nodes, static_cast<int>(columns.size()), 8)),
+                                        Fb::Offset(2, fb.StructVector(buffers, static_cast<int>(columns.size() * 2), 8))});
+        ArrowBlock block;
+        if (!WriteMessage(BuildMessage(fb, kMessageHeaderRecordBatch, batch, bodyLength), block, errorMessage)) {
+            return false;
+        }
+
+        // 数值列直接从源缓冲区写盘，不做中间拷贝
+        for (const auto& column : columns) {
+            if (column.validity && !WritePadded(reinterpret_cast<const char*>(column.validity), validityBytes, errorMessage)) {
+                return false;
+            }
+            if (!WritePadded(reinterpret_cast<const char*>(column.values), valueBytes, errorMessage)) return false;
+        }
+        block.bodyLength = bodyLength;
+        batches_.push_back(block);
+        return true;
+    }
+
+    bool Finish(QString& errorMessage) {
+        // 流结束标记
+        const QByteArray eos = PackStruct<quint32, qint32>(0xFFFFFFFFu, 0);
+        if (!Write(eos.constData(), eos.size(), errorMessage)) return false;
+
+        QByteArray blocks;
+        for (const auto& block : batches_) {
+            blocks.append(PackStruct<qint64, qint32, qint32, qint64>(block.offset, block.metadataLength, 0, block.bodyLength));
+        }
+        Fb fb;
+        const Fb::Ref schema = BuildSchema(fb, columns_, metadata_);
+        const Fb::Ref footer = fb.Table({Fb::Scalar<qint16>(0, kMetadataVersionV5),
+                                         Fb::Offset(1, schema),
+                                         Fb::Offset(2, fb.StructVector(QByteArray(), 0, 8)),
+                                         Fb::Offset(3, fb.StructVector(blocks, static_cast<int>(batches_.size()), 8))});
+        const QByteArray footerBytes = fb.Finish(footer);
+        QByteArray tail = footerBytes;
+        tail.append(PackStruct<qint32>(static_cast<qint32>(footerBytes.size())));
+        tail.append(kArrowMagic, sizeof(kArrowMagic));
+        return Write(tail.constData(), tail.size(), errorMessage);
+    }
+
+private:
+    static qint64 AlignBuffer(qint64 length) { return (length + kBufferAlignment - 1) / kBufferAlignment * kBufferAlignment; }
+
+    bool WriteMessage(const QByteArray& flatbuffer, ArrowBlock& outBlock, QString& errorMessage) {
+        // 封装消息：continuation + 元数据长度 + flatbuffer（补齐到 8 字节）
+        outBlock.offset = file_.pos();
+        QByteArray message = PackStruct<quint32, qint32>(0xFFFFFFFFu, static_cast<qint32>(flatbuffer.size()));
+        message.append(flatbuffer);
+        outBlock.metadataLength = static_cast<qint32>(message.size());
+        return Write(message.constData(), message.size(), errorMessage);
+    }
+
+    bool WritePadded(const char* data, qint64 length, QString& errorMessage) {
+        static const char kZeros[kBufferAlignment] = {};
+        if (length > 0 && !Write(data, length, errorMessage)) return false;
+        const qint64 padding = AlignBuffer(length) - length;
+        return padding == 0 || Write(kZeros, padding, errorMessage);
+    }
+
+    bool Write(const char* data, qint64 length, QString& errorMessage) {
+        if (file_.write(data, length) != length) {
+            errorMessage = QStringLiteral("写入导出文件失败：%1").arg(file_.errorString());
+            return false;
+        }
+        return true;
+    }
+
+    QSaveFile& file_;
+    QVector<ArrowColumn> columns_;
+    QVector<QPair<QString, QString>> metadata_;
+    std::vector<ArrowBlock> batches_;
+};
+
+struct ArrowCursor {
+    const Series* series = nullptr;
+    std::shared_ptr<SeriesReader> reader;
+    qsizetype index = 0;
+    qsizetype end = 0;
+};
+
+bool SharesTimeAxis(const QVector<ArrowCursor>& cursors) {
+    const Series& first = *cursors.first().series;
+    for (const auto& cursor : cursors) {
+        const Series& s = *cursor.series;
+        if (cursor.index != cursors.first().index || cursor.end != cursors.first().end) return false;
+        if (!s.SharesTimeAxis(first)) return false;
+    }
+    return true;
+}
+
+// 把 Series::validity 中 [first, first + rows) 的位移到从 0 开始的 Arrow 位图（同为 LSB 在前），返回 null 数
+qint64 SliceValidity(const Series& series, qsizetype first, qint64 rows, std::vector<uchar>& out) {
+    out.assign(static_cast<size_t>((rows + 7) / 8), 0);
+    qint64 nullCount = 0;
+    for (qint64 r = 0; r < rows; ++r) {
+        if (series.IsValid(first + r)) {
+            out[static_cast<size_t>(r / 8)] |= static_cast<uchar>(1u << (r % 8));
+        } else {
+            ++nullCount;
+        }
+    }
+    return nullCount;
+}
+
+}  // namespace
+
+bool ExportSeriesArrow(const QString& path,
+                       const QVector<Series>& series,
+                       const ExportOptions& options,
+                       QString& errorMessage,
+                       const ExportProgressCallback& progress) {
+    QVector<int> indices = options.signalIndices;
+    if (indices.isEmpty()) {
+        for (int i = 0; i < series.size(); ++i) indices.append(i);
+    }
+    if (indices.isEmpty()) {
+        errorMessage = QStringLiteral("没有可导出的信号");
+        return false;
+    }
+
+    QVector<ArrowCursor> cursors;
+    qint64 totalSamples = 0;
+    for (int idx : indices) {
+        if (idx < 0 || idx >= series.size()) {
+            errorMessage = QStringLiteral("导出信号索引越界：%1").arg(idx);
+            return false;
+        }
+        ArrowCursor cursor;
+        cursor.series = &series[idx];
+        cursor.reader = std::make_shared<SeriesReader>(series[idx]);
+        cursor.end = cursor.series->Size();
+        if (options.hasTimeWindow) {
+            cursor.index = cursor.series->LowerBound(options.startTime);
+            cursor.end = std::max(cursor.index, cursor.series->UpperBound(options.endTime));
+        }
+        totalSamples += cursor.end - cursor.index;
+        cursors.append(cursor);
+    }
+
+    const bool aligned = SharesTimeAxis(cursors);
+    const Series& axis = *cursors.first().series;
+    const bool implicitTime = aligned && axis.IsUniform() && options.implicitUniformTime;
+
+    QVector<ArrowColumn> columns;
+    QVector<QPair<QString, QString>> metadata;
+    if (!options.timeUnit.isEmpty()) metadata.append(qMakePair(QStringLiteral("pat.time_unit"), options.timeUnit));
+    if (implicitTime) {
+        const double origin = cursors.first().end > cursors.first().index ? axis.TimeAt(cursors.first().index) : axis.timeOrigin;
+        metadata.append(qMakePair(QStringLiteral("pat.time_origin"), QString::number(origin, 'g', 17)));
+        metadata.append(qMakePair(QStringLiteral("pat.time_step"), QString::number(axis.timeStep, 'g', 17)));
+    } else {
+        columns.append(ArrowColumn{QStringLiteral("time"), options.timeUnit, false});
+    }
+    for (const auto& cursor : cursors) {
+        columns.append(ArrowColumn{cursor.series->name, cursor.series->unit, !aligned || cursor.series->HasInvalid()});
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorMessage = QStringLiteral("无法写入导出文件：%1").arg(path);
+        return false;
+    }
+
+    ArrowFileWriter writer(file);
+    if (!writer.Begin(columns, metadata, errorMessage)) return false;
+
+    qint64 doneSamples = 0;
+    auto reportProgress = [&]() {
+        if (progress && !progress(doneSamples, totalSamples)) {
+            errorMessage = QStringLiteral("导出已取消");
+            return false;
+        }
+        return true;
+    };
+
+    using ColumnData = ArrowFileWriter::ColumnData;
+    QVector<ColumnData> batchColumns;
+    std::vector<double> timeBuffer;
+    if (aligned) {
+        std::vector<std::vector<uchar>> validity(static_cast<size_t>(cursors.size()));
+        // 内存中的列直接引用，外存列与压缩列按批拷出
+        std::vector<std::vector<double>> staged(static_cast<size_t>(cursors.size()));
+        const auto stage = [](SeriesReader& reader, bool times, qsizetype first, qint64 rows, std::vector<double>& out) {
+            out.resize(static_cast<size_t>(rows));
+            for (qint64 r = 0; r < rows; ++r) out[static_cast<size_t>(r)] = times ? reader.Time(first + r) : reader.Value(first + r);
+            return out.data();
+        };
+        const qsizetype begin = cursors.first().index;
+        const qsizetype end = cursors.first().end;
+        for (qsizetype first = begin; first < end; first += kBatchRows) {
+            const qint64 rows = std::min<qint64>(kBatchRows, end - first);
+            batchColumns.clear();
+            if (!implicitTime) {
+                if (axis.IsUniform() || axis.IsChunked()) {
+                    batchColumns.append(ColumnData{stage(*cursors.first().reader, true, first, rows, timeBuffer), nullptr, 0});
+                } else {
+                    batchColumns.append(ColumnData{axis.times.constData() + first, nullptr, 0});
+                }
+            }
+            for (int c = 0; c < cursors.size(); ++c) {
+                const Series& column = *cursors[c].series;
+                ColumnData data{!column.IsPlain() ? stage(*cursors[c].reader, false, first, rows, staged[static_cast<size_t>(c)])
+                                                  : column.values.constData() + first,
+                                nullptr,
+                                0};
+                if (column.HasInvalid()) {
+                    // 校验失败的样本写为 null
+                    auto& bits = validity[static_cast<size_t>(c)];
+                    data.nullCount = SliceValidity(column, first, rows, bits);
+                    data.validity = bits.data();
+                }
+                batchColumns.append(data);
+            }
+            if (!writer.WriteBatch(rows, batchColumns, errorMessage)) return false;
+            doneSamples += rows * cursors.size();
+            if (!reportProgress()) return false;
+        }
+    } else {
+        // 时间轴不一致：按时间归并，每批最多 kBatchRows 行，缺失值置 null
+        const int columnCount = static_cast<int>(cursors.size());
+        std::vector<std::vector<double>> values(static_cast<size_t>(columnCount));
+        std::vector<std::vector<uchar>> validity(static_cast<size_t>(columnCount));
+        std::vector<qint64> nullCounts(static_cast<size_t>(columnCount));
+        bool more = true;
+        while (more) {
+            timeBuffer.clear();
+            for (int c = 0; c < columnCount; ++c) {
+                values[static_cast<size_t>(c)].clear();
+                validity[static_cast<size_t>(c)].assign(static_cast<size_t>((kBatchRows + 7) / 8), 0);
+                nullCounts[static_cast<size_t>(c)] = 0;
+            }
+            qint64 rows = 0;
+            while (rows < kBatchRows) {
+                double rowTime = std::numeric_limits<double>::infinity();
+                for (const auto& cursor : cursors) {
+                    if (cursor.index < cursor.end) rowTime = std::min(rowTime, cursor.reader->Time(cursor.index));
+                }
+                if (rowTime == std::numeric_limits<double>::infinity()) {
+                    more = false;
+                    break;
+                }
+                timeBuffer.push_back(rowTime);
+                for (int c = 0; c < columnCount; ++c) {
+                    auto& cursor = cursors[c];
+                    const size_t column = static_cast<size_t>(c);
+                    if (cursor.index < cursor.end && cursor.reader->Time(cursor.index) == rowTime) {
+                        values[column].push_back(cursor.reader->Value(cursor.index));
+                        if (cursor.series->IsValid(cursor.index)) {
+                            validity[column][static_cast<size_t>(rows / 8)] |= static_cast<uchar>(1u << (rows % 8));
+                        } else {
+                            ++nullCounts[column];
+                        }
+                        ++cursor.index;
+                        ++doneSamples;
+                    } else {
+                        values[column].push_back(0.0);
+                        ++nullCounts[column];
+                    }
+                }
+                ++rows;
+            }
+            if (rows == 0) break;
+
+            batchColumns.clear();
+            batchColumns.append(ColumnData{timeBuffer.data(), nullptr, 0});
+            for (int c = 0; c < columnCount; ++c) {
+                const size_t column = static_cast<size_t>(c);
+                batchColumns.append(ColumnData{values[column].data(), validity[column].data(), nullCounts[column]});
+            }
+            if (!writer.WriteBatch(rows, batchColumns, errorMessage)) return false;
+            if (!reportProgress()) return false;
+        }
+    }
+
+    if (!writer.Finish(errorMessage)) return false;
+    if (!file.commit()) {
+        errorMessage = QStringLiteral("导出文件提交失败：%1").arg(file.errorString());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace pat
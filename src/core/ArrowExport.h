@@ -0,0 +1,16 @@
+﻿#pragma once
+
+#include "core/SeriesExport.h"
+
+namespace pat {
+
+// 手写的 Arrow IPC 文件写出（不依赖 Arrow/FlatBuffers 库）。
+// 所选信号共享同一时间轴时，数值列直接从 Series::values 拷贝写盘；
+// 否则按时间归并成行，缺失值以 validity 位图标记为 null。
+bool ExportSeriesArrow(const QString& path,
+                       const QVector<Series>& series,
+                       const ExportOptions& options,
+                       QString& errorMessage,
+                       const ExportProgressCallback& progress = ExportProgressCallback());
+
+}  // namespace pat
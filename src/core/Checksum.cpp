@@ -0,0 +1,185 @@
+﻿#include "core/Checksum.h"
+
+#include <QtEndian>
+
+#include <array>
+#include <cstring>
+#include <utility>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <nmmintrin.h>
+#define PAT_HAS_SSE42_CRC 1
+#endif
+
+namespace pat {
+namespace {
+
+// 反射多项式的 slicing-by-8 表：tables[k][b] 为字节 b 之后再经过 k 个零字节的 CRC
+using Crc32Tables = std::array<std::array<quint32, 256>, 8>;
+
+Crc32Tables MakeCrc32Tables(quint32 polynomial) {
+    Crc32Tables tables{};
+    for (quint32 b = 0; b < 256; ++b) {
+        quint32 crc = b;
+        for (int bit = 0; bit < 8; ++bit) crc = (crc >> 1) ^ ((crc & 1u) ? polynomial : 0u);
+        tables[0][b] = crc;
+    }
+    for (quint32 b = 0; b < 256; ++b) {
+        for (int k = 1; k < 8; ++k) tables[k][b] = (tables[k - 1][b] >> 8) ^ tables[0][tables[k - 1][b] & 0xffu];
+    }
+    return tables;
+}
+
+const Crc32Tables& Crc32IeeeTables() {
+    static const Crc32Tables tables = MakeCrc32Tables(0xEDB88320u);
+    return tables;
+}
+
+const Crc32Tables& Crc32cTables() {
+    static const Crc32Tables tables = MakeCrc32Tables(0x82F63B78u);
+    return tables;
+}
+
+quint32 Crc32Sliced(const Crc32Tables& t, const char* data, qint64 length) {
+    const auto* p = reinterpret_cast<const uchar*>(data);
+    quint32 crc = 0xFFFFFFFFu;
+    while (length >= 8) {
+        quint32 lo = 0;
+        quint32 hi = 0;
+        std::memcpy(&lo, p, 4);
+        std::memcpy(&hi, p + 4, 4);
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+        lo = qFromLittleEndian<quint32>(p);
+        hi = qFromLittleEndian<quint32>(p + 4);
+#endif
+        lo ^= crc;
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+        p += 8;
+        length -= 8;
+    }
+    while (length-- > 0) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+    return ~crc;
+}
+
+#ifdef PAT_HAS_SSE42_CRC
+__attribute__((target("sse4.2"))) quint32 Crc32cHardware(const char* data, qint64 length) {
+    const auto* p = reinterpret_cast<const uchar*>(data);
+    quint64 crc = 0xFFFFFFFFu;
+#if defined(__x86_64__)
+    while (length >= 8) {
+        quint64 word = 0;
+        std::memcpy(&word, p, 8);
+        crc = _mm_crc32_u64(crc, word);
+        p += 8;
+        length -= 8;
+    }
+#endif
+    quint32 crc32 = static_cast<quint32>(crc);
+    while (length-- > 0) crc32 = _mm_crc32_u8(crc32, *p++);
+    return ~crc32;
+}
+
+bool HasSse42() {
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+}
+#endif
+
+// CRC-16/CCITT-FALSE：多项式 0x1021，初值 0xFFFF，不反射；slicing-by-4，tables[k][b] 为字节 b 之后再经过 k 个零字节的 CRC
+using Crc16Tables = std::array<std::array<quint16, 256>, 4>;
+
+const Crc16Tables& Crc16TablesCcitt() {
+    static const Crc16Tables tables = [] {
+        Crc16Tables t{};
+        for (quint32 b = 0; b < 256; ++b) {
+            quint32 crc = b << 8;
+            for (int bit = 0; bit < 8; ++bit) crc = (crc & 0x8000u) ? ((crc << 1) ^ 0x1021u) : (crc << 1);
+            t[0][b] = static_cast<quint16>(crc);
+        }
+        for (quint32 b = 0; b < 256; ++b) {
+            for (int k = 1; k < 4; ++k) {
+                t[k][b] = static_cast<quint16>((t[k - 1][b] << 8) ^ t[0][t[k - 1][b] >> 8]);
+            }
+        }
+        return t;
+    }();
+    return tables;
+}
+
+quint16 Crc16Sliced(const char* data, qint64 length) {
+    const auto& t = Crc16TablesCcitt();
+    const auto* p = reinterpret_cast<const uchar*>(data);
+    quint32 crc = 0xFFFF;
+    while (length >= 4) {
+        const quint32 x = crc ^ ((static_cast<quint32>(p[0]) << 8) | p[1]);
+        crc = t[3][x >> 8] ^ t[2][x & 0xff] ^ t[1][p[2]] ^ t[0][p[3]];
+        p += 4;
+        length -= 4;
+    }
+    while (length-- > 0) crc = ((crc << 8) ^ t[0][((crc >> 8) ^ *p++) & 0xff]) & 0xffffu;
+    return static_cast<quint16>(crc);
+}
+
+}  // namespace
+
+bool ResolveChecksumKind(const QString& name, ChecksumKind& outKind) {
+    const auto n = name.trimmed().toLower();
+    const std::array<std::pair<const char*, ChecksumKind>, 6> names = {{{"sum8", ChecksumKind::Sum8},
+                                                                       {"sum16", ChecksumKind::Sum16},
+                                                                       {"xor8", ChecksumKind::Xor8},
+                                                                       {"crc16", ChecksumKind::Crc16},
+                                                                       {"crc32", ChecksumKind::Crc32},
+                                                                       {"crc32c", ChecksumKind::Crc32c}}};
+    for (const auto& [text, kind] : names) {
+        if (n == text) {
+            outKind = kind;
+            return true;
+        }
+    }
+    return false;
+}
+
+int ChecksumWidth(ChecksumKind kind) {
+    switch (kind) {
+    case ChecksumKind::Sum8:
+    case ChecksumKind::Xor8:
+        return 1;
+    case ChecksumKind::Sum16:
+    case ChecksumKind::Crc16:
+        return 2;
+    case ChecksumKind::Crc32:
+    case ChecksumKind::Crc32c:
+        return 4;
+    }
+    return 0;
+}
+
+quint32 ComputeChecksum(ChecksumKind kind, const char* data, qint64 length) {
+    const auto* p = reinterpret_cast<const uchar*>(data);
+    switch (kind) {
+    case ChecksumKind::Sum8:
+    case ChecksumKind::Sum16: {
+        quint32 sum = 0;
+        for (qint64 i = 0; i < length; ++i) sum += p[i];
+        return kind == ChecksumKind::Sum8 ? (sum & 0xffu) : (sum & 0xffffu);
+    }
+    case ChecksumKind::Xor8: {
+        uchar x = 0;
+        for (qint64 i = 0; i < length; ++i) x ^= p[i];
+        return x;
+    }
+    case ChecksumKind::Crc16:
+        return Crc16Sliced(data, length);
+    case ChecksumKind::Crc32:
+        return Crc32Sliced(Crc32IeeeTables(), data, length);
+    case ChecksumKind::Crc32c:
+#ifdef PAT_HAS_SSE42_CRC
+        if (HasSse42()) return Crc32cHardware(data, length);
+#endif
+        return Crc32Sliced(Crc32cTables(), data, length);
+    }
+    return 0;
+}
+
+}  // namespace pat
@@ -0,0 +1,17 @@
+﻿#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+namespace pat {
+
+enum class ChecksumKind { Sum8, Sum16, Xor8, Crc16, Crc32, Crc32c };
+
+// sum8/sum16/xor8/crc16（CCITT-FALSE）/crc32（IEEE）/crc32c（Castagnoli）
+bool ResolveChecksumKind(const QString& name, ChecksumKind& outKind);
+int ChecksumWidth(ChecksumKind kind);
+
+// crc32c 在支持 SSE4.2 的 x86 上走硬件指令，其余为查表实现
+quint32 ComputeChecksum(ChecksumKind kind, const char* data, qint64 length);
+
+}  // namespace pat
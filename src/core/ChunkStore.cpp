@@ -0,0 +1,188 @@
+﻿#include "core/ChunkStore.h"
+
+#include "core/PerfCounters.h"
+
+#include <QDir>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <cstring>
+
+namespace pat {
+namespace {
+
+constexpr qint64 kChunkBytes = ChunkStore::kChunkSamples * static_cast<qint64>(sizeof(double));
+
+}  // namespace
+
+ChunkStore::ChunkStore(qint64 memoryBudgetBytes, const QString& spillDirectory)
+    : memoryBudget_(std::max<qint64>(memoryBudgetBytes, kChunkBytes)),
+      spillDirectory_(spillDirectory.isEmpty() ? QDir::tempPath() : spillDirectory) {}
+
+ChunkStore::~ChunkStore() {
+    for (auto& column : columns_) {
+        for (auto& chunk : column.chunks) {
+            if (chunk.mapped) spillFile_.unmap(chunk.mapped);
+        }
+    }
+}
+
+int ChunkStore::AddColumn() {
+    QMutexLocker locker(&mutex_);
+    columns_.emplace_back();
+    return static_cast<int>(columns_.size()) - 1;
+}
+
+qsizetype ChunkStore::ColumnSize(int column) const {
+    QMutexLocker locker(&mutex_);
+    return columns_[static_cast<size_t>(column)].size;
+}
+
+bool ChunkStore::Append(int column, const double* data, qsizetype count, QString& errorMessage) {
+    QMutexLocker locker(&mutex_);
+    Column& target = columns_[static_cast<size_t>(column)];
+    while (count > 0) {
+        if (target.chunks.empty() || target.chunks.back().count == kChunkSamples) {
+            target.chunks.emplace_back();
+            target.chunks.back().heap.reset(new double[kChunkSamples]);
+            residentBytes_ += kChunkBytes;
+        }
+        Chunk& tail = target.chunks.back();
+        const qsizetype take = std::min(count, kChunkSamples - tail.count);
+        std::memcpy(tail.heap.get() + tail.count, data, static_cast<size_t>(take) * sizeof(double));
+        tail.count += take;
+        target.size += take;
+        data += take;
+        count -= take;
+        // 写满的块进入 LRU，成为可换出的候选
+        if (tail.count == kChunkSamples) {
+            Touch(column, static_cast<qsizetype>(target.chunks.size()) - 1);
+            if (!EvictOverBudget(errorMessage)) return false;
+        }
+    }
+    return true;
+}
+
+const double* ChunkStore::Pin(int column, qsizetype index, qsizetype& outFirst, qsizetype& outCount) {
+    QMutexLocker locker(&mutex_);
+    Column& source = columns_[static_cast<size_t>(column)];
+    const qsizetype chunkIndex = index / kChunkSamples;
+    Chunk& chunk = source.chunks[static_cast<size_t>(chunkIndex)];
+    const bool resident = chunk.heap || chunk.mapped;
+    PerfCounters::Instance().CountChunkPin(resident);
+    if (!resident) {
+        chunk.mapped = spillFile_.map(chunk.fileOffset, kChunkBytes);
+        if (!chunk.mapped) {
+            lastError_ = QStringLiteral("换入数据块失败：%1").arg(spillFile_.errorString());
+            return nullptr;
+        }
+        residentBytes_ += kChunkBytes;
+        ++pageIns_;
+    }
+    ++chunk.pins;
+    if (chunk.count == kChunkSamples) Touch(column, chunkIndex);
+    QString error;
+    if (!EvictOverBudget(error)) lastError_ = error;
+    outFirst = chunkIndex * kChunkSamples;
+    outCount = chunk.count;
+    return ChunkData(chunk);
+}
+
+void ChunkStore::Unpin(int column, qsizetype index) {
+    QMutexLocker locker(&mutex_);
+    Chunk& chunk = columns_[static_cast<size_t>(column)].chunks[static_cast<size_t>(index / kChunkSamples)];
+    if (chunk.pins > 0) --chunk.pins;
+}
+
+void ChunkStore::SetMemoryBudget(qint64 bytes) {
+    QMutexLocker locker(&mutex_);
+    memoryBudget_ = std::max<qint64>(bytes, kChunkBytes);
+    QString error;
+    if (!EvictOverBudget(error)) lastError_ = error;
+}
+
+qint64 ChunkStore::ColumnResidentBytes(int column) const {
+    QMutexLocker locker(&mutex_);
+    qint64 bytes = 0;
+    for (const Chunk& chunk : columns_[static_cast<size_t>(column)].chunks) {
+        if (chunk.heap || chunk.mapped) bytes += kChunkBytes;
+    }
+    return bytes;
+}
+
+ChunkStoreStats ChunkStore::Stats() const {
+    QMutexLocker locker(&mutex_);
+    ChunkStoreStats stats;
+    stats.memoryBudget = memoryBudget_;
+    stats.residentBytes = residentBytes_;
+    stats.spilledBytes = spillBytes_;
+    stats.pageIns = pageIns_;
+    stats.evictions = evictions_;
+    return stats;
+}
+
+QString ChunkStore::LastError() const {
+    QMutexLocker locker(&mutex_);
+    return lastError_;
+}
+
+const double* ChunkStore::ChunkData(const Chunk& chunk) const {
+    return chunk.heap ? chunk.heap.get() : reinterpret_cast<const double*>(chunk.mapped);
+}
+
+void ChunkStore::Touch(int column, qsizetype chunkIndex) {
+    Chunk& chunk = columns_[static_cast<size_t>(column)].chunks[static_cast<size_t>(chunkIndex)];
+    if (chunk.listed) {
+        lru_.splice(lru_.begin(), lru_, chunk.lru);
+    } else {
+        lru_.emplace_front(column, chunkIndex);
+        chunk.lru = lru_.begin();
+        chunk.listed = true;
+    }
+}
+
+// 从 LRU 尾部换出未固定的块：第一遍只解除已落盘块的映射，不产生写入；仍超出时再把堆上的块写入临时文件
+bool ChunkStore::EvictOverBudget(QString& errorMessage) {
+    for (int pass = 0; pass < 2 && residentBytes_ > memoryBudget_; ++pass) {
+        auto it = lru_.end();
+        while (residentBytes_ > memoryBudget_ && it != lru_.begin()) {
+            --it;
+            Chunk& chunk = columns_[static_cast<size_t>(it->first)].chunks[static_cast<size_t>(it->second)];
+            if (chunk.pins > 0 || (pass == 0 && !chunk.mapped)) continue;
+            if (chunk.heap) {
+                if (chunk.fileOffset < 0 && !Spill(chunk, errorMessage)) return false;
+                chunk.heap.reset();
+            } else {
+                spillFile_.unmap(chunk.mapped);
+                chunk.mapped = nullptr;
+            }
+            residentBytes_ -= kChunkBytes;
+            ++evictions_;
+            chunk.listed = false;
+            it = lru_.erase(it);
+        }
+    }
+    return true;
+}
+
+bool ChunkStore::Spill(Chunk& chunk, QString& errorMessage) {
+    if (!spillFile_.isOpen()) {
+        spillFile_.setFileTemplate(QDir(spillDirectory_).filePath(QStringLiteral("pat_chunks_XXXXXX.bin")));
+        if (!spillFile_.open()) {
+            errorMessage = QStringLiteral("无法创建外存临时文件：%1").arg(spillFile_.errorString());
+            return false;
+        }
+    }
+    if (!spillFile_.seek(spillBytes_) ||
+        spillFile_.write(reinterpret_cast<const char*>(chunk.heap.get()), kChunkBytes) != kChunkBytes) {
+        errorMessage = QStringLiteral("写入外存临时文件失败：%1").arg(spillFile_.errorString());
+        return false;
+    }
+    // 写入内容随后经映射读回，需先从 QFile 的写缓冲落到文件
+    spillFile_.flush();
+    chunk.fileOffset = spillBytes_;
+    spillBytes_ += kChunkBytes;
+    return true;
+}
+
+}  // namespace pat
@@ -0,0 +1,84 @@
+﻿#pragma once
+
+#include <QMutex>
+#include <QString>
+#include <QTemporaryFile>
+
+#include <list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace pat {
+
+struct ChunkStoreStats {
+    qint64 memoryBudget = 0;
+    qint64 residentBytes = 0;  // 堆上的块与已换入的映射块
+    qint64 spilledBytes = 0;   // 临时文件大小
+    qint64 pageIns = 0;
+    qint64 evictions = 0;
+};
+
+// 外存列存储：每列按固定样本数切块，常驻块超出内存预算时按 LRU 换出到临时文件，
+// 访问时把块在文件中的区域映射回来。块写满后不再修改；各列末尾未写满的块始终常驻。
+// 换出时先丢已在临时文件中的映射块（解除映射即可，可随时换回），再写出未落盘的块
+// 线程安全：Pin/Unpin 可在多个线程上同时调用，固定中的块不会被换出
+class ChunkStore {
+public:
+    static constexpr qsizetype kChunkSamples = 64 * 1024;
+
+    // spillDirectory 为空时用系统临时目录
+    explicit ChunkStore(qint64 memoryBudgetBytes, const QString& spillDirectory = QString());
+    ~ChunkStore();
+    ChunkStore(const ChunkStore&) = delete;
+    ChunkStore& operator=(const ChunkStore&) = delete;
+
+    int AddColumn();
+    bool Append(int column, const double* data, qsizetype count, QString& errorMessage);
+    qsizetype ColumnSize(int column) const;
+
+    // 固定 index 所在的块并返回块首地址，outFirst/outCount 为块覆盖的样本范围；换入失败返回 nullptr
+    const double* Pin(int column, qsizetype index, qsizetype& outFirst, qsizetype& outCount);
+    void Unpin(int column, qsizetype index);
+
+    // 调整预算并立即换出超出部分；预算至少一个块
+    void SetMemoryBudget(qint64 bytes);
+    ChunkStoreStats Stats() const;
+    qint64 ColumnResidentBytes(int column) const;
+    // 最近一次换入/换出失败的原因
+    QString LastError() const;
+
+private:
+    struct Chunk {
+        std::unique_ptr<double[]> heap;
+        uchar* mapped = nullptr;
+        qsizetype count = 0;
+        qint64 fileOffset = -1;  // 尚未写入临时文件时为 -1
+        int pins = 0;
+        bool listed = false;
+        std::list<std::pair<int, qsizetype>>::iterator lru;
+    };
+    struct Column {
+        std::vector<Chunk> chunks;
+        qsizetype size = 0;
+    };
+
+    const double* ChunkData(const Chunk& chunk) const;
+    void Touch(int column, qsizetype chunk);
+    bool EvictOverBudget(QString& errorMessage);
+    bool Spill(Chunk& chunk, QString& errorMessage);
+
+    mutable QMutex mutex_;
+    qint64 memoryBudget_ = 0;
+    QString spillDirectory_;
+    QTemporaryFile spillFile_;
+    qint64 spillBytes_ = 0;
+    qint64 residentBytes_ = 0;
+    qint64 pageIns_ = 0;
+    qint64 evictions_ = 0;
+    QString lastError_;
+    std::vector<Column> columns_;
+    std::list<std::pair<int, qsizetype>> lru_;  // 前端最近使用
+};
+
+}  // namespace pat
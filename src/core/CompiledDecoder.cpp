@@ -0,0 +1,89 @@
+﻿#include "core/CompiledDecoder.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <cstring>
+
+namespace pat {
+namespace {
+
+constexpr quint64 kFnvOffset = 1469598103934665603ull;
+constexpr quint64 kFnvPrime = 1099511628211ull;
+
+void HashBytes(quint64& hash, const void* data, size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= kFnvPrime;
+    }
+}
+
+void HashInt(quint64& hash, qint64 value) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; ++i) bytes[i] = static_cast<unsigned char>((static_cast<quint64>(value) >> (8 * i)) & 0xff);
+    HashBytes(hash, bytes, sizeof(bytes));
+}
+
+void HashDouble(quint64& hash, double value) {
+    quint64 bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    HashInt(hash, static_cast<qint64>(bits));
+}
+
+void HashText(quint64& hash, const QString& text) {
+    const QByteArray utf8 = text.toLower().toUtf8();
+    HashInt(hash, utf8.size());
+    HashBytes(hash, utf8.constData(), static_cast<size_t>(utf8.size()));
+}
+
+struct Registry {
+    QMutex mutex;
+    QHash<quint64, CompiledDecoder> decoders;
+};
+
+// 生成的解码器在静态初始化阶段注册，需要函数内静态对象保证构造顺序
+Registry& GlobalRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+}  // namespace
+
+quint64 FormatFingerprint(const FormatDefinition& format) {
+    quint64 hash = kFnvOffset;
+    HashInt(hash, format.recordSize);
+    HashText(hash, format.endianness);
+    HashInt(hash, static_cast<qint64>(format.signalFormats.size()));
+    for (const auto& sig : format.signalFormats) {
+        HashInt(hash, sig.byteOffset);
+        HashText(hash, sig.valueType);
+        HashDouble(hash, sig.scale);
+        HashDouble(hash, sig.bias);
+    }
+    return hash;
+}
+
+void RegisterCompiledDecoder(const CompiledDecoder& decoder) {
+    Registry& registry = GlobalRegistry();
+    QMutexLocker locker(&registry.mutex);
+    registry.decoders.insert(decoder.fingerprint, decoder);
+}
+
+bool FindCompiledDecoder(const FormatDefinition& format, CompiledDecoder& outDecoder) {
+    Registry& registry = GlobalRegistry();
+    QMutexLocker locker(&registry.mutex);
+    if (registry.decoders.isEmpty()) return false;
+    const auto it = registry.decoders.constFind(FormatFingerprint(format));
+    if (it == registry.decoders.constEnd()) return false;
+    // 指纹碰撞兜底：形状不符时退回运行时解码
+    const CompiledDecoder& decoder = it.value();
+    if (decoder.recordSize != format.recordSize || decoder.signalCount != static_cast<int>(format.signalFormats.size())) {
+        return false;
+    }
+    outDecoder = decoder;
+    return true;
+}
+
+}  // namespace pat
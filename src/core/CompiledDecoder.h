@@ -0,0 +1,46 @@
+﻿#pragma once
+
+#include "core/FormatDefinition.h"
+#include "core/RawDecode.h"
+
+#include <QtGlobal>
+
+namespace pat {
+
+// out[s] 指向第 s 个信号在本块的输出起点
+using CompiledDecodeFunction = void (*)(const char* records, qint64 count, double* const* out);
+
+struct CompiledDecoder {
+    quint64 fingerprint = 0;
+    int recordSize = 0;
+    int signalCount = 0;
+    CompiledDecodeFunction decode = nullptr;
+    const char* name = "";
+};
+
+// 只覆盖影响解码的字段（记录长度、字节序、偏移、类型、scale/bias），信号名与单位不参与
+quint64 FormatFingerprint(const FormatDefinition& format);
+
+void RegisterCompiledDecoder(const CompiledDecoder& decoder);
+bool FindCompiledDecoder(const FormatDefinition& format, CompiledDecoder& outDecoder);
+
+namespace compiled {
+
+// 由 pat_codegen 生成的字段描述：struct { using Raw; kOffset; kScale; kBias; }
+template <int RecordSize, typename Field>
+inline void DecodeField(const char* records, qint64 count, double* out) {
+    const char* ptr = records + Field::kOffset;
+    for (qint64 i = 0; i < count; ++i) {
+        out[i] = LoadRaw<typename Field::Raw>(ptr + i * RecordSize) * Field::kScale + Field::kBias;
+    }
+}
+
+template <int RecordSize, typename... Fields>
+inline void DecodeRecords(const char* records, qint64 count, double* const* out) {
+    int column = 0;
+    (DecodeField<RecordSize, Fields>(records, count, out[column++]), ...);
+}
+
+}  // namespace compiled
+
+}  // namespace pat
@@ -0,0 +1,436 @@
+﻿#include "core/Compression.h"
+
+#include "core/TaskScheduler.h"
+#include "core/Trace.h"
+
+#include <QtEndian>
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#ifdef PAT_HAS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef PAT_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace pat {
+namespace {
+
+constexpr qint64 kOutputChunk = 1 << 20;      // 顺序解压时每次交给 sink 的最大长度
+constexpr qint64 kTaskCompressedBytes = 1 << 20;  // 并行解压时每个任务至少包含的压缩字节
+constexpr qint64 kBgzfMaxInput = 0xff00;      // BGZF 每块的输入上限，保证压缩后不超过 64 KiB
+constexpr qint64 kBgzfMaxContent = 0x10000;   // BGZF 规定每块解压后不超过 64 KiB，超出的块头不可信
+constexpr qint64 kZstdMaxRatio = 256;         // 帧头声明的内容长度超过压缩长度的该倍数时不据此预分配，改为流式解压
+constexpr int kBgzfHeaderSize = 18;
+constexpr int kGzipTrailerSize = 8;
+
+// 可独立解压的一帧：zstd 帧或 BGZF 块；contentSize 未知时为 -1
+struct FrameSpan {
+    qint64 offset = 0;
+    qint64 size = 0;
+    qint64 contentSize = -1;
+};
+
+struct TaskResult {
+    bool ok = true;
+    QByteArray data;
+    QString error;
+};
+
+const uchar* Bytes(const char* data) {
+    return reinterpret_cast<const uchar*>(data);
+}
+
+// BGZF 块头：FEXTRA 中带 'BC' 子字段，给出整块长度 - 1
+qint64 BgzfBlockSize(const char* data, qint64 size) {
+    if (size < kBgzfHeaderSize + kGzipTrailerSize) return -1;
+    const uchar* p = Bytes(data);
+    if (p[0] != 0x1f || p[1] != 0x8b || p[2] != 8 || (p[3] & 4) == 0) return -1;
+    const int extraLength = qFromLittleEndian<quint16>(p + 10);
+    for (int pos = 12; pos + 4 <= 12 + extraLength && pos + 4 <= size;) {
+        const int subLength = qFromLittleEndian<quint16>(p + pos + 2);
+        if (p[pos] == 'B' && p[pos + 1] == 'C' && subLength == 2 && pos + 6 <= size) {
+            const qint64 blockSize = qFromLittleEndian<quint16>(p + pos + 4) + 1;
+            return blockSize <= size ? blockSize : -1;
+        }
+        pos += 4 + subLength;
+    }
+    return -1;
+}
+
+// 能确定帧边界时拆成帧列表：多帧 zstd，或整份由 BGZF 块组成的 gzip
+bool SplitFrames(const char* data, qint64 size, CompressionKind kind, std::vector<FrameSpan>& frames) {
+    frames.clear();
+    qint64 pos = 0;
+    while (pos < size) {
+        FrameSpan frame;
+        frame.offset = pos;
+        if (kind == CompressionKind::Gzip) {
+            frame.size = BgzfBlockSize(data + pos, size - pos);
+            if (frame.size < 0) return false;
+            frame.contentSize = qFromLittleEndian<quint32>(Bytes(data + pos + frame.size - 4));
+            // ISIZE 损坏或不是 BGZF：整份按普通多成员 gzip 顺序解压
+            if (frame.contentSize > kBgzfMaxContent) return false;
+        } else {
+#ifdef PAT_HAS_ZSTD
+            const size_t frameSize = ZSTD_findFrameCompressedSize(data + pos, static_cast<size_t>(size - pos));
+            if (ZSTD_isError(frameSize)) return false;
+            frame.size = static_cast<qint64>(frameSize);
+            const unsigned long long content = ZSTD_getFrameContentSize(data + pos, static_cast<size_t>(size - pos));
+            // 内容长度由帧头给出、未经校验，过大时视为未知，按实际解出的数据追加
+            const bool plausible = content != ZSTD_CONTENTSIZE_UNKNOWN && content != ZSTD_CONTENTSIZE_ERROR &&
+                                   content <= static_cast<unsigned long long>(frame.size) * kZstdMaxRatio;
+            frame.contentSize = plausible ? static_cast<qint64>(content) : -1;
+#else
+            return false;
+#endif
+        }
+        frames.push_back(frame);
+        pos += frame.size;
+    }
+    return true;
+}
+
+#ifdef PAT_HAS_ZLIB
+bool InflateGzip(const char* data, qint64 size, const DecompressSink& sink, QString& errorMessage) {
+    z_stream zs{};
+    if (inflateInit2(&zs, 15 + 32) != Z_OK) {
+        errorMessage = QStringLiteral("zlib 初始化失败");
+        return false;
+    }
+    QByteArray out(kOutputChunk, Qt::Uninitialized);
+    const uchar* in = Bytes(data);
+    qint64 remaining = size;
+    bool ok = true;
+    while (true) {
+        if (zs.avail_in == 0 && remaining > 0) {
+            const uInt feed = static_cast<uInt>(std::min<qint64>(remaining, 1 << 30));
+            zs.next_in = const_cast<Bytef*>(in);
+            zs.avail_in = feed;
+            in += feed;
+            remaining -= feed;
+        }
+        zs.next_out = reinterpret_cast<Bytef*>(out.data());
+        zs.avail_out = static_cast<uInt>(out.size());
+        const int ret = inflate(&zs, Z_NO_FLUSH);
+        const qint64 produced = out.size() - zs.avail_out;
+        if (produced > 0 && !sink(out.constData(), produced)) {
+            ok = false;
+            break;
+        }
+        if (ret == Z_STREAM_END) {
+            if (zs.avail_in == 0 && remaining == 0) break;
+            inflateReset(&zs);  // 多成员 gzip：继续解下一个成员
+            continue;
+        }
+        if (ret == Z_BUF_ERROR && zs.avail_in == 0 && remaining == 0) {
+            errorMessage = QStringLiteral("gzip 数据不完整");
+            ok = false;
+            break;
+        }
+        if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            errorMessage = QStringLiteral("gzip 解压失败：%1").arg(QString::fromLatin1(zs.msg ? zs.msg : "unknown"));
+            ok = false;
+            break;
+        }
+    }
+    inflateEnd(&zs);
+    return ok;
+}
+
+bool InflateBgzfBlock(const char* data, qint64 size, char* out, qint64 outSize, QString& errorMessage) {
+    z_stream zs{};
+    if (inflateInit2(&zs, 15 + 16) != Z_OK) {
+        errorMessage = QStringLiteral("zlib 初始化失败");
+        return false;
+    }
+    zs.next_in = const_cast<Bytef*>(Bytes(data));
+    zs.avail_in = static_cast<uInt>(size);
+    zs.next_out = reinterpret_cast<Bytef*>(out);
+    zs.avail_out = static_cast<uInt>(outSize);
+    const int ret = inflate(&zs, Z_FINISH);
+    inflateEnd(&zs);
+    if (ret != Z_STREAM_END || zs.avail_out != 0) {
+        errorMessage = QStringLiteral("gzip 块解压失败");
+        return false;
+    }
+    return true;
+}
+#endif
+
+#ifdef PAT_HAS_ZSTD
+bool DecompressZstdStream(const char* data, qint64 size, const DecompressSink& sink, QString& errorMessage) {
+    ZSTD_DCtx* dctx = ZSTD_createDCtx();
+    QByteArray out(static_cast<qsizetype>(ZSTD_DStreamOutSize()), Qt::Uninitialized);
+    ZSTD_inBuffer input{data, static_cast<size_t>(size), 0};
+    size_t pending = 0;
+    bool ok = true;
+    // 输入耗尽后仍可能有输出未取完，直到解码器报告帧结束
+    while (input.pos < input.size || pending != 0) {
+        ZSTD_outBuffer output{out.data(), static_cast<size_t>(out.size()), 0};
+        const size_t before = input.pos;
+        pending = ZSTD_decompressStream(dctx, &output, &input);
+        if (ZSTD_isError(pending)) {
+            errorMessage = QStringLiteral("zstd 解压失败：%1").arg(QString::fromLatin1(ZSTD_getErrorName(pending)));
+            ok = false;
+            break;
+        }
+        if (output.pos > 0 && !sink(out.constData(), static_cast<qint64>(output.pos))) {
+            ok = false;
+            break;
+        }
+        if (output.pos == 0 && input.pos == before && input.pos == input.size) {
+            errorMessage = QStringLiteral("zstd 数据不完整");
+            ok = false;
+            break;
+        }
+    }
+    ZSTD_freeDCtx(dctx);
+    return ok;
+}
+#endif
+
+// 解压连续的若干帧；每帧内容长度已知时直接解到最终位置，否则流式追加
+TaskResult DecompressFrames(const char* data, CompressionKind kind, const std::vector<FrameSpan>& frames, size_t first, size_t last) {
+    TaskResult result;
+    qint64 total = 0;
+    bool sized = true;
+    for (size_t f = first; f < last && sized; ++f) {
+        const qint64 content = frames[f].contentSize;
+        sized = content >= 0 && content <= std::numeric_limits<qsizetype>::max() - total;
+        if (sized) total += content;
+    }
+    if (sized) result.data.resize(total);
+    qint64 pos = 0;
+    for (size_t f = first; f < last && result.ok; ++f) {
+        const FrameSpan& frame = frames[f];
+        const char* src = data + frame.offset;
+        if (!sized) {
+            const DecompressSink append = [&result](const char* chunk, qint64 length) {
+                result.data.append(chunk, length);
+                return true;
+            };
+            result.ok = DecompressStream(src, frame.size, kind, append, result.error);
+            continue;
+        }
+        if (kind == CompressionKind::Gzip) {
+#ifdef PAT_HAS_ZLIB
+            result.ok = InflateBgzfBlock(src, frame.size, result.data.data() + pos, frame.contentSize, result.error);
+#endif
+        } else {
+#ifdef PAT_HAS_ZSTD
+            const size_t written = ZSTD_decompress(result.data.data() + pos, static_cast<size_t>(frame.contentSize), src,
+                                                   static_cast<size_t>(frame.size));
+            if (ZSTD_isError(written) || static_cast<qint64>(written) != frame.contentSize) {
+                result.ok = false;
+                result.error = QStringLiteral("zstd 帧解压失败");
+            }
+#endif
+        }
+        pos += frame.contentSize;
+    }
+    return result;
+}
+
+// 按帧并行：每组帧是共享任务池中的一个任务，按文件顺序逐个等待并交付给 sink，在途任务数限制为线程数的两倍。
+// 等待时调用线程也执行排队的任务；出错后取消尚未开始的任务
+bool DecompressFramesParallel(const char* data,
+                              CompressionKind kind,
+                              const std::vector<FrameSpan>& frames,
+                              const DecompressSink& sink,
+                              QString& errorMessage) {
+    std::vector<std::pair<size_t, size_t>> tasks;
+    for (size_t first = 0; first < frames.size();) {
+        size_t last = first;
+        qint64 bytes = 0;
+        while (last < frames.size() && (last == first || bytes < kTaskCompressedBytes)) bytes += frames[last++].size;
+        tasks.emplace_back(first, last);
+        first = last;
+    }
+
+    struct Pending {
+        TaskResult result;
+        std::unique_ptr<TaskGroup> group;
+    };
+    TaskScheduler& scheduler = TaskScheduler::Instance();
+    const CancellationToken token;
+    const size_t window = static_cast<size_t>(scheduler.WorkerCount() + 1) * 2;
+    std::deque<Pending> inFlight;
+    size_t next = 0;
+    auto launch = [&]() {
+        const auto task = tasks[next++];
+        Pending& pending = inFlight.emplace_back();
+        pending.group = std::make_unique<TaskGroup>(TaskPriority::Normal, token, scheduler);
+        TaskResult* slot = &pending.result;
+        pending.group->Run([data, kind, &frames, task, slot]() {
+            *slot = DecompressFrames(data, kind, frames, task.first, task.second);
+        });
+    };
+    // 出错返回时先取消，再由各任务组析构等待已开始的任务结束
+    auto fail = [&]() {
+        token.Cancel();
+        return false;
+    };
+    while (next < tasks.size() && inFlight.size() < window) launch();
+    while (!inFlight.empty()) {
+        if (!inFlight.front().group->Wait()) return fail();
+        TaskResult result = std::move(inFlight.front().result);
+        inFlight.pop_front();
+        if (!result.ok) {
+            errorMessage = result.error;
+            return fail();
+        }
+        if (next < tasks.size()) launch();
+        if (!result.data.isEmpty() && !sink(result.data.constData(), result.data.size())) return fail();
+    }
+    return true;
+}
+
+}  // namespace
+
+CompressionKind DetectCompression(const char* data, qint64 size) {
+    if (!data || size < 4) return CompressionKind::None;
+    const uchar* p = Bytes(data);
+    if (p[0] == 0x1f && p[1] == 0x8b && p[2] == 8 && (p[3] & 0xe0) == 0) return CompressionKind::Gzip;
+    if (p[0] == 0x28 && p[1] == 0xb5 && p[2] == 0x2f && p[3] == 0xfd) return CompressionKind::Zstd;
+    return CompressionKind::None;
+}
+
+bool IsCompressionSupported(CompressionKind kind) {
+    switch (kind) {
+    case CompressionKind::None:
+        return true;
+    case CompressionKind::Gzip:
+#ifdef PAT_HAS_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    case CompressionKind::Zstd:
+#ifdef PAT_HAS_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+QString CompressionName(CompressionKind kind) {
+    switch (kind) {
+    case CompressionKind::Gzip:
+        return QStringLiteral("gzip");
+    case CompressionKind::Zstd:
+        return QStringLiteral("zstd");
+    case CompressionKind::None:
+        break;
+    }
+    return QStringLiteral("none");
+}
+
+bool DecompressStream(const char* data,
+                      qint64 size,
+                      CompressionKind kind,
+                      const DecompressSink& sink,
+                      QString& errorMessage) {
+    const TraceScope trace("DecompressStream", "io");
+    if (kind == CompressionKind::None) return size <= 0 || sink(data, size);
+    if (!IsCompressionSupported(kind)) {
+        errorMessage = QStringLiteral("当前构建不支持 %1 压缩数据").arg(CompressionName(kind));
+        return false;
+    }
+
+    std::vector<FrameSpan> frames;
+    if (SplitFrames(data, size, kind, frames) && frames.size() > 1) {
+        return DecompressFramesParallel(data, kind, frames, sink, errorMessage);
+    }
+#ifdef PAT_HAS_ZLIB
+    if (kind == CompressionKind::Gzip) return InflateGzip(data, size, sink, errorMessage);
+#endif
+#ifdef PAT_HAS_ZSTD
+    if (kind == CompressionKind::Zstd) return DecompressZstdStream(data, size, sink, errorMessage);
+#endif
+    return false;
+}
+
+qint64 DecompressedSizeHint(const char* data, qint64 size, CompressionKind kind) {
+    if (kind == CompressionKind::None) return size;
+    if (!IsCompressionSupported(kind)) return -1;
+    std::vector<FrameSpan> frames;
+    if (!SplitFrames(data, size, kind, frames)) return -1;
+    qint64 total = 0;
+    for (const FrameSpan& frame : frames) {
+        if (frame.contentSize < 0 || frame.contentSize > std::numeric_limits<qint64>::max() - total) return -1;
+        total += frame.contentSize;
+    }
+    return total;
+}
+
+bool CompressFrame(CompressionKind kind, const char* data, qint64 size, QByteArray& out, QString& errorMessage) {
+    if (!IsCompressionSupported(kind) || kind == CompressionKind::None) {
+        errorMessage = QStringLiteral("当前构建不支持 %1 压缩").arg(CompressionName(kind));
+        return false;
+    }
+    if (kind == CompressionKind::Zstd) {
+#ifdef PAT_HAS_ZSTD
+        const qsizetype base = out.size();
+        out.resize(base + static_cast<qsizetype>(ZSTD_compressBound(static_cast<size_t>(size))));
+        const size_t written = ZSTD_compress(out.data() + base, static_cast<size_t>(out.size() - base), data,
+                                             static_cast<size_t>(size), 3);
+        if (ZSTD_isError(written)) {
+            errorMessage = QStringLiteral("zstd 压缩失败：%1").arg(QString::fromLatin1(ZSTD_getErrorName(written)));
+            out.resize(base);
+            return false;
+        }
+        out.resize(base + static_cast<qsizetype>(written));
+#endif
+        return true;
+    }
+
+#ifdef PAT_HAS_ZLIB
+    // BGZF：每块是带 'BC' 扩展字段的完整 gzip 成员，普通 gzip 工具同样可以解压
+    QByteArray deflated(static_cast<qsizetype>(compressBound(static_cast<uLong>(kBgzfMaxInput))), Qt::Uninitialized);
+    for (qint64 pos = 0; pos < size; pos += kBgzfMaxInput) {
+        const qint64 length = std::min(kBgzfMaxInput, size - pos);
+        qint64 compressed = 0;
+        for (const int level : {6, 0}) {  // 不可压缩时退回存储块，保证块长不超过 64 KiB
+            z_stream zs{};
+            if (deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                errorMessage = QStringLiteral("zlib 初始化失败");
+                return false;
+            }
+            zs.next_in = const_cast<Bytef*>(Bytes(data + pos));
+            zs.avail_in = static_cast<uInt>(length);
+            zs.next_out = reinterpret_cast<Bytef*>(deflated.data());
+            zs.avail_out = static_cast<uInt>(deflated.size());
+            const int ret = deflate(&zs, Z_FINISH);
+            compressed = deflated.size() - zs.avail_out;
+            deflateEnd(&zs);
+            if (ret != Z_STREAM_END) {
+                errorMessage = QStringLiteral("gzip 压缩失败");
+                return false;
+            }
+            if (compressed + kBgzfHeaderSize + kGzipTrailerSize <= 0x10000) break;
+        }
+
+        const qint64 blockSize = compressed + kBgzfHeaderSize + kGzipTrailerSize;
+        uchar header[kBgzfHeaderSize] = {0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0, 0, 0};
+        qToLittleEndian<quint16>(static_cast<quint16>(blockSize - 1), header + 16);
+        uchar trailer[kGzipTrailerSize];
+        const uLong crc = crc32(crc32(0L, Z_NULL, 0), Bytes(data + pos), static_cast<uInt>(length));
+        qToLittleEndian<quint32>(static_cast<quint32>(crc), trailer);
+        qToLittleEndian<quint32>(static_cast<quint32>(length), trailer + 4);
+        out.append(reinterpret_cast<const char*>(header), kBgzfHeaderSize);
+        out.append(deflated.constData(), compressed);
+        out.append(reinterpret_cast<const char*>(trailer), kGzipTrailerSize);
+    }
+#endif
+    return true;
+}
+
+}  // namespace pat
@@ -0,0 +1,34 @@
+﻿#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include <functional>
+
+namespace pat {
+
+enum class CompressionKind { None, Gzip, Zstd };
+
+// 按文件头识别：gzip 为 1F 8B、压缩方法 8（deflate）且标志字节保留位为 0；zstd 为 28 B5 2F FD。
+// 原始记录恰好以这些字节开头时，格式中 compression 设为 none 跳过识别
+CompressionKind DetectCompression(const char* data, qint64 size);
+// 取决于构建时是否找到 zlib / libzstd
+bool IsCompressionSupported(CompressionKind kind);
+QString CompressionName(CompressionKind kind);
+
+// 解压出的数据按文件顺序分段交给 sink，分段边界与记录边界无关；sink 返回 false 时中止。
+// 多帧 zstd 与 BGZF 分块 gzip 按帧并行解压，同时在途的帧数有上限，不保留整份解压结果
+using DecompressSink = std::function<bool(const char* data, qint64 size)>;
+bool DecompressStream(const char* data,
+                      qint64 size,
+                      CompressionKind kind,
+                      const DecompressSink& sink,
+                      QString& errorMessage);
+
+// 解压后的总长度，仅当每一帧都记录了内容长度时可知，否则返回 -1
+qint64 DecompressedSizeHint(const char* data, qint64 size, CompressionKind kind);
+
+// 把 data 压缩为可独立解压的帧追加到 out：zstd 为一个帧，gzip 为若干 BGZF 块，便于读取时并行解压
+bool CompressFrame(CompressionKind kind, const char* data, qint64 size, QByteArray& out, QString& errorMessage);
+
+}  // namespace pat
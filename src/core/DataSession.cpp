@@ -1,26 +1,420 @@
 ﻿#include "core/DataSession.h"
 
+#include "core/Compression.h"
+#include "core/PerfCounters.h"
+#include "core/TaskScheduler.h"
+#include "core/Trace.h"
+
 #include <algorithm>
 #include <cmath>
 #include <limits>
 #include <utility>
+#include <vector>
 
+#include <QFile>
+#include <QFileInfo>
 #include <QtGlobal>
 
 namespace pat {
+namespace {
+
+// 外存模式能否按记录窗口分段解码再拼接：记录位置可由序号算出，且相邻窗口之间没有要延续的状态
+// （回绕计数的累计量、帧 ID 的取样计数）
+bool SupportsWindowedParse(const FormatDefinition& format, const QString& path) {
+    if (format.syncWord.enabled || format.recordTypes.enabled) return false;
+    if (format.timestamp.enabled && format.timestamp.rollover > 0.0) return false;
+    for (const auto& sig : format.signalFormats) {
+        if (sig.hasFrameId) return false;
+    }
+    if (!format.detectCompression) return true;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    char magic[4] = {};
+    const qint64 magicBytes = file.read(magic, sizeof(magic));
+    return DetectCompression(magic, std::max<qint64>(0, magicBytes)) == CompressionKind::None;
+}
+
+// 每个窗口解码出的 double 约占内存预算的 1/4：每条记录每个信号至多一个值，外加时间列
+qint64 WindowRecords(const FormatDefinition& format, qint64 memoryBudget) {
+    const qint64 columns = static_cast<qint64>(format.signalFormats.size()) + 2;
+    return std::max<qint64>(ChunkStore::kChunkSamples, memoryBudget / 4 / (columns * static_cast<qint64>(sizeof(double))));
+}
+
+// 解码结果的峰值估计：每条记录每个信号至多一个 double（子换向按 stride 折算），显式时间轴每条记录一个 double。
+// 压缩文件按压缩后的大小计，偏小
+qint64 EstimateDecodedBytes(const FormatDefinition& format, const QString& path, const RecordRange& range) {
+    if (format.recordSize <= 0) return 0;
+    const qint64 fileRecords = QFileInfo(path).size() / format.recordSize;
+    const qint64 first = std::clamp<qint64>(range.firstRecord, 0, fileRecords);
+    const qint64 records = range.recordCount < 0 ? fileRecords - first : std::min(fileRecords - first, range.recordCount);
+    double columnsPerRecord = format.timestamp.enabled ? 1.0 : 0.0;
+    for (const auto& sig : format.signalFormats) {
+        const double share = 1.0 / std::max(1, sig.recordStride);
+        columnsPerRecord += sig.hasFrameId ? 2.0 * share : share;
+    }
+    return static_cast<qint64>(static_cast<double>(records) * columnsPerRecord * sizeof(double));
+}
+
+void AppendValidity(Series& target, qsizetype offset, const Series& window) {
+    if (!window.HasInvalid() && !target.HasInvalid()) return;
+    if (!target.HasInvalid()) target.validity = QVector<quint64>((offset + 63) / 64, ~quint64{0});
+    target.validity.resize((offset + window.Size() + 63) / 64);
+    for (qsizetype k = 0; k < window.Size(); ++k) {
+        const qsizetype bit = offset + k;
+        const quint64 mask = quint64{1} << (bit & 63);
+        if (window.IsValid(k)) {
+            target.validity[bit >> 6] |= mask;
+        } else {
+            target.validity[bit >> 6] &= ~mask;
+        }
+    }
+}
+
+// 把逐窗口解码出的 Series 追加到外存列，拼成整段；共享时间轴的信号共用一列时间
+class StoreAppender {
+public:
+    StoreAppender(std::shared_ptr<ChunkStore> store, bool explicitTimes) : store_(std::move(store)), explicitTimes_(explicitTimes) {}
+
+    bool Append(const QVector<pat::Series>& window, QString& errorMessage) {
+        if (out_.isEmpty()) Begin(window);
+        std::vector<bool> timesDone(lastTime_.size(), false);
+        for (int i = 0; i < window.size(); ++i) {
+            const pat::Series& part = window[i];
+            pat::Series& target = out_[i];
+            if (target.storedSize == 0) {
+                target.timeOrigin = part.timeOrigin;
+                target.timeStep = part.timeStep;
+            }
+            if (!store_->Append(target.valueColumn, part.values.constData(), part.Size(), errorMessage)) return false;
+            const size_t column = static_cast<size_t>(target.timeColumn);
+            if (target.timeColumn >= 0 && !timesDone[column] && !part.times.isEmpty()) {
+                if (part.times.first() < lastTime_[column]) {
+                    errorMessage = QStringLiteral("时间戳不单调：信号 %1").arg(part.name);
+                    return false;
+                }
+                if (!store_->Append(target.timeColumn, part.times.constData(), part.times.size(), errorMessage)) return false;
+                lastTime_[column] = part.times.last();
+                timesDone[column] = true;
+            }
+            AppendValidity(target, target.storedSize, part);
+            target.storedSize += part.Size();
+        }
+        return true;
+    }
+
+    void Finish(QVector<pat::Series>& outSeries) {
+        std::vector<int> indexedBy(lastTime_.size(), -1);
+        for (int i = 0; i < out_.size(); ++i) {
+            pat::Series& series = out_[i];
+            if (series.timeColumn < 0) continue;
+            const size_t column = static_cast<size_t>(series.timeColumn);
+            if (indexedBy[column] >= 0) {
+                series.timeIndex = out_[indexedBy[column]].timeIndex;
+                series.timeStep = out_[indexedBy[column]].timeStep;
+                continue;
+            }
+            series.BuildTimeIndex();
+            if (series.Size() > 1) {
+                SeriesReader reader(series);
+                series.timeStep = (reader.Time(series.Size() - 1) - reader.Time(0)) / static_cast<double>(series.Size() - 1);
+            }
+            indexedBy[column] = i;
+        }
+        outSeries = std::move(out_);
+    }
+
+private:
+    void Begin(const QVector<pat::Series>& window) {
+        out_.resize(window.size());
+        for (int i = 0; i < window.size(); ++i) {
+            const pat::Series& part = window[i];
+            pat::Series& target = out_[i];
+            target.name = part.name;
+            target.unit = part.unit;
+            target.store = store_;
+            target.valueColumn = store_->AddColumn();
+            if (!explicitTimes_ && part.IsUniform()) continue;
+            for (int j = 0; j < i && !part.times.isEmpty(); ++j) {
+                if (window[j].times.constData() == part.times.constData()) {
+                    target.timeColumn = out_[j].timeColumn;
+                    break;
+                }
+            }
+            if (target.timeColumn < 0) {
+                target.timeColumn = store_->AddColumn();
+                lastTime_.resize(static_cast<size_t>(target.timeColumn) + 1, -std::numeric_limits<double>::infinity());
+            }
+        }
+    }
+
+    std::shared_ptr<ChunkStore> store_;
+    bool explicitTimes_ = false;
+    QVector<pat::Series> out_;
+    std::vector<double> lastTime_;  // 按存储列号，非时间列不用
+};
+
+// 外存模式加载：可定位的格式逐窗口 ParseRange 后追加到存储，窗口用完即释放
+bool ParseIntoStore(const RecordParser& parser,
+                    const FormatDefinition& format,
+                    const QString& path,
+                    const RecordRange& range,
+                    const std::shared_ptr<ChunkStore>& store,
+                    QVector<pat::Series>& outSeries,
+                    ParseReport& outReport,
+                    QString& errorMessage) {
+    const TraceScope trace("ParseIntoStore", "parse");
+    QVector<pat::Series> window;
+    if (!SupportsWindowedParse(format, path)) {
+        // 记录位置依赖顺序扫描，只能整段解码，峰值内存与常驻模式相同
+        StoreAppender appender(store, false);
+        if (!parser.ParseRange(path, range, window, errorMessage, &outReport)) return false;
+        if (!appender.Append(window, errorMessage)) return false;
+        appender.Finish(outSeries);
+        return true;
+    }
+
+    const qint64 totalRecords = format.recordSize > 0 ? QFileInfo(path).size() / format.recordSize : 0;
+    const qint64 first = std::clamp<qint64>(range.firstRecord, 0, totalRecords);
+    const qint64 last = range.recordCount < 0 ? totalRecords : std::min(totalRecords, first + range.recordCount);
+    if (last <= first) {
+        errorMessage = totalRecords == 0 ? QStringLiteral("数据长度不足一个记录")
+                                         : QStringLiteral("记录范围超出文件：共 %1 条记录").arg(totalRecords);
+        return false;
+    }
+
+    StoreAppender appender(store, format.timestamp.enabled);
+    const qint64 step = WindowRecords(format, store->Stats().memoryBudget);
+    outReport = ParseReport{};
+    for (qint64 base = first; base < last; base += step) {
+        RecordRange part;
+        part.firstRecord = base;
+        part.recordCount = std::min(step, last - base);
+        ParseReport partReport;
+        if (!parser.ParseRange(path, part, window, errorMessage, &partReport)) return false;
+        if (!appender.Append(window, errorMessage)) return false;
+        outReport.recordCount += partReport.recordCount;
+        outReport.invalidRecords += partReport.invalidRecords;
+    }
+    window.clear();
+    appender.Finish(outSeries);
+    return true;
+}
+
+// 平均游程不短于此长度才按游程存储（游程 24 字节，约为原大小的 1/10 以下）
+constexpr qsizetype kMinAverageRun = 32;
+
+// Auto 策略下单精度是否足够：float32 来源本身只有 24 位尾数；8/16 位整数来源换算后的最大幅值
+// 不超过 2^18 个量化步长（|scale|）时，单精度舍入误差不到量化步长的 1/64
+bool Float32Sufficient(const SignalFormat& sig) {
+    if (sig.valueType == QStringLiteral("float32")) return true;
+    int bits = 0;
+    if (sig.valueType == QStringLiteral("int8") || sig.valueType == QStringLiteral("uint8")) bits = 8;
+    if (sig.valueType == QStringLiteral("int16") || sig.valueType == QStringLiteral("uint16")) bits = 16;
+    const double step = std::abs(sig.scale);
+    if (bits == 0 || step == 0.0 || !std::isfinite(step) || !std::isfinite(sig.bias)) return false;
+    return std::ldexp(step, bits) + std::abs(sig.bias) <= std::ldexp(step, 18);
+}
+
+bool UseFloat32(const SignalFormat& sig, ValuePrecision sessionPrecision) {
+    switch (sig.hasPrecision ? sig.precision : sessionPrecision) {
+    case ValuePrecision::Float32:
+        return true;
+    case ValuePrecision::Auto:
+        return Float32Sufficient(sig);
+    case ValuePrecision::Float64:
+        break;
+    }
+    return false;
+}
+
+// 先尝试游程编码（任意值类型），不成再对整数类型的信号尝试打包，仍为双精度数组的按精度策略转为单精度；
+// 各信号相互独立，分给多个线程
+void CompactColumns(const FormatDefinition& format, bool packColumns, ValuePrecision precision, QVector<pat::Series>& series) {
+    const TraceScope trace("CompactColumns", "load");
+    std::vector<int> candidates;
+    for (int i = 0; i < series.size() && i < static_cast<int>(format.signalFormats.size()); ++i) {
+        if (series[i].IsPlain() && !series[i].IsEmpty()) candidates.push_back(i);
+    }
+    const auto packOne = [&](int index) {
+        pat::Series& target = series[index];
+        const SignalFormat& sig = format.signalFormats[static_cast<size_t>(index)];
+        if (packColumns && target.Size() >= PackedColumn::kBlockSamples) {
+            RunColumn runs;
+            if (RunColumn::Encode(target.values, target.values.size() / kMinAverageRun, runs)) {
+                target.runs = std::make_shared<const RunColumn>(std::move(runs));
+                target.values = QVector<double>();
+                return;
+            }
+            const bool integer = sig.valueType.startsWith(QStringLiteral("int")) || sig.valueType.startsWith(QStringLiteral("uint"));
+            PackedColumn packed;
+            if (integer && PackedColumn::Encode(target.values, sig.scale, sig.bias, packed) &&
+                packed.ByteSize() * 2 <= target.values.size() * static_cast<qint64>(sizeof(double))) {
+                target.packed = std::make_shared<const PackedColumn>(std::move(packed));
+                target.values = QVector<double>();
+                return;
+            }
+        }
+        if (!UseFloat32(sig, precision)) return;
+        QVector<float> narrowed(target.values.size());
+        const double* source = target.values.constData();
+        float* dest = narrowed.data();
+        for (qsizetype k = 0; k < narrowed.size(); ++k) dest[k] = static_cast<float>(source[k]);
+        target.values32 = std::move(narrowed);
+        target.values = QVector<double>();
+    };
+    TaskScheduler::Instance().ParallelFor(0, static_cast<qint64>(candidates.size()), 1, [&](qint64 first, qint64 last) {
+        for (qint64 c = first; c < last; ++c) packOne(candidates[static_cast<size_t>(c)]);
+    });
+}
+
+}  // namespace
+
+SignalStatistics ComputeSignalStatistics(const Series& series) {
+    const TraceScope trace("ComputeSignalStatistics", "stats");
+    SignalStatistics stats;
+    if (series.IsEmpty()) return stats;
+
+    double mean = 0.0;
+    double m2 = 0.0;
+    double sumSquares = 0.0;
+    double minValue = std::numeric_limits<double>::infinity();
+    double maxValue = -std::numeric_limits<double>::infinity();
+    qint64 n = 0;
+    const auto accumulate = [&](double y) {
+        minValue = std::min(minValue, y);
+        maxValue = std::max(maxValue, y);
+        sumSquares += y * y;
+        ++n;
+        const double delta = y - mean;
+        mean += delta / static_cast<double>(n);
+        m2 += delta * (y - mean);
+    };
+    // 常量块整体并入（按两组方差合并的公式），不逐个样本累加
+    const auto accumulateRun = [&](double y, qint64 count) {
+        minValue = std::min(minValue, y);
+        maxValue = std::max(maxValue, y);
+        sumSquares += y * y * static_cast<double>(count);
+        const double total = static_cast<double>(n + count);
+        const double delta = y - mean;
+        mean += delta * static_cast<double>(count) / total;
+        m2 += delta * delta * static_cast<double>(n) * static_cast<double>(count) / total;
+        n += count;
+    };
+    // 外存模式下逐块换入，压缩列的常量块与游程列的每段游程只看块头，统计只需顺序扫一遍
+    SeriesReader reader(series);
+    const bool checkValid = series.HasInvalid();
+    const auto accumulateSpan = [&](qsizetype first, const auto* values, qsizetype count) {
+        for (qsizetype k = 0; k < count; ++k) {
+            // 校验失败的样本不计入统计
+            if (!checkValid || series.IsValid(first + k)) accumulate(values[k]);
+        }
+    };
+    for (qsizetype i = 0; i < series.Size();) {
+        qsizetype stop = series.Size();
+        qsizetype blockFirst = 0;
+        qsizetype blockCount = 0;
+        double blockMin = 0.0;
+        double blockMax = 0.0;
+        if (reader.ValueBlockSummary(i, blockFirst, blockCount, blockMin, blockMax)) {
+            stop = blockFirst + blockCount;
+            if (!checkValid && blockMin == blockMax) {
+                accumulateRun(blockMin, stop - i);
+                i = stop;
+                continue;
+            }
+        }
+        reader.ForEachValueSpan(i, stop, accumulateSpan);
+        i = stop;
+    }
+    if (n == 0) return stats;
+
+    stats.count = n;
+    stats.minValue = minValue;
+    stats.maxValue = maxValue;
+    stats.mean = mean;
+    stats.stdDev = n > 1 ? std::sqrt(m2 / static_cast<double>(n - 1)) : 0.0;
+    stats.rms = std::sqrt(sumSquares / static_cast<double>(n));
+    stats.firstTime = reader.Time(0);
+    stats.lastTime = reader.Time(series.Size() - 1);
+    return stats;
+}
 
 bool DataSession::Load(const QString& path, const FormatDefinition& format, QString& errorMessage) {
+    return LoadRange(path, format, RecordRange(), errorMessage);
+}
+
+bool DataSession::LoadRange(const QString& path, const FormatDefinition& format, const RecordRange& range, QString& errorMessage) {
+    const TraceScope trace("DataSession::LoadRange", "load");
+    const qint64 startNs = TraceRecorder::NowNs();
+    RecordParser parser(format);
+    parser.SetReadBackend(readBackend_);
+    QVector<pat::Series> parsed;
+    ParseReport report;
+    std::shared_ptr<ChunkStore> store;
+    // 进程内存上限放不下时改用外存模式，块缓存以剩余额度为限
+    if (!memoryAccount_) memoryAccount_ = MemoryGovernor::Instance().Register();
+    const qint64 grant = MemoryGovernor::Instance().Admit(memoryAccount_, EstimateDecodedBytes(format, path, range));
+    const qint64 chunkBudget = grant > 0 && (memoryBudget_ <= 0 || grant < memoryBudget_) ? grant : memoryBudget_;
+    bool ok = false;
+    if (chunkBudget > 0) {
+        store = std::make_shared<ChunkStore>(chunkBudget);
+        ok = ParseIntoStore(parser, format, path, range, store, parsed, report, errorMessage);
+    } else {
+        ok = parser.ParseRange(path, range, parsed, errorMessage, &report);
+        if (ok) CompactColumns(format, packColumns_, precision_, parsed);
+    }
+    if (!ok) {
+        UpdateMemoryAccount();
+        return false;
+    }
+
+    series_ = std::move(parsed);
+    store_ = std::move(store);
+    parseReport_ = std::move(report);
+    path_ = path;
+    timeUnit_ = format.timeAxisUnit;
+    hasData_ = true;
+    previewStep_ = 0;
+    range_ = range;
+    ComputeStatistics();
+    UpdateMemoryAccount();
+    // 吞吐量按读入的字节计：整个文件为文件大小，部分加载按记录数折算
+    const qint64 recordCount = parseReport_.recordCount;
+    const qint64 inputBytes = range.IsFull() || format.recordSize <= 0 ? QFileInfo(path).size() : recordCount * format.recordSize;
+    PerfCounters::Instance().RecordLoad(inputBytes, recordCount, TraceRecorder::NowNs() - startNs);
+    return true;
+}
+
+bool DataSession::LoadTimeWindow(const QString& path,
+                                 const FormatDefinition& format,
+                                 double startTime,
+                                 double endTime,
+                                 QString& errorMessage) {
+    RecordRange range;
+    if (!RecordParser(format).ResolveTimeWindow(path, startTime, endTime, range, errorMessage)) return false;
+    return LoadRange(path, format, range, errorMessage);
+}
+
+bool DataSession::LoadPreview(const QString& path, const FormatDefinition& format, qint64 maxRecords, QString& errorMessage) {
+    const TraceScope trace("DataSession::LoadPreview", "load");
     RecordParser parser(format);
     QVector<pat::Series> parsed;
-    if (!parser.ParseFile(path, parsed, errorMessage)) {
+    ParseReport report;
+    qint64 step = 0;
+    if (!parser.ParsePreview(path, maxRecords, parsed, step, errorMessage, &report)) {
         return false;
     }
 
     series_ = std::move(parsed);
+    parseReport_ = std::move(report);
     path_ = path;
     timeUnit_ = format.timeAxisUnit;
     hasData_ = true;
+    previewStep_ = step;
+    range_ = RecordRange();
+    store_.reset();
     ComputeStatistics();
+    UpdateMemoryAccount();
     return true;
 }
 
@@ -28,35 +422,126 @@ void DataSession::Clear() {
     series_.clear();
     path_.clear();
     timeUnit_.clear();
+    parseReport_ = ParseReport{};
     hasData_ = false;
+    previewStep_ = 0;
+    range_ = RecordRange();
+    store_.reset();
     statistics_ = SeriesStatistics{};
+    signalStatistics_.clear();
+    UpdateMemoryAccount();
+}
+
+SessionMemoryUsage DataSession::MemoryUsage() const {
+    SessionMemoryUsage usage;
+    usage.signalUsage.reserve(series_.size());
+    // 隐式共享的时间轴、索引与有效位图按数据地址去重
+    QVector<const void*> counted;
+    const auto countOnce = [&](const void* data) {
+        if (!data || counted.contains(data)) return false;
+        counted.append(data);
+        return true;
+    };
+    QVector<int> countedTimeColumns;
+    for (const auto& series : series_) {
+        SignalMemoryUsage signal;
+        signal.name = series.name;
+        if (series.store) {
+            signal.storage = QStringLiteral("chunked");
+            signal.chunkBytes = series.store->ColumnResidentBytes(series.valueColumn);
+            if (series.timeColumn >= 0 && !countedTimeColumns.contains(series.timeColumn)) {
+                countedTimeColumns.append(series.timeColumn);
+                signal.chunkBytes += series.store->ColumnResidentBytes(series.timeColumn);
+            }
+        } else if (series.packed) {
+            signal.storage = QStringLiteral("packed");
+            signal.valueBytes = series.packed->ByteSize();
+        } else if (series.runs) {
+            signal.storage = QStringLiteral("runs");
+            signal.valueBytes = series.runs->ByteSize();
+        } else if (!series.values32.isEmpty()) {
+            signal.storage = QStringLiteral("float32");
+            signal.valueBytes = static_cast<qint64>(series.values32.capacity()) * static_cast<qint64>(sizeof(float));
+        } else {
+            signal.storage = QStringLiteral("double");
+            signal.valueBytes = static_cast<qint64>(series.values.capacity()) * static_cast<qint64>(sizeof(double));
+        }
+        if (countOnce(series.times.constData())) {
+            signal.timeBytes = static_cast<qint64>(series.times.capacity()) * static_cast<qint64>(sizeof(double));
+        }
+        if (countOnce(series.timeIndex.constData())) {
+            signal.indexBytes = static_cast<qint64>(series.timeIndex.capacity()) * static_cast<qint64>(sizeof(double));
+        }
+        if (countOnce(series.validity.constData())) {
+            signal.validityBytes = static_cast<qint64>(series.validity.capacity()) * static_cast<qint64>(sizeof(quint64));
+        }
+        usage.signalUsage.append(signal);
+    }
+    usage.statisticsBytes = static_cast<qint64>(signalStatistics_.capacity()) * static_cast<qint64>(sizeof(SignalStatistics));
+    if (store_) {
+        const ChunkStoreStats stats = store_->Stats();
+        usage.spilledBytes = stats.spilledBytes;
+        usage.chunkBudget = stats.memoryBudget;
+    }
+    return usage;
+}
+
+void DataSession::UpdateMemoryAccount() {
+    if (!memoryAccount_) memoryAccount_ = MemoryGovernor::Instance().Register();
+    const SessionMemoryUsage usage = MemoryUsage();
+    MemoryGovernor::Instance().Update(memoryAccount_, path_, usage.TotalBytes() - usage.ChunkBytes(), store_);
 }
 
 void DataSession::ComputeStatistics() {
+    const TraceScope trace("DataSession::ComputeStatistics", "stats");
     statistics_ = SeriesStatistics{};
     statistics_.hasRange = false;
+    signalStatistics_.clear();
+    signalStatistics_.resize(series_.size());
 
     double minStep = std::numeric_limits<double>::infinity();
     bool hasStep = false;
 
-    for (const auto& series : series_) {
-        for (const auto& point : series.samples) {
+    // 逐信号统计互不依赖，以后台优先级并行，不挡住图表的交互抽稀
+    SignalStatistics* results = signalStatistics_.data();
+    TaskScheduler::Instance().ParallelFor(
+        0,
+        series_.size(),
+        1,
+        [this, results](qint64 first, qint64 last) {
+            for (qint64 i = first; i < last; ++i) results[i] = ComputeSignalStatistics(series_[i]);
+        },
+        TaskPriority::Background);
+
+    for (qsizetype s = 0; s < series_.size(); ++s) {
+        const auto& series = series_[s];
+        const SignalStatistics& signalStats = signalStatistics_[s];
+        if (signalStats.count > 0) {
             if (!statistics_.hasRange) {
-                statistics_.minY = statistics_.maxY = point.y();
+                statistics_.minY = signalStats.minValue;
+                statistics_.maxY = signalStats.maxValue;
+                statistics_.minX = signalStats.firstTime;
                 statistics_.hasRange = true;
             } else {
-                statistics_.minY = std::min(statistics_.minY, point.y());
-                statistics_.maxY = std::max(statistics_.maxY, point.y());
+                statistics_.minY = std::min(statistics_.minY, signalStats.minValue);
+                statistics_.maxY = std::max(statistics_.maxY, signalStats.maxValue);
+                statistics_.minX = std::min(statistics_.minX, signalStats.firstTime);
             }
-        }
-        if (!series.samples.isEmpty()) {
-            statistics_.maxX = std::max(statistics_.maxX, series.samples.last().x());
+            statistics_.maxX = std::max(statistics_.maxX, signalStats.lastTime);
         }
 
-        constexpr int kMaxStepScan = 4096;
-        const int count = std::min(static_cast<int>(series.samples.size()), kMaxStepScan);
-        for (int i = 1; i < count; ++i) {
-            const double dx = std::abs(series.samples.at(i).x() - series.samples.at(i - 1).x());
+        if (series.IsUniform()) {
+            if (series.Size() > 1 && series.timeStep > 0.0 && series.timeStep < minStep) {
+                minStep = series.timeStep;
+                hasStep = true;
+            }
+            continue;
+        }
+        constexpr qsizetype kMaxStepScan = 4096;
+        const qsizetype count = std::min(series.Size(), kMaxStepScan);
+        SeriesReader reader(series);
+        for (qsizetype i = 1; i < count; ++i) {
+            const double dx = std::abs(reader.Time(i) - reader.Time(i - 1));
             if (dx > 0.0 && dx < minStep) {
                 minStep = dx;
                 hasStep = true;
@@ -1,38 +1,100 @@
 ﻿#pragma once
 
+#include "core/ChunkStore.h"
+#include "core/MemoryGovernor.h"
 #include "core/RecordParser.h"
 
 #include <QString>
 
+#include <memory>
+
 namespace pat {
 
 struct SeriesStatistics {
     double minY = -1.0;
     double maxY = 1.0;
+    double minX = 0.0;  // 部分加载时为窗口起点的绝对时间
     double maxX = 0.0;
     double minStep = 1e-3;
     bool hasRange = false;
 };
 
+struct SignalStatistics {
+    qint64 count = 0;
+    double minValue = 0.0;
+    double maxValue = 0.0;
+    double mean = 0.0;
+    double stdDev = 0.0;
+    double rms = 0.0;
+    double firstTime = 0.0;
+    double lastTime = 0.0;
+};
+
+SignalStatistics ComputeSignalStatistics(const Series& series);
+
 class DataSession {
 public:
     bool Load(const QString& path, const FormatDefinition& format, QString& errorMessage);
+    // 部分加载：只解码记录范围 / 时间窗内的记录，时间轴为文件内的绝对时间
+    bool LoadRange(const QString& path, const FormatDefinition& format, const RecordRange& range, QString& errorMessage);
+    bool LoadTimeWindow(const QString& path,
+                        const FormatDefinition& format,
+                        double startTime,
+                        double endTime,
+                        QString& errorMessage);
+    // 抽样预览（约 maxRecords 条记录），完整解析完成前先行显示；之后再 Load 同一文件替换
+    bool LoadPreview(const QString& path, const FormatDefinition& format, qint64 maxRecords, QString& errorMessage);
     void Clear();
+    void ComputeStatistics();
+    void SetReadBackend(ReadBackend backend) { readBackend_ = backend; }
+    // 外存模式：bytes > 0 时解码结果按块存入临时文件，样本常驻内存约为 bytes；0 表示全部常驻内存。
+    // 记录可按序号定位的格式分窗口解码，峰值内存与文件大小无关；其余格式整段解码后再转入外存。
+    // 设置了进程内存上限（MemoryGovernor）时，估计放不下的加载也自动改用外存模式
+    void SetMemoryBudget(qint64 bytes) { memoryBudget_ = bytes; }
+    qint64 MemoryBudget() const { return memoryBudget_; }
+    // 压缩列：解码后游程足够少的信号（挡位、模式字）按游程存储，其余整数类型的信号按帧参考 + 差分 + 位打包存储
+    // （不足原大小一半时才替换），缓变的离散量、计数器通常压缩到原来的几十分之一；外存模式下不启用
+    void SetPackColumns(bool enabled) { packColumns_ = enabled; }
+    bool PackColumns() const { return packColumns_; }
+    // 未在格式中指定 precision 的信号所用的存储精度；单精度在解码后转换，统计仍按双精度累加。外存模式下不启用
+    void SetValuePrecision(ValuePrecision precision) { precision_ = precision; }
+    ValuePrecision Precision() const { return precision_; }
 
     bool HasData() const { return hasData_; }
+    bool IsPreview() const { return previewStep_ > 0; }
+    qint64 PreviewStep() const { return previewStep_; }
+    // 当前数据对应的记录范围；整文件加载时 IsFull()
+    const RecordRange& LoadedRange() const { return range_; }
     const QVector<pat::Series>& Series() const { return series_; }
     const SeriesStatistics& Statistics() const { return statistics_; }
+    const QVector<SignalStatistics>& PerSignalStatistics() const { return signalStatistics_; }
     const QString& Path() const { return path_; }
     const QString& TimeUnit() const { return timeUnit_; }
+    const ParseReport& LastParseReport() const { return parseReport_; }
+    // 外存模式下的存储（换入换出统计），未启用时为空
+    const std::shared_ptr<ChunkStore>& Store() const { return store_; }
+    // 按信号、按类别统计当前常驻内存
+    SessionMemoryUsage MemoryUsage() const;
 
 private:
-    void ComputeStatistics();
+    // 向 MemoryGovernor 登记当前占用（块缓存由其直接从存储读取）
+    void UpdateMemoryAccount();
 
     QVector<pat::Series> series_;
     QString path_;
     QString timeUnit_;
+    ParseReport parseReport_;
     bool hasData_ = false;
+    qint64 previewStep_ = 0;  // 预览时每多少条记录取一条，0 表示完整数据
+    RecordRange range_;
+    ReadBackend readBackend_ = ReadBackend::Mmap;
+    qint64 memoryBudget_ = 0;
+    bool packColumns_ = false;
+    ValuePrecision precision_ = ValuePrecision::Float64;
+    std::shared_ptr<ChunkStore> store_;
+    std::shared_ptr<MemoryGovernor::Account> memoryAccount_;
     SeriesStatistics statistics_;
+    QVector<SignalStatistics> signalStatistics_;
 };
 
 }  // namespace pat
@@ -0,0 +1,418 @@
+﻿#include "core/FileReader.h"
+
+#include <QByteArray>
+#include <QFile>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(Q_OS_LINUX) && __has_include(<linux/io_uring.h>)
+#define PAT_HAS_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace pat {
+namespace {
+
+// 一个在途读请求：读入 block 号块，可能分多次完成（短读时续读剩余部分）
+struct ReadSlot {
+    QByteArray buffer;
+    qint64 offset = 0;
+    qint64 length = 0;
+    qint64 filled = 0;
+    bool done = false;
+};
+
+void StartSlot(ReadSlot& slot, qint64 block, qint64 blockBytes, qint64 fileSize) {
+    slot.offset = block * blockBytes;
+    slot.length = std::min(blockBytes, fileSize - slot.offset);
+    slot.filled = 0;
+    slot.done = false;
+}
+
+QString ReadErrorMessage(int error) {
+    return QStringLiteral("读取数据文件失败：%1").arg(QString::fromLocal8Bit(std::strerror(error)));
+}
+
+bool ReadMapped(QFile& file, qint64 fileSize, const ReadSink& sink) {
+    QByteArray fallback;
+    const char* data = reinterpret_cast<const char*>(file.map(0, fileSize));
+    if (!data) {
+        fallback = file.readAll();
+        data = fallback.constData();
+        fileSize = fallback.size();
+    }
+    return fileSize <= 0 || sink(data, fileSize);
+}
+
+bool ReadBuffered(QFile& file, const FileReadOptions& options, const ReadSink& sink, QString& errorMessage) {
+    QByteArray buffer(options.blockBytes, Qt::Uninitialized);
+    while (true) {
+        const qint64 got = file.read(buffer.data(), options.blockBytes);
+        if (got < 0) {
+            errorMessage = QStringLiteral("读取数据文件失败：%1").arg(file.errorString());
+            return false;
+        }
+        if (got == 0) return true;
+        if (!sink(buffer.constData(), got)) return false;
+    }
+}
+
+#ifdef PAT_HAS_URING
+// 不依赖 liburing 的最小 io_uring 封装：单线程提交与收割，只用 READV
+class UringQueue {
+public:
+    UringQueue() = default;
+    UringQueue(const UringQueue&) = delete;
+    UringQueue& operator=(const UringQueue&) = delete;
+
+    ~UringQueue() {
+        if (sqes_ != MAP_FAILED) munmap(sqes_, sqesBytes_);
+        if (cqRing_ != MAP_FAILED) munmap(cqRing_, cqRingBytes_);
+        if (sqRing_ != MAP_FAILED) munmap(sqRing_, sqRingBytes_);
+        if (ringFd_ >= 0) close(ringFd_);
+    }
+
+    bool Init(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ringFd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ringFd_ < 0) return false;
+
+        sqRingBytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingBytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        sqesBytes_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqRing_ = mmap(nullptr, sqRingBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+        cqRing_ = mmap(nullptr, cqRingBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_CQ_RING);
+        sqes_ = mmap(nullptr, sqesBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES);
+        if (sqRing_ == MAP_FAILED || cqRing_ == MAP_FAILED || sqes_ == MAP_FAILED) return false;
+
+        char* sq = static_cast<char*>(sqRing_);
+        sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqEntries_ = params.sq_entries;
+        char* cq = static_cast<char*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        return true;
+    }
+
+    // 只写入提交队列，由 Submit 统一通知内核；队列满时返回 false
+    bool PrepareRead(int fd, const iovec* vector, quint64 offset, quint64 userData) {
+        const unsigned tail = *sqTail_;
+        if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_) return false;
+        const unsigned index = tail & sqMask_;
+        io_uring_sqe& sqe = static_cast<io_uring_sqe*>(sqes_)[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<quint64>(vector);
+        sqe.len = 1;
+        sqe.off = offset;
+        sqe.user_data = userData;
+        sqArray_[index] = index;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+        ++pending_;
+        return true;
+    }
+
+    // 失败时已被内核接收的请求计入 InFlight，其余留在提交队列里不会执行
+    bool Submit(QString& errorMessage) {
+        while (pending_ > 0) {
+            const long submitted = syscall(__NR_io_uring_enter, ringFd_, pending_, 0, 0, nullptr, 0);
+            if (submitted < 0) {
+                if (errno == EINTR) continue;
+                errorMessage = ReadErrorMessage(errno);
+                return false;
+            }
+            pending_ -= static_cast<unsigned>(submitted);
+            inFlight_ += static_cast<unsigned>(submitted);
+        }
+        return true;
+    }
+
+    // 已提交给内核、还未收割完成事件的请求数
+    unsigned InFlight() const { return inFlight_; }
+
+    // 阻塞到至少一个已提交的请求完成
+    bool Wait(quint64& userData, int& result, QString& errorMessage) {
+        if (inFlight_ == 0) {
+            errorMessage = QStringLiteral("没有在途的读请求");
+            return false;
+        }
+        while (true) {
+            const unsigned head = *cqHead_;
+            if (head != __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+                const io_uring_cqe& cqe = cqes_[head & cqMask_];
+                userData = cqe.user_data;
+                result = cqe.res;
+                __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+                --inFlight_;
+                return true;
+            }
+            if (syscall(__NR_io_uring_enter, ringFd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+                errorMessage = ReadErrorMessage(errno);
+                return false;
+            }
+        }
+    }
+
+private:
+    int ringFd_ = -1;
+    void* sqRing_ = MAP_FAILED;
+    void* cqRing_ = MAP_FAILED;
+    void* sqes_ = MAP_FAILED;
+    size_t sqRingBytes_ = 0;
+    size_t cqRingBytes_ = 0;
+    size_t sqesBytes_ = 0;
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned sqEntries_ = 0;
+    unsigned pending_ = 0;   // 已写入提交队列、还未提交
+    unsigned inFlight_ = 0;  // 已提交、还未收割
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned cqMask_ = 0;
+};
+
+// 等待完成事件的系统调用出错时，隔这么久再查看完成队列
+constexpr std::chrono::milliseconds kUringDrainRetry{1};
+
+// io_uring 流水线：每个槽一个缓冲，按块号轮转；收到当前块前先处理其他槽的完成事件。
+// 返回前等所有已提交的请求完成，内核不会再写入已释放的缓冲。缓冲在队列之前声明，析构时先关闭队列再释放缓冲
+bool ReadWithUring(int fd,
+                   qint64 fileSize,
+                   const FileReadOptions& options,
+                   const ReadSink& sink,
+                   QString& errorMessage,
+                   bool& unavailable) {
+    const int depth = std::max(1, options.queueDepth);
+    std::vector<ReadSlot> readSlots(static_cast<size_t>(depth));
+    std::vector<iovec> vectors(static_cast<size_t>(depth));
+    UringQueue ring;
+    if (!ring.Init(static_cast<unsigned>(depth))) {
+        unavailable = true;
+        return false;
+    }
+
+    const qint64 blockCount = (fileSize + options.blockBytes - 1) / options.blockBytes;
+    const auto issue = [&](int index) {
+        ReadSlot& slot = readSlots[static_cast<size_t>(index)];
+        iovec& vector = vectors[static_cast<size_t>(index)];
+        vector.iov_base = slot.buffer.data() + slot.filled;
+        vector.iov_len = static_cast<size_t>(slot.length - slot.filled);
+        if (ring.PrepareRead(fd, &vector, static_cast<quint64>(slot.offset + slot.filled), static_cast<quint64>(index))) {
+            return true;
+        }
+        errorMessage = QStringLiteral("io_uring 提交队列已满");
+        return false;
+    };
+    // 出错返回前收割所有已提交的请求（只写入提交队列的请求内核不会执行）。
+    // 读普通文件的请求总会完成，等待的系统调用出错时稍后重试，完成事件照常写入完成队列
+    const auto drain = [&]() {
+        quint64 userData = 0;
+        int result = 0;
+        QString ignored;
+        while (ring.InFlight() > 0) {
+            if (!ring.Wait(userData, result, ignored)) std::this_thread::sleep_for(kUringDrainRetry);
+        }
+    };
+
+    qint64 next = 0;
+    for (int i = 0; i < depth && next < blockCount; ++i, ++next) {
+        readSlots[static_cast<size_t>(i)].buffer = QByteArray(options.blockBytes, Qt::Uninitialized);
+        StartSlot(readSlots[static_cast<size_t>(i)], next, options.blockBytes, fileSize);
+        if (!issue(i)) {
+            drain();
+            return false;
+        }
+    }
+    if (!ring.Submit(errorMessage)) {
+        drain();
+        return false;
+    }
+
+    for (qint64 block = 0; block < blockCount; ++block) {
+        const int index = static_cast<int>(block % depth);
+        ReadSlot& slot = readSlots[static_cast<size_t>(index)];
+        while (!slot.done) {
+            quint64 userData = 0;
+            int result = 0;
+            if (!ring.Wait(userData, result, errorMessage)) {
+                drain();
+                return false;
+            }
+            ReadSlot& completed = readSlots[static_cast<size_t>(userData)];
+            if (result <= 0) {
+                errorMessage = result < 0 ? ReadErrorMessage(-result) : QStringLiteral("数据文件读取中途结束，文件可能被截断");
+                drain();
+                return false;
+            }
+            completed.filled += result;
+            if (completed.filled < completed.length) {
+                if (!issue(static_cast<int>(userData)) || !ring.Submit(errorMessage)) {
+                    drain();
+                    return false;
+                }
+            } else {
+                completed.done = true;
+            }
+        }
+        if (!sink(slot.buffer.constData(), slot.length)) {
+            drain();
+            return false;
+        }
+        if (next < blockCount) {
+            StartSlot(slot, next++, options.blockBytes, fileSize);
+            if (!issue(index) || !ring.Submit(errorMessage)) {
+                drain();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+#endif
+
+#ifdef Q_OS_UNIX
+qint64 PreadFully(int fd, char* buffer, qint64 length, qint64 offset) {
+    qint64 done = 0;
+    while (done < length) {
+        const ssize_t got = pread(fd, buffer + done, static_cast<size_t>(length - done), static_cast<off_t>(offset + done));
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return -errno;
+        }
+        if (got == 0) break;
+        done += got;
+    }
+    return done;
+}
+
+// pread 线程流水线：每个槽一个 std::async 读任务，按块号顺序取结果
+bool ReadWithThreads(int fd, qint64 fileSize, const FileReadOptions& options, const ReadSink& sink, QString& errorMessage) {
+    const int depth = std::max(1, options.queueDepth);
+    const qint64 blockCount = (fileSize + options.blockBytes - 1) / options.blockBytes;
+    std::vector<ReadSlot> readSlots(static_cast<size_t>(depth));
+    // 声明在缓冲之后：提前返回时先析构（等待）读任务，再释放缓冲
+    std::vector<std::future<qint64>> reads(static_cast<size_t>(depth));
+    const auto launch = [&](int index, qint64 block) {
+        ReadSlot& slot = readSlots[static_cast<size_t>(index)];
+        StartSlot(slot, block, options.blockBytes, fileSize);
+        reads[static_cast<size_t>(index)] = std::async(std::launch::async, [fd, &slot]() {
+            return PreadFully(fd, slot.buffer.data(), slot.length, slot.offset);
+        });
+    };
+
+    qint64 next = 0;
+    for (int i = 0; i < depth && next < blockCount; ++i, ++next) {
+        readSlots[static_cast<size_t>(i)].buffer = QByteArray(options.blockBytes, Qt::Uninitialized);
+        launch(i, next);
+    }
+    for (qint64 block = 0; block < blockCount; ++block) {
+        const int index = static_cast<int>(block % depth);
+        ReadSlot& slot = readSlots[static_cast<size_t>(index)];
+        const qint64 got = reads[static_cast<size_t>(index)].get();
+        if (got != slot.length) {
+            errorMessage = got < 0 ? ReadErrorMessage(static_cast<int>(-got)) : QStringLiteral("数据文件读取中途结束，文件可能被截断");
+            return false;
+        }
+        if (!sink(slot.buffer.constData(), slot.length)) return false;
+        if (next < blockCount) launch(index, next++);
+    }
+    return true;
+}
+#endif
+
+}  // namespace
+
+QString ReadBackendName(ReadBackend backend) {
+    switch (backend) {
+    case ReadBackend::Buffered:
+        return QStringLiteral("buffered");
+    case ReadBackend::Async:
+        return QStringLiteral("async");
+    case ReadBackend::Mmap:
+        break;
+    }
+    return QStringLiteral("mmap");
+}
+
+bool ParseReadBackend(const QString& text, ReadBackend& outBackend) {
+    for (const ReadBackend backend : {ReadBackend::Mmap, ReadBackend::Buffered, ReadBackend::Async}) {
+        if (text.compare(ReadBackendName(backend), Qt::CaseInsensitive) == 0) {
+            outBackend = backend;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IsUringAvailable() {
+#ifdef PAT_HAS_URING
+    static const bool available = []() {
+        UringQueue probe;
+        return probe.Init(1);
+    }();
+    return available;
+#else
+    return false;
+#endif
+}
+
+bool ReadFileBlocks(const QString& path,
+                    ReadBackend backend,
+                    const ReadSink& sink,
+                    QString& errorMessage,
+                    const FileReadOptions& options) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorMessage = QStringLiteral("无法打开数据文件：%1").arg(path);
+        return false;
+    }
+    if (options.blockBytes <= 0) {
+        errorMessage = QStringLiteral("读取块大小非法");
+        return false;
+    }
+    const qint64 fileSize = file.size();
+    if (backend == ReadBackend::Mmap) return ReadMapped(file, fileSize, sink);
+    if (backend == ReadBackend::Buffered || fileSize <= 0) return ReadBuffered(file, options, sink, errorMessage);
+
+#ifdef Q_OS_UNIX
+    const int fd = file.handle();
+#ifdef Q_OS_LINUX
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+#ifdef PAT_HAS_URING
+    bool unavailable = false;
+    if (ReadWithUring(fd, fileSize, options, sink, errorMessage, unavailable)) return true;
+    if (!unavailable) return false;
+#endif
+    return ReadWithThreads(fd, fileSize, options, sink, errorMessage);
+#else
+    // 非 POSIX 平台没有 pread，退回同步分块读
+    return ReadBuffered(file, options, sink, errorMessage);
+#endif
+}
+
+}  // namespace pat
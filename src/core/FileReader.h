@@ -0,0 +1,32 @@
+﻿#pragma once
+
+#include <QString>
+
+#include <functional>
+
+namespace pat {
+
+// 数据文件的读取方式：Mmap 整文件映射；Buffered 同步分块读；
+// Async 预读流水线，Linux 上优先 io_uring，不可用时退回 pread 线程
+enum class ReadBackend { Mmap, Buffered, Async };
+
+QString ReadBackendName(ReadBackend backend);
+bool ParseReadBackend(const QString& text, ReadBackend& outBackend);
+// 运行期检测：内核未开放 io_uring（老内核、seccomp 限制）时返回 false
+bool IsUringAvailable();
+
+struct FileReadOptions {
+    qint64 blockBytes = 4ll * 1024 * 1024;
+    int queueDepth = 4;  // Async 时每个文件同时在途的读请求数
+};
+
+// 按文件顺序把读到的块交给 sink，sink 返回 false 时中止。
+// Async 时 sink 在调用线程上解码当前块，后续块的读取同时在途；块缓冲在 sink 返回后复用
+using ReadSink = std::function<bool(const char* data, qint64 size)>;
+bool ReadFileBlocks(const QString& path,
+                    ReadBackend backend,
+                    const ReadSink& sink,
+                    QString& errorMessage,
+                    const FileReadOptions& options = FileReadOptions());
+
+}  // namespace pat
@@ -6,6 +6,7 @@
 #include <QJsonObject>
 #include <QJsonParseError>
 
+#include <algorithm>
 #include <utility>
 
 namespace pat {
@@ -13,6 +14,7 @@ namespace {
 
 int TypeSize(const QString& type) {
     const auto t = type.toLower();
+    if (t == "int8" || t == "uint8") return 1;
     if (t == "int16" || t == "uint16") return 2;
     if (t == "int32" || t == "uint32" || t == "float32") return 4;
     if (t == "float64") return 8;
@@ -94,9 +96,155 @@ bool ParseSignal(const QJsonObject& obj,
     outSignal.unit = obj.value(QStringLiteral("unit")).toString();
     outSignal.description = obj.value(QStringLiteral("description")).toString();
     outSignal.groupPath = obj.value(QStringLiteral("group")).toString();
+
+    outSignal.recordStride = obj.value(QStringLiteral("record_stride")).toInt(1);
+    outSignal.recordPhase = obj.value(QStringLiteral("record_phase")).toInt(0);
+    if (outSignal.recordStride < 1 || outSignal.recordPhase < 0 || outSignal.recordPhase >= outSignal.recordStride) {
+        errorMessage = QStringLiteral("signal '%1' 的 record_stride/record_phase 非法").arg(outSignal.name);
+        return false;
+    }
+    const auto frameIdValue = obj.value(QStringLiteral("frame_id"));
+    outSignal.hasFrameId = frameIdValue.isDouble();
+    outSignal.frameId = outSignal.hasFrameId ? static_cast<qint64>(frameIdValue.toDouble()) : 0;
+    const QString precision = obj.value(QStringLiteral("precision")).toString();
+    outSignal.hasPrecision = !precision.isEmpty();
+    if (outSignal.hasPrecision && !ParseValuePrecision(precision, outSignal.precision)) {
+        errorMessage = QStringLiteral("signal '%1' 的 precision 不支持：%2（可选 auto / float32 / float64）").arg(outSignal.name, precision);
+        return false;
+    }
+    return true;
+}
+
+bool ParseTimestamp(const QJsonObject& obj,
+                    TimestampField& outTimestamp,
+                    int recordSize,
+                    double axisUnitSeconds,
+                    QString& errorMessage) {
+    outTimestamp.enabled = true;
+    outTimestamp.valueType = obj.value(QStringLiteral("value_type")).toString().toLower();
+    const int size = TypeSize(outTimestamp.valueType);
+    if (size == 0) {
+        errorMessage = QStringLiteral("timestamp 的 value_type 不支持：%1").arg(outTimestamp.valueType);
+        return false;
+    }
+
+    outTimestamp.byteOffset = obj.value(QStringLiteral("byte_offset")).toInt(-1);
+    if (outTimestamp.byteOffset < 0 || outTimestamp.byteOffset + size > recordSize) {
+        errorMessage = QStringLiteral("timestamp 的 byte_offset 缺失或超出 record_size 边界");
+        return false;
+    }
+
+    const double scale = obj.value(QStringLiteral("scale")).toDouble(1.0);
+    if (scale <= 0.0) {
+        errorMessage = QStringLiteral("timestamp 的 scale 必须 > 0");
+        return false;
+    }
+    double unitSeconds = axisUnitSeconds;
+    const QString unitRaw = obj.value(QStringLiteral("time_unit")).toString();
+    if (!unitRaw.trimmed().isEmpty()) {
+        QString normalizedLabel;
+        if (!NormalizeTimeUnit(unitRaw, normalizedLabel, unitSeconds)) {
+            errorMessage = QStringLiteral("timestamp 的 time_unit 不支持：%1").arg(unitRaw);
+            return false;
+        }
+    }
+    outTimestamp.scale = scale * unitSeconds / axisUnitSeconds;
+
+    outTimestamp.rollover = obj.value(QStringLiteral("rollover")).toDouble(0.0);
+    if (outTimestamp.rollover < 0.0) {
+        errorMessage = QStringLiteral("timestamp 的 rollover 不能为负");
+        return false;
+    }
+    return true;
+}
+
+bool ParseChecksum(const QJsonObject& obj, ChecksumField& outChecksum, int recordSize, QString& errorMessage) {
+    const QString algorithm = obj.value(QStringLiteral("algorithm")).toString();
+    if (!ResolveChecksumKind(algorithm, outChecksum.kind)) {
+        errorMessage = QStringLiteral("checksum 的 algorithm 不支持：%1").arg(algorithm);
+        return false;
+    }
+
+    outChecksum.byteOffset = obj.value(QStringLiteral("byte_offset")).toInt(-1);
+    if (outChecksum.byteOffset < 0 || outChecksum.byteOffset + ChecksumWidth(outChecksum.kind) > recordSize) {
+        errorMessage = QStringLiteral("checksum 的 byte_offset 缺失或超出 record_size 边界");
+        return false;
+    }
+
+    // 默认覆盖校验字段之前的全部字节
+    outChecksum.rangeOffset = obj.value(QStringLiteral("range_offset")).toInt(0);
+    outChecksum.rangeLength = obj.value(QStringLiteral("range_length")).toInt(outChecksum.byteOffset - outChecksum.rangeOffset);
+    if (outChecksum.rangeOffset < 0 || outChecksum.rangeLength <= 0 ||
+        outChecksum.rangeOffset + outChecksum.rangeLength > recordSize) {
+        errorMessage = QStringLiteral("checksum 的 range_offset/range_length 非法");
+        return false;
+    }
+    const int fieldEnd = outChecksum.byteOffset + ChecksumWidth(outChecksum.kind);
+    if (outChecksum.byteOffset < outChecksum.rangeOffset + outChecksum.rangeLength && fieldEnd > outChecksum.rangeOffset) {
+        errorMessage = QStringLiteral("checksum 的校验范围不能覆盖校验字段本身");
+        return false;
+    }
+    outChecksum.enabled = true;
+    return true;
+}
+
+bool ParseRecordTypes(const QJsonObject& obj, RecordTypeTable& outTable, QString& errorMessage) {
+    const auto idObj = obj.value(QStringLiteral("id_field")).toObject();
+    outTable.idValueType = idObj.value(QStringLiteral("value_type")).toString().toLower();
+    outTable.idOffset = idObj.value(QStringLiteral("byte_offset")).toInt(-1);
+    const int idSize = TypeSize(outTable.idValueType);
+    if (idSize == 0 || outTable.idValueType.startsWith(QStringLiteral("float")) || outTable.idOffset < 0) {
+        errorMessage = QStringLiteral("record_types.id_field 定义非法");
+        return false;
+    }
+
+    const auto typesArray = obj.value(QStringLiteral("types")).toArray();
+    if (typesArray.isEmpty()) {
+        errorMessage = QStringLiteral("record_types.types 为空");
+        return false;
+    }
+    outTable.types.clear();
+    for (const auto& typeValue : typesArray) {
+        const auto typeObj = typeValue.toObject();
+        RecordType type;
+        const auto idValue = typeObj.value(QStringLiteral("id"));
+        type.id = static_cast<qint64>(idValue.toDouble());
+        type.name = typeObj.value(QStringLiteral("name")).toString();
+        type.recordSize = typeObj.value(QStringLiteral("record_size")).toInt(0);
+        if (!idValue.isDouble() || type.recordSize <= 0) {
+            errorMessage = QStringLiteral("record_types.types 内元素需要 id 与 record_size");
+            return false;
+        }
+        if (outTable.idOffset + idSize > type.recordSize) {
+            errorMessage = QStringLiteral("记录类型 %1 的 record_size 容纳不下 id_field").arg(type.id);
+            return false;
+        }
+        for (const auto& existing : outTable.types) {
+            if (existing.id == type.id) {
+                errorMessage = QStringLiteral("记录类型 ID 重复：%1").arg(type.id);
+                return false;
+            }
+        }
+        outTable.types.push_back(std::move(type));
+    }
+    outTable.enabled = true;
     return true;
 }
 
+// record_type 可写类型名或类型 ID
+bool ResolveSignalRecordType(const QJsonValue& value, const RecordTypeTable& table, int& outIndex) {
+    for (int t = 0; t < static_cast<int>(table.types.size()); ++t) {
+        const RecordType& type = table.types[static_cast<size_t>(t)];
+        const bool match = value.isDouble() ? static_cast<qint64>(value.toDouble()) == type.id
+                                            : (!type.name.isEmpty() && value.toString() == type.name);
+        if (match) {
+            outIndex = t;
+            return true;
+        }
+    }
+    return false;
+}
+
 bool IsEndiannessSupported(const QString& endianness) {
     const auto e = endianness.toLower();
     return e == "little" || e == "big";
@@ -104,6 +252,34 @@ bool IsEndiannessSupported(const QString& endianness) {
 
 }  // namespace
 
+QString ValuePrecisionName(ValuePrecision precision) {
+    switch (precision) {
+    case ValuePrecision::Auto:
+        return QStringLiteral("auto");
+    case ValuePrecision::Float32:
+        return QStringLiteral("float32");
+    case ValuePrecision::Float64:
+        break;
+    }
+    return QStringLiteral("float64");
+}
+
+bool ParseValuePrecision(const QString& text, ValuePrecision& outPrecision) {
+    for (const ValuePrecision precision : {ValuePrecision::Float64, ValuePrecision::Auto, ValuePrecision::Float32}) {
+        if (text.compare(ValuePrecisionName(precision), Qt::CaseInsensitive) == 0) {
+            outPrecision = precision;
+            return true;
+        }
+    }
+    return false;
+}
+
+int RecordTypeTable::MinRecordSize() const {
+    int minSize = 0;
+    for (const auto& type : types) minSize = minSize == 0 ? type.recordSize : std::min(minSize, type.recordSize);
+    return minSize;
+}
+
 bool LoadFormatFromJson(const QString& path, FormatDefinition& outFormat, QString& errorMessage) {
     QFile file(path);
     if (!file.open(QIODevice::ReadOnly)) {
@@ -124,7 +300,18 @@ bool LoadFormatFromJsonData(const QByteArray& data, FormatDefinition& outFormat,
 
     const auto root = doc.object();
 
+    outFormat.recordTypes = RecordTypeTable();
+    const auto recordTypesValue = root.value(QStringLiteral("record_types"));
+    if (recordTypesValue.isObject()) {
+        if (!ParseRecordTypes(recordTypesValue.toObject(), outFormat.recordTypes, errorMessage)) return false;
+    }
+
     outFormat.recordSize = root.value(QStringLiteral("record_size")).toInt(0);
+    if (outFormat.recordTypes.enabled) {
+        // 多记录类型时 record_size 取各类型最大长度，信号越界按所属类型再检查
+        outFormat.recordSize = 0;
+        for (const auto& type : outFormat.recordTypes.types) outFormat.recordSize = std::max(outFormat.recordSize, type.recordSize);
+    }
     if (outFormat.recordSize <= 0) {
         errorMessage = QStringLiteral("record_size 缺失或非法");
         return false;
@@ -136,11 +323,77 @@ bool LoadFormatFromJsonData(const QByteArray& data, FormatDefinition& outFormat,
         return false;
     }
 
+    const QString compression = root.value(QStringLiteral("compression")).toString(QStringLiteral("auto")).toLower();
+    if (compression != QStringLiteral("auto") && compression != QStringLiteral("none")) {
+        errorMessage = QStringLiteral("compression 不支持：%1（可选 auto / none）").arg(compression);
+        return false;
+    }
+    outFormat.detectCompression = compression == QStringLiteral("auto");
+
     outFormat.timeAxisUnit = QStringLiteral("s");
     double axisUnitSeconds = 1.0;
     const QString axisUnitRaw = root.value(QStringLiteral("time_unit")).toString();
     NormalizeTimeUnit(axisUnitRaw, outFormat.timeAxisUnit, axisUnitSeconds);
 
+    outFormat.frameIdField = FrameIdField();
+    const auto frameIdValue = root.value(QStringLiteral("frame_id_field"));
+    if (frameIdValue.isObject()) {
+        const auto frameIdObj = frameIdValue.toObject();
+        outFormat.frameIdField.valueType = frameIdObj.value(QStringLiteral("value_type")).toString().toLower();
+        outFormat.frameIdField.byteOffset = frameIdObj.value(QStringLiteral("byte_offset")).toInt(-1);
+        const int size = TypeSize(outFormat.frameIdField.valueType);
+        const bool integral = !outFormat.frameIdField.valueType.startsWith(QStringLiteral("float"));
+        if (size == 0 || !integral || outFormat.frameIdField.byteOffset < 0 ||
+            outFormat.frameIdField.byteOffset + size > outFormat.recordSize) {
+            errorMessage = QStringLiteral("frame_id_field 定义非法");
+            return false;
+        }
+        outFormat.frameIdField.enabled = true;
+    }
+
+    outFormat.syncWord = SyncWordField();
+    const auto syncValue = root.value(QStringLiteral("sync_word"));
+    if (syncValue.isObject()) {
+        const auto syncObj = syncValue.toObject();
+        const QString hex = syncObj.value(QStringLiteral("pattern")).toString().remove(QChar(' '));
+        outFormat.syncWord.pattern = QByteArray::fromHex(hex.toLatin1());
+        outFormat.syncWord.byteOffset = syncObj.value(QStringLiteral("byte_offset")).toInt(0);
+        if (outFormat.syncWord.pattern.isEmpty() || outFormat.syncWord.pattern.size() * 2 != hex.size()) {
+            errorMessage = QStringLiteral("sync_word.pattern 应为十六进制字节串");
+            return false;
+        }
+        if (outFormat.syncWord.byteOffset < 0 ||
+            outFormat.syncWord.byteOffset + outFormat.syncWord.pattern.size() > outFormat.recordSize) {
+            errorMessage = QStringLiteral("sync_word 超出 record_size 边界");
+            return false;
+        }
+        outFormat.syncWord.enabled = true;
+    }
+
+    outFormat.checksum = ChecksumField();
+    const auto checksumValue = root.value(QStringLiteral("checksum"));
+    if (checksumValue.isObject()) {
+        if (!ParseChecksum(checksumValue.toObject(), outFormat.checksum, outFormat.recordSize, errorMessage)) {
+            return false;
+        }
+    }
+
+    outFormat.timestamp = TimestampField();
+    const auto timestampValue = root.value(QStringLiteral("timestamp"));
+    if (timestampValue.isObject()) {
+        // 多记录类型时时间戳位于公共记录头，需落在最短的类型内
+        const int timestampBound = outFormat.recordTypes.enabled ? outFormat.recordTypes.MinRecordSize() : outFormat.recordSize;
+        if (!ParseTimestamp(timestampValue.toObject(), outFormat.timestamp, timestampBound, axisUnitSeconds, errorMessage)) {
+            return false;
+        }
+    }
+
+    if (outFormat.recordTypes.enabled &&
+        (outFormat.frameIdField.enabled || outFormat.syncWord.enabled || outFormat.checksum.enabled)) {
+        errorMessage = QStringLiteral("record_types 暂不支持与 frame_id_field/sync_word/checksum 同时使用");
+        return false;
+    }
+
     const auto signalsValue = root.value(QStringLiteral("signals"));
     if (!signalsValue.isArray()) {
         errorMessage = QStringLiteral("signals 应为数组");
@@ -169,6 +422,22 @@ bool LoadFormatFromJsonData(const QByteArray& data, FormatDefinition& outFormat,
                          errorMessage)) {
             return false;
         }
+        if (sig.hasFrameId && !outFormat.frameIdField.enabled) {
+            errorMessage = QStringLiteral("signal '%1' 指定了 frame_id，但格式未定义 frame_id_field").arg(sig.name);
+            return false;
+        }
+        if (outFormat.recordTypes.enabled) {
+            const auto recordTypeValue = sigVal.toObject().value(QStringLiteral("record_type"));
+            if (!ResolveSignalRecordType(recordTypeValue, outFormat.recordTypes, sig.recordType)) {
+                errorMessage = QStringLiteral("signal '%1' 的 record_type 缺失或未定义").arg(sig.name);
+                return false;
+            }
+            const RecordType& type = outFormat.recordTypes.types[static_cast<size_t>(sig.recordType)];
+            if (sig.byteOffset + TypeSize(sig.valueType) > type.recordSize) {
+                errorMessage = QStringLiteral("signal '%1' 超出记录类型 %2 的长度").arg(sig.name).arg(type.id);
+                return false;
+            }
+        }
         outFormat.signalFormats.push_back(std::move(sig));
     }
 
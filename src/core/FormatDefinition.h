@@ -1,5 +1,7 @@
 ﻿#pragma once
 
+#include "core/Checksum.h"
+
 #include <QByteArray>
 #include <QHash>
 #include <QString>
@@ -7,10 +9,17 @@
 
 namespace pat {
 
+// 解码后样本的存储精度：Float64 为双精度；Float32 为单精度，内存与扫描带宽减半；
+// Auto 按 value_type 与 scale 判断单精度是否足够（float32 来源、换算后不损失量化精度的 8/16 位整数）
+enum class ValuePrecision { Float64, Auto, Float32 };
+
+QString ValuePrecisionName(ValuePrecision precision);
+bool ParseValuePrecision(const QString& text, ValuePrecision& outPrecision);
+
 struct SignalFormat {
     QString name;
     int byteOffset = 0;
-    QString valueType;  // int16, uint16, int32, uint32, float32, float64
+    QString valueType;  // int8, uint8, int16, uint16, int32, uint32, float32, float64
     double scale = 1.0;
     double bias = 0.0;
     double timeScale = 1.0;
@@ -18,6 +27,63 @@ struct SignalFormat {
     QString unit;
     QString description;
     QString groupPath;
+    // 子换向：每 recordStride 条记录出现一次，首次出现在第 recordPhase 条；
+    // hasFrameId 时只在帧 ID 等于 frameId 的记录中取样，stride/phase 作用于这些记录
+    int recordStride = 1;
+    int recordPhase = 0;
+    bool hasFrameId = false;
+    qint64 frameId = 0;
+    int recordType = -1;  // 多记录类型格式中所属类型在 RecordTypeTable::types 中的下标，偏移相对该类型记录起点
+    bool hasPrecision = false;  // 未指定时按会话的精度策略
+    ValuePrecision precision = ValuePrecision::Float64;
+};
+
+// 记录内的帧 ID（小帧号）字段，整数类型
+struct FrameIdField {
+    bool enabled = false;
+    int byteOffset = 0;
+    QString valueType;
+};
+
+// 记录内的时间戳计数器，启用后替代 记录序号 × time_scale 的合成时间轴
+struct TimestampField {
+    bool enabled = false;
+    int byteOffset = 0;
+    QString valueType;
+    double scale = 1.0;     // 每个计数对应的时间，已换算到格式时间轴单位
+    double rollover = 0.0;  // 计数器回绕模数（原始计数），0 表示不回绕
+};
+
+// 每条记录 byteOffset 处的固定同步字，用于在损坏的文件中重新定位记录
+struct SyncWordField {
+    bool enabled = false;
+    QByteArray pattern;
+    int byteOffset = 0;
+};
+
+// 记录内的校验字段：对 [rangeOffset, rangeOffset + rangeLength) 计算校验，与 byteOffset 处的小端存储值比对
+struct ChecksumField {
+    bool enabled = false;
+    ChecksumKind kind = ChecksumKind::Crc32;
+    int rangeOffset = 0;
+    int rangeLength = 0;
+    int byteOffset = 0;
+};
+
+// 一个文件内交错多种报文：每条记录起点 idOffset 处的整数 ID 决定其类型与长度
+struct RecordType {
+    qint64 id = 0;
+    QString name;
+    int recordSize = 0;
+};
+
+struct RecordTypeTable {
+    bool enabled = false;
+    int idOffset = 0;
+    QString idValueType;
+    std::vector<RecordType> types;
+
+    int MinRecordSize() const;
 };
 
 struct FormatDefinition {
@@ -26,6 +92,13 @@ struct FormatDefinition {
     std::vector<SignalFormat> signalFormats;
     QHash<QString, QString> groupDescriptions;
     QString timeAxisUnit = QStringLiteral("s");
+    TimestampField timestamp;
+    FrameIdField frameIdField;
+    SyncWordField syncWord;
+    ChecksumField checksum;
+    RecordTypeTable recordTypes;  // 启用时 recordSize 为各类型中的最大长度
+    // compression: "auto" 按文件头识别 gzip/zstd；"none" 一律按原始记录解析（首条记录恰好像压缩文件头时使用）
+    bool detectCompression = true;
 };
 
 bool LoadFormatFromJson(const QString& path, FormatDefinition& outFormat, QString& errorMessage);
@@ -0,0 +1,143 @@
+﻿#include "core/MemoryGovernor.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+
+namespace pat {
+
+qint64 SessionMemoryUsage::ValueBytes() const {
+    qint64 bytes = 0;
+    for (const auto& usage : signalUsage) bytes += usage.valueBytes;
+    return bytes;
+}
+
+qint64 SessionMemoryUsage::TimeBytes() const {
+    qint64 bytes = 0;
+    for (const auto& usage : signalUsage) bytes += usage.timeBytes;
+    return bytes;
+}
+
+qint64 SessionMemoryUsage::IndexBytes() const {
+    qint64 bytes = 0;
+    for (const auto& usage : signalUsage) bytes += usage.indexBytes;
+    return bytes;
+}
+
+qint64 SessionMemoryUsage::ValidityBytes() const {
+    qint64 bytes = 0;
+    for (const auto& usage : signalUsage) bytes += usage.validityBytes;
+    return bytes;
+}
+
+qint64 SessionMemoryUsage::ChunkBytes() const {
+    qint64 bytes = 0;
+    for (const auto& usage : signalUsage) bytes += usage.chunkBytes;
+    return bytes;
+}
+
+qint64 SessionMemoryUsage::TotalBytes() const {
+    qint64 bytes = statisticsBytes;
+    for (const auto& usage : signalUsage) bytes += usage.TotalBytes();
+    return bytes;
+}
+
+MemoryGovernor& MemoryGovernor::Instance() {
+    static MemoryGovernor governor;
+    return governor;
+}
+
+void MemoryGovernor::SetBudget(qint64 bytes) {
+    QMutexLocker locker(&mutex_);
+    budget_ = std::max<qint64>(0, bytes);
+}
+
+qint64 MemoryGovernor::Budget() const {
+    QMutexLocker locker(&mutex_);
+    return budget_;
+}
+
+std::shared_ptr<MemoryGovernor::Account> MemoryGovernor::Register() {
+    auto account = std::make_shared<Account>();
+    QMutexLocker locker(&mutex_);
+    accounts_.append(account);
+    return account;
+}
+
+qint64 MemoryGovernor::Admit(const std::shared_ptr<Account>& account, qint64 estimatedBytes) {
+    QMutexLocker locker(&mutex_);
+    // 本会话的旧数据在加载完成后才被替换，这里按替换后估计，只与其他会话的占用比较
+    account->reservedBytes = 0;
+    if (budget_ <= 0) {
+        account->reservedBytes = estimatedBytes;
+        return 0;
+    }
+    qint64 available = budget_ - OthersBytes(account.get());
+    if (estimatedBytes > available) {
+        // 先收回其他会话的外存块缓存：这些块已在（或可写入）临时文件中，随时可以换回
+        for (const auto& weak : accounts_) {
+            const auto other = weak.lock();
+            if (!other || other == account) continue;
+            if (const auto store = other->store.lock()) store->SetMemoryBudget(kMinChunkCacheBytes);
+        }
+        available = budget_ - OthersBytes(account.get());
+    }
+    if (estimatedBytes <= available) {
+        account->reservedBytes = estimatedBytes;
+        return 0;
+    }
+    const qint64 grant = std::max(available, kMinChunkCacheBytes);
+    account->reservedBytes = grant;
+    return grant;
+}
+
+void MemoryGovernor::Update(const std::shared_ptr<Account>& account,
+                            const QString& label,
+                            qint64 residentBytes,
+                            const std::shared_ptr<ChunkStore>& store) {
+    QMutexLocker locker(&mutex_);
+    account->label = label;
+    account->residentBytes = residentBytes;
+    account->reservedBytes = 0;
+    account->store = store;
+}
+
+qint64 MemoryGovernor::TotalBytes() const {
+    QMutexLocker locker(&mutex_);
+    qint64 bytes = 0;
+    for (const auto& weak : accounts_) {
+        if (const auto account = weak.lock()) bytes += AccountBytes(*account);
+    }
+    return bytes;
+}
+
+QVector<MemoryGovernor::AccountUsage> MemoryGovernor::Accounts() const {
+    QMutexLocker locker(&mutex_);
+    QVector<AccountUsage> usage;
+    for (const auto& weak : accounts_) {
+        if (const auto account = weak.lock()) usage.append(AccountUsage{account->label, AccountBytes(*account)});
+    }
+    return usage;
+}
+
+qint64 MemoryGovernor::AccountBytes(const Account& account) const {
+    qint64 bytes = account.residentBytes + account.reservedBytes;
+    if (const auto store = account.store.lock()) bytes += store->Stats().residentBytes;
+    return bytes;
+}
+
+// 顺带清理已注销的账户
+qint64 MemoryGovernor::OthersBytes(const Account* self) {
+    qint64 bytes = 0;
+    for (qsizetype i = accounts_.size() - 1; i >= 0; --i) {
+        const auto account = accounts_[i].lock();
+        if (!account) {
+            accounts_.removeAt(i);
+            continue;
+        }
+        if (account.get() != self) bytes += AccountBytes(*account);
+    }
+    return bytes;
+}
+
+}  // namespace pat
@@ -0,0 +1,88 @@
+﻿#pragma once
+
+#include "core/ChunkStore.h"
+
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+namespace pat {
+
+// 一个信号占用的常驻内存，按类别分开；共享的时间轴只计入第一个使用它的信号
+struct SignalMemoryUsage {
+    QString name;
+    QString storage;           // double / float32 / packed / runs / chunked
+    qint64 valueBytes = 0;     // 内存中的数值列（含压缩列、游程列）
+    qint64 timeBytes = 0;      // 显式时间轴
+    qint64 indexBytes = 0;     // 稀疏时间索引（可由时间轴重建）
+    qint64 validityBytes = 0;  // 有效位图
+    qint64 chunkBytes = 0;     // 外存模式下该信号当前换入的块（可从临时文件换回）
+
+    qint64 TotalBytes() const { return valueBytes + timeBytes + indexBytes + validityBytes + chunkBytes; }
+};
+
+struct SessionMemoryUsage {
+    QVector<SignalMemoryUsage> signalUsage;
+    qint64 statisticsBytes = 0;
+    qint64 spilledBytes = 0;  // 外存临时文件，位于磁盘，不计入常驻
+    qint64 chunkBudget = 0;   // 外存模式的块缓存上限，0 表示未启用
+
+    qint64 ValueBytes() const;
+    qint64 TimeBytes() const;
+    qint64 IndexBytes() const;
+    qint64 ValidityBytes() const;
+    qint64 ChunkBytes() const;
+    qint64 TotalBytes() const;
+};
+
+// 进程内所有会话的内存上限。会话各持有一个账户，账户随会话销毁而注销。
+// 加载前按估计的解码大小申请额度：超出上限时先收回其他会话可再取回的数据（外存块缓存，优先丢已落盘的映射块），
+// 仍不够时给出剩余额度，由会话改用外存模式在该额度内解码，而不是把整份结果放进内存
+class MemoryGovernor {
+public:
+    struct Account {
+        QString label;
+        qint64 residentBytes = 0;  // 不含块缓存的常驻字节
+        qint64 reservedBytes = 0;  // 加载中按估计预留的额度
+        std::weak_ptr<ChunkStore> store;
+    };
+
+    struct AccountUsage {
+        QString label;
+        qint64 bytes = 0;
+    };
+
+    // 外存块缓存至少保留的字节，避免收回后频繁换入换出
+    static constexpr qint64 kMinChunkCacheBytes = 16ll * 1024 * 1024;
+
+    static MemoryGovernor& Instance();
+
+    // 0 表示不限
+    void SetBudget(qint64 bytes);
+    qint64 Budget() const;
+
+    std::shared_ptr<Account> Register();
+    // 申请 estimatedBytes：可以放下时预留并返回 0；否则返回会话应使用的外存块缓存上限
+    qint64 Admit(const std::shared_ptr<Account>& account, qint64 estimatedBytes);
+    // 加载完成或清空后登记实际占用，并释放预留
+    void Update(const std::shared_ptr<Account>& account,
+                const QString& label,
+                qint64 residentBytes,
+                const std::shared_ptr<ChunkStore>& store);
+    // 所有账户的常驻字节（含块缓存与预留）
+    qint64 TotalBytes() const;
+    QVector<AccountUsage> Accounts() const;
+
+private:
+    MemoryGovernor() = default;
+    qint64 AccountBytes(const Account& account) const;
+    qint64 OthersBytes(const Account* self);
+
+    mutable QMutex mutex_;
+    qint64 budget_ = 0;
+    QVector<std::weak_ptr<Account>> accounts_;
+};
+
+}  // namespace pat
@@ -0,0 +1,166 @@
+﻿#include "core/PackedColumn.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <utility>
+
+namespace pat {
+namespace {
+
+// 超出此范围的原始值在 double 中已无法精确表示整数，也不可能来自 32 位以内的字段
+constexpr double kMaxRaw = 9007199254740992.0;  // 2^53
+
+// 按位宽从打包数组中取第 k 个值；width 为 1..64，跨字时拼接相邻两字
+inline quint64 Unpack(const quint64* words, qint64 bit, int width) {
+    const qint64 word = bit >> 6;
+    const int shift = static_cast<int>(bit & 63);
+    quint64 value = words[word] >> shift;
+    if (shift + width > 64) value |= words[word + 1] << (64 - shift);
+    return width == 64 ? value : (value & ((quint64{1} << width) - 1));
+}
+
+// 64 个值恰好占 Width 个字，位宽为编译期常量时循环完全展开，移位量全部是常数
+template <int Width>
+void UnpackGroup(const quint64* words, qint64* out) {
+    constexpr quint64 kMask = Width == 64 ? ~quint64{0} : ((quint64{1} << Width) - 1);
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC unroll 64
+#endif
+    for (int k = 0; k < 64; ++k) {
+        const int bit = k * Width;
+        const int word = bit >> 6;
+        const int shift = bit & 63;
+        quint64 value = words[word] >> shift;
+        if (shift + Width > 64) value |= words[word + 1] << (64 - shift);
+        out[k] = static_cast<qint64>(value & kMask);
+    }
+}
+
+using UnpackGroupFn = void (*)(const quint64*, qint64*);
+
+template <size_t... Widths>
+constexpr std::array<UnpackGroupFn, sizeof...(Widths)> MakeUnpackTable(std::index_sequence<Widths...>) {
+    return {{&UnpackGroup<static_cast<int>(Widths) + 1>...}};
+}
+
+// 下标为位宽 - 1
+constexpr auto kUnpackGroup = MakeUnpackTable(std::make_index_sequence<64>());
+
+}  // namespace
+
+bool PackedColumn::Encode(const QVector<double>& values, double scale, double bias, PackedColumn& out) {
+    out = PackedColumn();
+    if (scale == 0.0 || !std::isfinite(scale) || !std::isfinite(bias)) return false;
+    out.size_ = values.size();
+    out.scale_ = scale;
+    out.bias_ = bias;
+
+    std::vector<qint64> raw(static_cast<size_t>(kBlockSamples));
+    std::vector<quint64> residual(static_cast<size_t>(kBlockSamples));
+    for (qsizetype begin = 0; begin < values.size(); begin += kBlockSamples) {
+        const qsizetype count = std::min(kBlockSamples, values.size() - begin);
+        Block block;
+        for (qsizetype k = 0; k < count; ++k) {
+            const double value = values[begin + k];
+            const double estimate = std::round((value - bias) / scale);
+            if (!(std::abs(estimate) < kMaxRaw)) return false;
+            raw[static_cast<size_t>(k)] = static_cast<qint64>(estimate);
+            // 只接受逐位还原一致的样本，解码结果与解析结果完全相同
+            if (out.Reconstruct(raw[static_cast<size_t>(k)]) != value) return false;
+        }
+        block.base = raw[0];
+        block.minRaw = block.maxRaw = raw[0];
+        qint64 minDelta = 0;
+        qint64 maxDelta = 0;
+        for (qsizetype k = 1; k < count; ++k) {
+            const qint64 delta = raw[static_cast<size_t>(k)] - raw[static_cast<size_t>(k - 1)];
+            if (k == 1 || delta < minDelta) minDelta = delta;
+            if (k == 1 || delta > maxDelta) maxDelta = delta;
+            block.minRaw = std::min(block.minRaw, raw[static_cast<size_t>(k)]);
+            block.maxRaw = std::max(block.maxRaw, raw[static_cast<size_t>(k)]);
+        }
+        block.minDelta = minDelta;
+        const quint64 span = static_cast<quint64>(maxDelta - minDelta);
+        block.bitWidth = span == 0 ? 0 : static_cast<int>(std::bit_width(span));
+        block.wordOffset = static_cast<qint64>(out.words_.size());
+        if (block.bitWidth > 0) {
+            const qint64 bits = static_cast<qint64>(count - 1) * block.bitWidth;
+            out.words_.resize(out.words_.size() + static_cast<size_t>((bits + 63) / 64), 0);
+            quint64* words = out.words_.data() + block.wordOffset;
+            for (qsizetype k = 1; k < count; ++k) {
+                const quint64 u = static_cast<quint64>(raw[static_cast<size_t>(k)] - raw[static_cast<size_t>(k - 1)] - minDelta);
+                const qint64 bit = static_cast<qint64>(k - 1) * block.bitWidth;
+                const qint64 word = bit >> 6;
+                const int shift = static_cast<int>(bit & 63);
+                words[word] |= u << shift;
+                if (shift + block.bitWidth > 64) words[word + 1] |= u >> (64 - shift);
+            }
+        }
+        out.blocks_.push_back(block);
+    }
+    // 解码末尾时可能多读一个字
+    out.words_.push_back(0);
+    out.words_.shrink_to_fit();
+    out.blocks_.shrink_to_fit();
+    return true;
+}
+
+qint64 PackedColumn::ByteSize() const {
+    return static_cast<qint64>(blocks_.size() * sizeof(Block) + words_.size() * sizeof(quint64));
+}
+
+qsizetype PackedColumn::BlockLength(qsizetype block) const {
+    return std::min(kBlockSamples, size_ - block * kBlockSamples);
+}
+
+double PackedColumn::BlockMin(qsizetype block) const {
+    const Block& b = blocks_[static_cast<size_t>(block)];
+    return scale_ > 0.0 ? Reconstruct(b.minRaw) : Reconstruct(b.maxRaw);
+}
+
+double PackedColumn::BlockMax(qsizetype block) const {
+    const Block& b = blocks_[static_cast<size_t>(block)];
+    return scale_ > 0.0 ? Reconstruct(b.maxRaw) : Reconstruct(b.minRaw);
+}
+
+// 三趟独立的简单循环：解包、前缀和、换算；位宽固定的解包与换算都可被编译器向量化
+void PackedColumn::DecodeBlock(qsizetype block, double* out) const {
+    const Block& b = blocks_[static_cast<size_t>(block)];
+    const qsizetype count = BlockLength(block);
+    if (b.bitWidth == 0) {
+        for (qsizetype k = 0; k < count; ++k) out[k] = Reconstruct(b.base + b.minDelta * k);
+        return;
+    }
+    // raw[k + 1] 为第 k 个打包余量；整组 64 个按编译期位宽解包，末尾不足一组的逐个取
+    qint64 raw[kBlockSamples + 64];
+    const quint64* words = words_.data() + b.wordOffset;
+    const qsizetype deltas = count - 1;
+    const qsizetype groups = deltas / 64;
+    const UnpackGroupFn unpack = kUnpackGroup[static_cast<size_t>(b.bitWidth - 1)];
+    for (qsizetype g = 0; g < groups; ++g) unpack(words + g * b.bitWidth, raw + 1 + g * 64);
+    for (qsizetype k = groups * 64; k < deltas; ++k) {
+        raw[k + 1] = static_cast<qint64>(Unpack(words, static_cast<qint64>(k) * b.bitWidth, b.bitWidth));
+    }
+    raw[0] = b.base;
+    for (qsizetype k = 1; k < count; ++k) raw[k] += raw[k - 1] + b.minDelta;
+    for (qsizetype k = 0; k < count; ++k) out[k] = Reconstruct(raw[k]);
+}
+
+double PackedColumn::At(qsizetype index) const {
+    const qsizetype block = index / kBlockSamples;
+    const Block& b = blocks_[static_cast<size_t>(block)];
+    const qsizetype offset = index - block * kBlockSamples;
+    if (b.minRaw == b.maxRaw) return Reconstruct(b.base);
+    qint64 raw = b.base + b.minDelta * offset;
+    if (b.bitWidth > 0) {
+        const quint64* words = words_.data() + b.wordOffset;
+        for (qsizetype k = 1; k <= offset; ++k) {
+            raw += static_cast<qint64>(Unpack(words, static_cast<qint64>(k - 1) * b.bitWidth, b.bitWidth));
+        }
+    }
+    return Reconstruct(raw);
+}
+
+}  // namespace pat
@@ -0,0 +1,50 @@
+﻿#pragma once
+
+#include <QVector>
+
+#include <vector>
+
+namespace pat {
+
+// 整数来源信号的压缩列：每 kBlockSamples 个样本一块，块内先差分，再以块内最小差分为帧参考，
+// 余量按块内最大位宽紧密打包。块头记录首值与最小/最大原始值，常量块与等差块（计数器）位宽为 0，不占数据字。
+// 样本值为 raw × scale + bias，与解析时的换算一致
+class PackedColumn {
+public:
+    static constexpr qsizetype kBlockSamples = 1024;
+
+    // 能把 values 无损还原为整数时编码并返回 true；存在非整数样本或溢出时返回 false
+    static bool Encode(const QVector<double>& values, double scale, double bias, PackedColumn& out);
+
+    qsizetype Size() const { return size_; }
+    qint64 ByteSize() const;
+    qsizetype BlockCount() const { return static_cast<qsizetype>(blocks_.size()); }
+    qsizetype BlockLength(qsizetype block) const;
+    // 块内最小/最大值（已换算），不需要解码
+    double BlockMin(qsizetype block) const;
+    double BlockMax(qsizetype block) const;
+
+    // 解码整块到 out（至少 BlockLength(block) 个元素）
+    void DecodeBlock(qsizetype block, double* out) const;
+    double At(qsizetype index) const;
+
+private:
+    struct Block {
+        qint64 base = 0;      // 块首原始值
+        qint64 minDelta = 0;  // 帧参考，打包的是 delta - minDelta
+        qint64 minRaw = 0;
+        qint64 maxRaw = 0;
+        qint64 wordOffset = 0;
+        int bitWidth = 0;
+    };
+
+    double Reconstruct(qint64 raw) const { return static_cast<double>(raw) * scale_ + bias_; }
+
+    qsizetype size_ = 0;
+    double scale_ = 1.0;
+    double bias_ = 0.0;
+    std::vector<Block> blocks_;
+    std::vector<quint64> words_;
+};
+
+}  // namespace pat
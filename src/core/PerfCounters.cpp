@@ -0,0 +1,78 @@
+﻿#include "core/PerfCounters.h"
+
+#include "core/Trace.h"
+
+namespace pat {
+
+double PerfSnapshot::LoadMegabytesPerSecond() const {
+    return loadNs > 0 ? static_cast<double>(loadBytes) / (1024.0 * 1024.0) / (static_cast<double>(loadNs) * 1e-9) : 0.0;
+}
+
+double PerfSnapshot::LoadRecordsPerSecond() const {
+    return loadNs > 0 ? static_cast<double>(loadRecords) / (static_cast<double>(loadNs) * 1e-9) : 0.0;
+}
+
+double PerfSnapshot::ChunkHitRate() const {
+    return chunkPins > 0 ? static_cast<double>(chunkHits) / static_cast<double>(chunkPins) : -1.0;
+}
+
+PerfCounters& PerfCounters::Instance() {
+    static PerfCounters counters;
+    return counters;
+}
+
+void PerfCounters::RecordLoad(qint64 bytes, qint64 records, qint64 ns) {
+    loadBytes_.store(bytes, std::memory_order_relaxed);
+    loadRecords_.store(records, std::memory_order_relaxed);
+    loadNs_.store(ns, std::memory_order_relaxed);
+}
+
+void PerfCounters::BeginFrame(int pendingPaints) {
+    frameStartNs_.store(TraceRecorder::NowNs(), std::memory_order_relaxed);
+    decimateNs_.store(0, std::memory_order_relaxed);
+    decimatedPoints_.store(0, std::memory_order_relaxed);
+    uploadNs_.store(0, std::memory_order_relaxed);
+    renderNs_.store(0, std::memory_order_relaxed);
+    frameNs_.store(-1, std::memory_order_relaxed);
+    pendingPaints_.store(pendingPaints, std::memory_order_relaxed);
+}
+
+void PerfCounters::RecordDecimation(qint64 ns, qint64 points) {
+    decimateNs_.fetch_add(ns, std::memory_order_relaxed);
+    decimatedPoints_.fetch_add(points, std::memory_order_relaxed);
+}
+
+void PerfCounters::RecordUpload(qint64 ns) {
+    uploadNs_.fetch_add(ns, std::memory_order_relaxed);
+}
+
+// 帧结束后的重绘（游标移动、窗口遮挡）不再计入
+void PerfCounters::RecordPaint(qint64 ns) {
+    if (pendingPaints_.load(std::memory_order_relaxed) <= 0) return;
+    renderNs_.fetch_add(ns, std::memory_order_relaxed);
+    if (pendingPaints_.fetch_sub(1, std::memory_order_relaxed) == 1) {
+        frameNs_.store(TraceRecorder::NowNs() - frameStartNs_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+void PerfCounters::CountChunkPin(bool hit) {
+    chunkPins_.fetch_add(1, std::memory_order_relaxed);
+    if (hit) chunkHits_.fetch_add(1, std::memory_order_relaxed);
+}
+
+PerfSnapshot PerfCounters::Snapshot() const {
+    PerfSnapshot snapshot;
+    snapshot.loadBytes = loadBytes_.load(std::memory_order_relaxed);
+    snapshot.loadRecords = loadRecords_.load(std::memory_order_relaxed);
+    snapshot.loadNs = loadNs_.load(std::memory_order_relaxed);
+    snapshot.decimateNs = decimateNs_.load(std::memory_order_relaxed);
+    snapshot.decimatedPoints = decimatedPoints_.load(std::memory_order_relaxed);
+    snapshot.uploadNs = uploadNs_.load(std::memory_order_relaxed);
+    snapshot.renderNs = renderNs_.load(std::memory_order_relaxed);
+    snapshot.frameNs = frameNs_.load(std::memory_order_relaxed);
+    snapshot.chunkPins = chunkPins_.load(std::memory_order_relaxed);
+    snapshot.chunkHits = chunkHits_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+}  // namespace pat
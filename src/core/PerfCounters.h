@@ -0,0 +1,65 @@
+﻿#pragma once
+
+#include <QtGlobal>
+
+#include <atomic>
+
+namespace pat {
+
+// 某一时刻的计数快照；各字段分别原子读取，彼此之间不保证是同一时刻的值
+struct PerfSnapshot {
+    // 最近一次加载
+    qint64 loadBytes = 0;
+    qint64 loadRecords = 0;
+    qint64 loadNs = 0;
+    // 最近一次缩放/平移
+    qint64 decimateNs = 0;
+    qint64 decimatedPoints = 0;  // 交给图表的点数
+    qint64 uploadNs = 0;         // QLineSeries::replace
+    qint64 renderNs = 0;         // 本帧各图表重绘耗时之和
+    qint64 frameNs = -1;         // 从开始抽稀到最后一个可见图表绘完，未绘完时为 -1
+    // 外存块缓存
+    qint64 chunkPins = 0;
+    qint64 chunkHits = 0;
+
+    double LoadMegabytesPerSecond() const;
+    double LoadRecordsPerSecond() const;
+    double ChunkHitRate() const;  // 没有访问时为 -1
+};
+
+// 供界面低频显示的性能计数。写入方在各自线程上原子更新，读取不加锁
+class PerfCounters {
+public:
+    static PerfCounters& Instance();
+
+    void RecordLoad(qint64 bytes, qint64 records, qint64 ns);
+
+    // 一帧：抽稀与点集上传在界面线程同步完成，绘制发生在随后的重绘中。
+    // pendingPaints 为要等待重绘的可见图表数，每个图表绘完调用一次 RecordPaint
+    void BeginFrame(int pendingPaints);
+    void RecordDecimation(qint64 ns, qint64 points);
+    void RecordUpload(qint64 ns);
+    void RecordPaint(qint64 ns);
+
+    void CountChunkPin(bool hit);
+
+    PerfSnapshot Snapshot() const;
+
+private:
+    PerfCounters() = default;
+
+    std::atomic<qint64> loadBytes_{0};
+    std::atomic<qint64> loadRecords_{0};
+    std::atomic<qint64> loadNs_{0};
+    std::atomic<qint64> frameStartNs_{0};
+    std::atomic<int> pendingPaints_{0};
+    std::atomic<qint64> decimateNs_{0};
+    std::atomic<qint64> decimatedPoints_{0};
+    std::atomic<qint64> uploadNs_{0};
+    std::atomic<qint64> renderNs_{0};
+    std::atomic<qint64> frameNs_{-1};
+    std::atomic<qint64> chunkPins_{0};
+    std::atomic<qint64> chunkHits_{0};
+};
+
+}  // namespace pat
@@ -0,0 +1,90 @@
+﻿#include "core/ProcessMemory.h"
+
+#include <QFile>
+#include <QByteArray>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#include <sys/resource.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace pat {
+namespace {
+
+#if defined(Q_OS_LINUX)
+qint64 ReadStatusKiB(const QByteArray& key) {
+    QFile file(QStringLiteral("/proc/self/status"));
+    if (!file.open(QIODevice::ReadOnly)) return -1;
+    const QByteArray content = file.readAll();
+    const qsizetype pos = content.indexOf(key);
+    if (pos < 0) return -1;
+    qsizetype i = pos + key.size();
+    while (i < content.size() && (content.at(i) == ':' || content.at(i) == ' ' || content.at(i) == '\t')) ++i;
+    qint64 value = 0;
+    while (i < content.size() && content.at(i) >= '0' && content.at(i) <= '9') {
+        value = value * 10 + (content.at(i) - '0');
+        ++i;
+    }
+    return value;
+}
+#endif
+
+}  // namespace
+
+qint64 CurrentResidentBytes() {
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return -1;
+    return static_cast<qint64>(counters.WorkingSetSize);
+#elif defined(Q_OS_MACOS)
+    mach_task_basic_info info{};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+        return -1;
+    }
+    return static_cast<qint64>(info.resident_size);
+#elif defined(Q_OS_LINUX)
+    const qint64 kib = ReadStatusKiB(QByteArrayLiteral("VmRSS"));
+    return kib < 0 ? -1 : kib * 1024;
+#else
+    return -1;
+#endif
+}
+
+qint64 PeakResidentBytes() {
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return -1;
+    return static_cast<qint64>(counters.PeakWorkingSetSize);
+#elif defined(Q_OS_MACOS)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+    return static_cast<qint64>(usage.ru_maxrss);
+#else
+#if defined(Q_OS_LINUX)
+    const qint64 kib = ReadStatusKiB(QByteArrayLiteral("VmHWM"));
+    if (kib >= 0) return kib * 1024;
+#endif
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+    return static_cast<qint64>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+bool ResetPeakResidentBytes() {
+#if defined(Q_OS_LINUX)
+    QFile file(QStringLiteral("/proc/self/clear_refs"));
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    return file.write("5", 1) == 1;
+#else
+    return false;
+#endif
+}
+
+}  // namespace pat
@@ -0,0 +1,12 @@
+﻿#pragma once
+
+#include <QtGlobal>
+
+namespace pat {
+
+qint64 CurrentResidentBytes();
+qint64 PeakResidentBytes();
+// 仅 Linux 支持（/proc/self/clear_refs），返回 false 表示峰值无法按文件单独统计
+bool ResetPeakResidentBytes();
+
+}  // namespace pat
@@ -0,0 +1,48 @@
+﻿#pragma once
+
+#include <QtEndian>
+#include <QtGlobal>
+
+#include <cstring>
+
+namespace pat {
+
+// 小端原始字节到 double 的读取，运行时解码与生成的编译期解码器共用
+template <typename T>
+inline T ReadLittle(const char* data) {
+    T value{};
+    std::memcpy(&value, data, sizeof(T));
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    if constexpr (sizeof(T) == 2) {
+        value = static_cast<T>(qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(data)));
+    } else if constexpr (sizeof(T) == 4) {
+        value = static_cast<T>(qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data)));
+    } else if constexpr (sizeof(T) == 8) {
+        value = static_cast<T>(qFromLittleEndian<quint64>(reinterpret_cast<const uchar*>(data)));
+    }
+#endif
+    return value;
+}
+
+template <typename Raw>
+inline double LoadRaw(const char* data) {
+    return static_cast<double>(ReadLittle<Raw>(data));
+}
+
+template <>
+inline double LoadRaw<float>(const char* data) {
+    const quint32 raw = ReadLittle<quint32>(data);
+    float v{};
+    std::memcpy(&v, &raw, sizeof(float));
+    return static_cast<double>(v);
+}
+
+template <>
+inline double LoadRaw<double>(const char* data) {
+    const quint64 raw = ReadLittle<quint64>(data);
+    double v{};
+    std::memcpy(&v, &raw, sizeof(double));
+    return v;
+}
+
+}  // namespace pat
@@ -1,137 +1,1197 @@
 ﻿#include "core/RecordParser.h"
 
+#include "core/Checksum.h"
+#include "core/Compression.h"
+#include "core/CompiledDecoder.h"
+#include "core/FileReader.h"
+#include "core/RawDecode.h"
+#include "core/RecordTypeIndex.h"
+#include "core/SyncScanner.h"
+#include "core/Trace.h"
+
 #include <QFile>
-#include <QtEndian>
+#include <QHash>
 
-#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <utility>
+#include <vector>
 
 namespace pat {
 namespace {
 
 int TypeSize(const QString& type) {
     const auto t = type.toLower();
+    if (t == "int8" || t == "uint8") return 1;
     if (t == "int16" || t == "uint16") return 2;
     if (t == "int32" || t == "uint32" || t == "float32") return 4;
     if (t == "float64") return 8;
     return 0;
 }
 
-template <typename T>
-T ReadLittle(const char* data) {
-    T value{};
-    std::memcpy(&value, data, sizeof(T));
-#if Q_BYTE_ORDER == Q_BIG_ENDIAN
-    if constexpr (sizeof(T) == 2) {
-        value = static_cast<T>(qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(data)));
-    } else if constexpr (sizeof(T) == 4) {
-        value = static_cast<T>(qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data)));
-    } else if constexpr (sizeof(T) == 8) {
-        value = static_cast<T>(qFromLittleEndian<quint64>(reinterpret_cast<const uchar*>(data)));
+enum class ValueKind { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64, Unknown };
+
+ValueKind ResolveValueKind(const QString& type) {
+    const auto t = type.toLower();
+    if (t == "int8") return ValueKind::Int8;
+    if (t == "uint8") return ValueKind::UInt8;
+    if (t == "int16") return ValueKind::Int16;
+    if (t == "uint16") return ValueKind::UInt16;
+    if (t == "int32") return ValueKind::Int32;
+    if (t == "uint32") return ValueKind::UInt32;
+    if (t == "float32") return ValueKind::Float32;
+    if (t == "float64") return ValueKind::Float64;
+    return ValueKind::Unknown;
+}
+
+// 解析前为每个信号确定一次类型与偏移，逐样本不再做字符串比较
+struct ColumnPlan {
+    ValueKind kind = ValueKind::Unknown;
+    int byteOffset = 0;
+    double scale = 1.0;
+    double bias = 0.0;
+};
+
+template <typename Raw>
+void DecodeColumn(const ColumnPlan& plan, const char* records, qint64 strideBytes, qint64 count, double* out) {
+    const char* ptr = records + plan.byteOffset;
+    for (qint64 i = 0; i < count; ++i) {
+        out[i] = LoadRaw<Raw>(ptr) * plan.scale + plan.bias;
+        ptr += strideBytes;
     }
-#endif
-    return value;
 }
 
-bool DecodeValue(const SignalFormat& sig, const char* recordBase, double& outValue) {
-    const char* ptr = recordBase + sig.byteOffset;
-    const auto t = sig.valueType.toLower();
+// 按记录下标取样（帧 ID 选中的记录）；data + runBias + i * recordSize 为第 i 条记录
+template <typename Raw>
+void GatherColumn(const ColumnPlan& plan,
+                  const char* data,
+                  qint64 runBias,
+                  int recordSize,
+                  const qint64* indices,
+                  qint64 count,
+                  double* out) {
+    const qint64 base = runBias + plan.byteOffset;
+    for (qint64 i = 0; i < count; ++i) {
+        out[i] = LoadRaw<Raw>(data + base + indices[i] * recordSize) * plan.scale + plan.bias;
+    }
+}
 
-    if (t == "int16") {
-        const auto v = ReadLittle<qint16>(ptr);
-        outValue = static_cast<double>(v) * sig.scale + sig.bias;
-        return true;
+template <typename Fn>
+void DispatchKind(ValueKind kind, Fn&& fn) {
+    switch (kind) {
+    case ValueKind::Int8:
+        fn(qint8{});
+        break;
+    case ValueKind::UInt8:
+        fn(quint8{});
+        break;
+    case ValueKind::Int16:
+        fn(qint16{});
+        break;
+    case ValueKind::UInt16:
+        fn(quint16{});
+        break;
+    case ValueKind::Int32:
+        fn(qint32{});
+        break;
+    case ValueKind::UInt32:
+        fn(quint32{});
+        break;
+    case ValueKind::Float32:
+        fn(float{});
+        break;
+    case ValueKind::Float64:
+        fn(double{});
+        break;
+    case ValueKind::Unknown:
+        break;
     }
-    if (t == "uint16") {
-        const auto v = ReadLittle<quint16>(ptr);
-        outValue = static_cast<double>(v) * sig.scale + sig.bias;
-        return true;
+}
+
+void DecodeColumnBlock(const ColumnPlan& plan, const char* records, qint64 strideBytes, qint64 count, double* out) {
+    DispatchKind(plan.kind, [&](auto raw) {
+        DecodeColumn<decltype(raw)>(plan, records, strideBytes, count, out);
+    });
+}
+
+void GatherColumnBlock(const ColumnPlan& plan,
+                       const char* data,
+                       qint64 runBias,
+                       int recordSize,
+                       const qint64* indices,
+                       qint64 count,
+                       double* out) {
+    DispatchKind(plan.kind, [&](auto raw) {
+        GatherColumn<decltype(raw)>(plan, data, runBias, recordSize, indices, count, out);
+    });
+}
+
+// 子换向信号的取样方式：全速率、按 stride/phase 等间隔、或按帧 ID 选中的记录（可再叠加 stride/phase）
+struct SamplePlan {
+    int stride = 1;
+    int phase = 0;
+    bool byFrame = false;
+    qint64 frameId = 0;
+    QVector<qint64> records;  // byFrame 时选中的记录下标
+    qint64 sampleCount = 0;
+    qint64 cursor = 0;        // 块循环中已解码的样本数
+
+    bool FullRate() const { return stride == 1 && phase == 0 && !byFrame; }
+};
+
+// 按块逐列解码：块内记录留在缓存中，同时写出连续的数值列
+constexpr qint64 kDecodeBlockBytes = 256 * 1024;
+
+// 按记录段逐块遍历，块不跨段；fn(first, count, runBias)，第 i 条记录位于 runBias + i * recordSize
+template <typename Fn>
+void ForEachBlock(const QVector<RecordRun>& runs, int recordSize, Fn&& fn) {
+    const qint64 blockRecords = std::max<qint64>(1, kDecodeBlockBytes / recordSize);
+    for (const RecordRun& run : runs) {
+        const qint64 runBias = run.fileOffset - run.firstRecord * recordSize;
+        const qint64 runEnd = run.firstRecord + run.count;
+        for (qint64 first = run.firstRecord; first < runEnd; first += blockRecords) {
+            fn(first, std::min(blockRecords, runEnd - first), runBias);
+        }
     }
-    if (t == "int32") {
-        const auto v = ReadLittle<qint32>(ptr);
-        outValue = static_cast<double>(v) * sig.scale + sig.bias;
-        return true;
+}
+
+quint32 LoadStoredChecksum(const char* field, int width) {
+    switch (width) {
+    case 1:
+        return ReadLittle<quint8>(field);
+    case 2:
+        return ReadLittle<quint16>(field);
+    default:
+        return ReadLittle<quint32>(field);
     }
-    if (t == "uint32") {
-        const auto v = ReadLittle<quint32>(ptr);
-        outValue = static_cast<double>(v) * sig.scale + sig.bias;
-        return true;
+}
+
+// 校验一块记录，失败的记录在位图中清零；返回失败条数
+qint64 ValidateBlock(const ChecksumField& checksum,
+                     const char* records,
+                     qint64 recordSize,
+                     qint64 first,
+                     qint64 count,
+                     QVector<quint64>& recordValid) {
+    const int width = ChecksumWidth(checksum.kind);
+    const quint32 mask = width >= 4 ? 0xFFFFFFFFu : ((1u << (width * 8)) - 1u);
+    quint64* bits = recordValid.data();
+    qint64 invalid = 0;
+    for (qint64 i = 0; i < count; ++i) {
+        const char* record = records + i * recordSize;
+        const quint32 computed = ComputeChecksum(checksum.kind, record + checksum.rangeOffset, checksum.rangeLength) & mask;
+        if (computed == LoadStoredChecksum(record + checksum.byteOffset, width)) continue;
+        const qint64 r = first + i;
+        bits[r >> 6] &= ~(quint64{1} << (r & 63));
+        ++invalid;
     }
-    if (t == "float32") {
-        quint32 raw = ReadLittle<quint32>(ptr);
-        float v{};
-        std::memcpy(&v, &raw, sizeof(float));
-        outValue = static_cast<double>(v) * sig.scale + sig.bias;
-        return true;
+    return invalid;
+}
+
+bool RecordValid(const QVector<quint64>& recordValid, qint64 record) {
+    return ((recordValid[record >> 6] >> (record & 63)) & 1u) != 0;
+}
+
+// 按取样记录把记录位图投影到各信号；没有无效样本的信号保持 validity 为空
+void AssignValidity(const QVector<SamplePlan>& samplePlans, const QVector<quint64>& recordValid, QVector<Series>& outSeries) {
+    for (int s = 0; s < outSeries.size(); ++s) {
+        const SamplePlan& sample = samplePlans[s];
+        Series& series = outSeries[s];
+        if (sample.FullRate()) {
+            series.validity = recordValid;
+            continue;
+        }
+        QVector<quint64> bits((sample.sampleCount + 63) / 64, ~quint64{0});
+        bool anyInvalid = false;
+        for (qint64 i = 0; i < sample.sampleCount; ++i) {
+            const qint64 record = sample.byFrame ? sample.records[i] : sample.phase + i * sample.stride;
+            if (RecordValid(recordValid, record)) continue;
+            bits[i >> 6] &= ~(quint64{1} << (i & 63));
+            anyInvalid = true;
+        }
+        if (anyInvalid) series.validity = std::move(bits);
+    }
+}
+
+// 原始计数展开回绕并换算为时间轴，时间从首条记录起算；无回绕配置时计数倒退视为错误
+// 校验失败的记录时间戳不可信，沿用上一条有效记录的计数，不参与单调性判断。
+// originTick 非空时以其为时间零点（多记录类型共用文件首条记录的计数），首个计数小于零点视为已回绕一次
+bool BuildTimestampAxis(const TimestampField& timestamp,
+                        const QVector<quint64>* recordValid,
+                        QVector<double>& ticks,
+                        QString& errorMessage,
+                        const double* originTick = nullptr) {
+    if (ticks.isEmpty()) return true;
+    double* data = ticks.data();
+    qsizetype firstValid = 0;
+    if (recordValid) {
+        while (firstValid < ticks.size() && !RecordValid(*recordValid, firstValid)) ++firstValid;
+        if (firstValid == ticks.size()) firstValid = 0;
+    }
+    const double origin = originTick ? *originTick : data[firstValid];
+    double previous = data[firstValid];
+    double offset = (data[firstValid] < origin && timestamp.rollover > 0.0) ? timestamp.rollover : 0.0;
+    for (qsizetype i = 0; i < ticks.size(); ++i) {
+        if (recordValid && !RecordValid(*recordValid, i)) data[i] = previous;
+        const double raw = data[i];
+        if (raw < previous) {
+            if (timestamp.rollover <= 0.0) {
+                errorMessage = QStringLiteral("时间戳非单调：第 %1 条记录").arg(i);
+                return false;
+            }
+            offset += timestamp.rollover;
+        }
+        previous = raw;
+        data[i] = (raw + offset - origin) * timestamp.scale;
+    }
+    return true;
+}
+
+// 帧 ID 字段按整数比较；一次扫描同时为所有用到的 ID 收集记录下标。
+// leadingRecords 为部分加载时窗口之前的记录数（从文件起点连续存放），stride/phase 按该 ID 在整个文件中的命中序号计
+bool BuildFrameSelections(const FormatDefinition& format,
+                          const char* data,
+                          const QVector<RecordRun>& runs,
+                          qint64 leadingRecords,
+                          QVector<SamplePlan>& samplePlans,
+                          QString& errorMessage) {
+    QHash<qint64, int> slotById;
+    std::vector<QVector<qint64>> recordsBySlot;
+    for (const auto& sample : samplePlans) {
+        if (!sample.byFrame || slotById.contains(sample.frameId)) continue;
+        slotById.insert(sample.frameId, static_cast<int>(recordsBySlot.size()));
+        recordsBySlot.emplace_back();
+    }
+    if (recordsBySlot.empty()) return true;
+
+    const FrameIdField& field = format.frameIdField;
+    ColumnPlan idPlan;
+    idPlan.kind = ResolveValueKind(field.valueType);
+    idPlan.byteOffset = field.byteOffset;
+    if (idPlan.kind == ValueKind::Unknown || idPlan.kind == ValueKind::Float32 || idPlan.kind == ValueKind::Float64 ||
+        field.byteOffset + TypeSize(field.valueType) > format.recordSize) {
+        errorMessage = QStringLiteral("frame_id_field 定义非法");
+        return false;
     }
-    if (t == "float64") {
-        quint64 raw = ReadLittle<quint64>(ptr);
-        double v{};
-        std::memcpy(&v, &raw, sizeof(double));
-        outValue = v * sig.scale + sig.bias;
+
+    std::vector<double> ids(static_cast<size_t>(std::max<qint64>(1, kDecodeBlockBytes / format.recordSize)));
+    const auto scan = [&](const QVector<RecordRun>& scanRuns, auto&& onMatch) {
+        ForEachBlock(scanRuns, format.recordSize, [&](qint64 first, qint64 count, qint64 runBias) {
+            DecodeColumnBlock(idPlan, data + runBias + first * format.recordSize, format.recordSize, count, ids.data());
+            for (qint64 i = 0; i < count; ++i) {
+                const int slot = slotById.value(static_cast<qint64>(ids[static_cast<size_t>(i)]), -1);
+                if (slot >= 0) onMatch(slot, first + i);
+            }
+        });
+    };
+    scan(runs, [&](int slot, qint64 record) { recordsBySlot[static_cast<size_t>(slot)].append(record); });
+
+    // 窗口之前的命中数只在 stride > 1 时影响取哪些记录，此时才扫描窗口之前的帧 ID 列
+    std::vector<qint64> leadingMatches(recordsBySlot.size(), 0);
+    const bool needsLeading = leadingRecords > 0 && std::any_of(samplePlans.cbegin(), samplePlans.cend(), [](const SamplePlan& p) {
+                                  return p.byFrame && p.stride > 1;
+                              });
+    if (needsLeading) {
+        scan(QVector<RecordRun>{RecordRun{0, 0, leadingRecords}},
+             [&](int slot, qint64) { ++leadingMatches[static_cast<size_t>(slot)]; });
+    }
+
+    // 同一帧 ID 内再按 stride/phase 抽取
+    for (auto& sample : samplePlans) {
+        if (!sample.byFrame) continue;
+        const int slot = slotById.value(sample.frameId);
+        const QVector<qint64>& matches = recordsBySlot[static_cast<size_t>(slot)];
+        const qint64 leading = leadingMatches[static_cast<size_t>(slot)];
+        const qint64 firstMatch = ((sample.phase - leading) % sample.stride + sample.stride) % sample.stride;
+        sample.records.clear();
+        sample.records.reserve((matches.size() + sample.stride - 1) / sample.stride);
+        for (qsizetype i = firstMatch; i < matches.size(); i += sample.stride) sample.records.append(matches[i]);
+    }
+    return true;
+}
+
+// 全速率信号共享同一时间列；子换向信号按取样记录生成各自的时间列，相同取样方式之间共享。
+// recordBase 为部分加载时首条记录在文件中的序号，合成时间轴按文件内的绝对序号计算
+void AssignTimeAxes(const FormatDefinition& format,
+                    const QVector<SamplePlan>& samplePlans,
+                    const QVector<double>* timeAxis,
+                    QVector<Series>& outSeries,
+                    qint64 recordBase = 0) {
+    QHash<QString, int> axisByKey;
+    std::vector<Series> axes;
+    for (int s = 0; s < outSeries.size(); ++s) {
+        const SamplePlan& sample = samplePlans[s];
+        const double timeScale = format.signalFormats[s].timeScale;
+        if (!timeAxis && !sample.byFrame) continue;  // 合成的均匀时间轴已由 origin/step 给出
+
+        const QString key = sample.byFrame
+                                ? QStringLiteral("frame:%1/%2/%3").arg(sample.frameId).arg(sample.stride).arg(sample.phase)
+                                : QStringLiteral("stride:%1/%2").arg(sample.stride).arg(sample.phase);
+        const QString axisKey = timeAxis ? key : key + QStringLiteral("@%1").arg(timeScale, 0, 'g', 17);
+        int axisIndex = axisByKey.value(axisKey, -1);
+        if (axisIndex < 0) {
+            Series axis;
+            if (timeAxis && sample.FullRate()) {
+                axis.times = *timeAxis;
+            } else {
+                axis.times.resize(static_cast<qsizetype>(sample.sampleCount));
+                for (qint64 i = 0; i < sample.sampleCount; ++i) {
+                    const qint64 record = sample.byFrame ? sample.records[i] : sample.phase + i * sample.stride;
+                    axis.times[i] = timeAxis ? (*timeAxis)[record] : static_cast<double>(recordBase + record) * timeScale;
+                }
+            }
+            axis.BuildTimeIndex();
+            axisIndex = static_cast<int>(axes.size());
+            axisByKey.insert(axisKey, axisIndex);
+            axes.push_back(std::move(axis));
+        }
+        const Series& axis = axes[static_cast<size_t>(axisIndex)];
+        Series& series = outSeries[s];
+        series.times = axis.times;
+        series.timeIndex = axis.timeIndex;
+        series.timeOrigin = 0.0;
+        if (series.times.size() > 1) {
+            series.timeStep = (series.times.last() - series.times.first()) / static_cast<double>(series.times.size() - 1);
+        }
+    }
+}
+
+// 顺序数据源：按文件顺序把数据分段交给 sink（解压输出或异步读到的块）
+using RecordSource = std::function<bool(const ReadSink& sink, QString& errorMessage)>;
+
+// 流式解析：分段数据凑成整条记录后按块解码，列随解码增长，不保留整份数据。
+// 跨分段的记录先拼到 carry 中；帧 ID 信号在块内按 ID 选取，并按该 ID 的累计命中数套用 stride/phase。
+// sizeHint 为预计的数据总长（未知时 <= 0），只用于预留列容量
+bool ParseRecordStream(const FormatDefinition& format,
+                       const QVector<ColumnPlan>& plans,
+                       QVector<SamplePlan>& samplePlans,
+                       const ColumnPlan& timestampPlan,
+                       qint64 sizeHint,
+                       const RecordSource& source,
+                       QVector<Series>& outSeries,
+                       QString& errorMessage,
+                       ParseReport* report) {
+    const int recordSize = format.recordSize;
+    const int signalCount = static_cast<int>(format.signalFormats.size());
+    const qint64 blockRecords = std::max<qint64>(1, kDecodeBlockBytes / recordSize);
+    const qint64 expectedRecords = sizeHint > 0 ? sizeHint / recordSize : 0;
+
+    outSeries.clear();
+    outSeries.resize(signalCount);
+    bool anyByFrame = false;
+    for (int s = 0; s < signalCount; ++s) {
+        const auto& sig = format.signalFormats[s];
+        SamplePlan& sample = samplePlans[s];
+        outSeries[s].name = sig.name;
+        outSeries[s].unit = sig.unit;
+        outSeries[s].timeOrigin = sample.byFrame ? 0.0 : sig.timeScale * sample.phase;
+        outSeries[s].timeStep = sig.timeScale * sample.stride;
+        if (!sample.byFrame && expectedRecords > 0) outSeries[s].values.reserve(expectedRecords / sample.stride + 1);
+        sample.records.clear();
+        sample.cursor = 0;
+        anyByFrame = anyByFrame || sample.byFrame;
+    }
+
+    ColumnPlan idPlan;
+    if (anyByFrame) {
+        idPlan.kind = ResolveValueKind(format.frameIdField.valueType);
+        idPlan.byteOffset = format.frameIdField.byteOffset;
+    }
+    std::vector<double> ids(static_cast<size_t>(anyByFrame ? blockRecords : 0));
+    QVector<qint64> frameMatches(signalCount, 0);
+    QVector<qint64> selected;
+
+    const TimestampField& timestamp = format.timestamp;
+    const ChecksumField& checksum = format.checksum;
+    QVector<double> timeAxis;
+    QVector<quint64> recordValid;
+    qint64 invalidRecords = 0;
+    qint64 recordCount = 0;
+
+    const auto decodeBlock = [&](const char* records, qint64 count) {
+        const qint64 first = recordCount;
+        const qint64 last = first + count;
+        if (checksum.enabled) {
+            while (recordValid.size() < (last + 63) / 64) recordValid.append(~quint64{0});
+            invalidRecords += ValidateBlock(checksum, records, recordSize, first, count, recordValid);
+        }
+        if (timestamp.enabled) {
+            timeAxis.resize(last);
+            DecodeColumnBlock(timestampPlan, records, recordSize, count, timeAxis.data() + first);
+        }
+        if (anyByFrame) DecodeColumnBlock(idPlan, records, recordSize, count, ids.data());
+        for (int s = 0; s < signalCount; ++s) {
+            SamplePlan& sample = samplePlans[s];
+            QVector<double>& values = outSeries[s].values;
+            if (sample.FullRate()) {
+                values.resize(last);
+                DecodeColumnBlock(plans[s], records, recordSize, count, values.data() + first);
+            } else if (sample.byFrame) {
+                selected.clear();
+                for (qint64 i = 0; i < count; ++i) {
+                    if (static_cast<qint64>(ids[static_cast<size_t>(i)]) != sample.frameId) continue;
+                    if (frameMatches[s]++ % sample.stride != sample.phase) continue;
+                    selected.append(i);
+                    sample.records.append(first + i);
+                }
+                const qint64 begin = values.size();
+                values.resize(begin + selected.size());
+                GatherColumnBlock(plans[s], records, 0, recordSize, selected.constData(), selected.size(), values.data() + begin);
+            } else {
+                const qint64 begin = sample.cursor;
+                const qint64 end = std::max(begin, (last - sample.phase + sample.stride - 1) / sample.stride);
+                if (end <= begin) continue;
+                values.resize(end);
+                const char* firstRecord = records + (sample.phase + begin * sample.stride - first) * recordSize;
+                DecodeColumnBlock(plans[s], firstRecord, static_cast<qint64>(recordSize) * sample.stride, end - begin,
+                                  values.data() + begin);
+                sample.cursor = end;
+            }
+        }
+        recordCount = last;
+    };
+
+    QByteArray carry;
+    const ReadSink sink = [&](const char* chunk, qint64 length) {
+        if (!carry.isEmpty()) {
+            const qint64 take = std::min<qint64>(length, recordSize - carry.size());
+            carry.append(chunk, take);
+            chunk += take;
+            length -= take;
+            if (carry.size() < recordSize) return true;
+            decodeBlock(carry.constData(), 1);
+            carry.clear();
+        }
+        const qint64 whole = length / recordSize;
+        for (qint64 done = 0; done < whole; done += blockRecords) {
+            decodeBlock(chunk + done * recordSize, std::min(blockRecords, whole - done));
+        }
+        carry.append(chunk + whole * recordSize, length - whole * recordSize);
         return true;
+    };
+    if (!source(sink, errorMessage)) {
+        outSeries.clear();
+        return false;
+    }
+    if (recordCount == 0) {
+        errorMessage = QStringLiteral("数据长度不足一个记录");
+        outSeries.clear();
+        return false;
     }
-    return false;
+
+    for (auto& sample : samplePlans) {
+        if (sample.byFrame) {
+            sample.sampleCount = sample.records.size();
+        } else {
+            sample.sampleCount = sample.phase < recordCount ? (recordCount - sample.phase + sample.stride - 1) / sample.stride : 0;
+        }
+    }
+    if (report) {
+        report->recordCount = recordCount;
+        report->skippedBytes = 0;
+        report->gaps.clear();
+        report->invalidRecords = invalidRecords;
+    }
+
+    const bool anyInvalid = invalidRecords > 0;
+    if (timestamp.enabled && !BuildTimestampAxis(timestamp, anyInvalid ? &recordValid : nullptr, timeAxis, errorMessage)) {
+        outSeries.clear();
+        return false;
+    }
+    AssignTimeAxes(format, samplePlans, timestamp.enabled ? &timeAxis : nullptr, outSeries);
+    if (anyInvalid) AssignValidity(samplePlans, recordValid, outSeries);
+    return true;
 }
 
-}  // namespace
+// 多记录类型中一组取样方式相同的信号：所属类型 + stride/phase，offsets 为取样记录的文件偏移
+struct TypedSelection {
+    int type = 0;
+    int stride = 1;
+    int phase = 0;
+    QVector<qint64> offsets;
+    QVector<int> signalIndices;
+};
 
-RecordParser::RecordParser(FormatDefinition format) : format_(std::move(format)) {}
+// 多记录类型：首遍建立按类型分桶的偏移索引，再按取样组逐块聚集解码；各类型的时间轴独立生成
+bool ParseTypedRecords(const FormatDefinition& format,
+                       const char* data,
+                       qint64 fileSize,
+                       const QVector<ColumnPlan>& plans,
+                       const QVector<SamplePlan>& samplePlans,
+                       const ColumnPlan& timestampPlan,
+                       QVector<Series>& outSeries,
+                       QString& errorMessage,
+                       ParseReport* report) {
+    const RecordTypeIndex index = BuildRecordTypeIndex(data, fileSize, format.recordTypes);
+    if (index.recordCount == 0) {
+        errorMessage = QStringLiteral("未找到可识别的记录类型");
+        return false;
+    }
+    if (report) {
+        report->recordCount = index.recordCount;
+        report->skippedBytes = index.skippedBytes;
+        report->gaps = index.gaps;
+        report->invalidRecords = 0;
+    }
+
+    const int signalCount = static_cast<int>(format.signalFormats.size());
+    QHash<QString, int> selectionByKey;
+    std::vector<TypedSelection> selections;
+    outSeries.clear();
+    outSeries.resize(signalCount);
+    for (int s = 0; s < signalCount; ++s) {
+        const auto& sig = format.signalFormats[s];
+        const SamplePlan& sample = samplePlans[s];
+        const QString key = QStringLiteral("%1/%2/%3").arg(sig.recordType).arg(sample.stride).arg(sample.phase);
+        int slot = selectionByKey.value(key, -1);
+        if (slot < 0) {
+            TypedSelection selection;
+            selection.type = sig.recordType;
+            selection.stride = sample.stride;
+            selection.phase = sample.phase;
+            const QVector<qint64>& typeOffsets = index.offsets[static_cast<size_t>(sig.recordType)];
+            if (sample.stride == 1 && sample.phase == 0) {
+                selection.offsets = typeOffsets;
+            } else {
+                for (qsizetype i = sample.phase; i < typeOffsets.size(); i += sample.stride) selection.offsets.append(typeOffsets[i]);
+            }
+            slot = static_cast<int>(selections.size());
+            selectionByKey.insert(key, slot);
+            selections.push_back(std::move(selection));
+        }
+        TypedSelection& selection = selections[static_cast<size_t>(slot)];
+        selection.signalIndices.append(s);
+
+        outSeries[s].name = sig.name;
+        outSeries[s].unit = sig.unit;
+        outSeries[s].timeOrigin = sig.timeScale * sample.phase;
+        outSeries[s].timeStep = sig.timeScale * sample.stride;
+        outSeries[s].values.resize(selection.offsets.size());
+    }
+
+    // 同组信号逐块解码，块内记录留在缓存中
+    const qint64 blockRecords = std::max<qint64>(1, kDecodeBlockBytes / format.recordSize);
+    for (const TypedSelection& selection : selections) {
+        const qint64 count = selection.offsets.size();
+        for (qint64 first = 0; first < count; first += blockRecords) {
+            const qint64 n = std::min(blockRecords, count - first);
+            for (int s : selection.signalIndices) {
+                GatherColumnBlock(plans[s], data, 0, 1, selection.offsets.constData() + first, n, outSeries[s].values.data() + first);
+            }
+        }
+    }
 
-bool RecordParser::ParseFile(const QString& path, QVector<Series>& outSeries, QString& errorMessage) const {
-    if (format_.signalFormats.empty()) {
+    if (!format.timestamp.enabled) return true;
+
+    // 时间戳在公共记录头：每个类型单独展开回绕，零点取文件中首条记录的计数，使各类型时间可比
+    qint64 firstOffset = fileSize;
+    for (const auto& offsets : index.offsets) {
+        if (!offsets.isEmpty()) firstOffset = std::min(firstOffset, offsets.first());
+    }
+    double originTick = 0.0;
+    DecodeColumnBlock(timestampPlan, data + firstOffset, 0, 1, &originTick);
+
+    std::vector<QVector<double>> typeAxes(index.offsets.size());
+    for (size_t t = 0; t < index.offsets.size(); ++t) {
+        const QVector<qint64>& offsets = index.offsets[t];
+        QVector<double>& axis = typeAxes[t];
+        axis.resize(offsets.size());
+        GatherColumnBlock(timestampPlan, data, 0, 1, offsets.constData(), offsets.size(), axis.data());
+        if (!BuildTimestampAxis(format.timestamp, nullptr, axis, errorMessage, &originTick)) {
+            errorMessage = QStringLiteral("记录类型 %1：%2").arg(format.recordTypes.types[t].id).arg(errorMessage);
+            outSeries.clear();
+            return false;
+        }
+    }
+    for (const TypedSelection& selection : selections) {
+        const QVector<double>& typeAxis = typeAxes[static_cast<size_t>(selection.type)];
+        Series axis;
+        if (selection.stride == 1 && selection.phase == 0) {
+            axis.times = typeAxis;
+        } else {
+            axis.times.resize(selection.offsets.size());
+            for (qsizetype i = 0; i < axis.times.size(); ++i) axis.times[i] = typeAxis[selection.phase + i * selection.stride];
+        }
+        axis.BuildTimeIndex();
+        for (int s : selection.signalIndices) {
+            Series& series = outSeries[s];
+            series.times = axis.times;
+            series.timeIndex = axis.timeIndex;
+            series.timeOrigin = 0.0;
+            if (series.times.size() > 1) {
+                series.timeStep = (series.times.last() - series.times.first()) / static_cast<double>(series.times.size() - 1);
+            }
+        }
+    }
+    return true;
+}
+
+double LoadTick(const ColumnPlan& plan, const char* record) {
+    double tick = 0.0;
+    DecodeColumnBlock(plan, record, 0, 1, &tick);
+    return tick;
+}
+
+// 部分加载时的时间零点：文件首条记录的计数减去到 endRecord 为止累计的回绕量，
+// 使窗口内的时间与整文件解析一致。回绕计数只能从文件头顺序扫描计数列
+double RangeOriginTick(const TimestampField& timestamp, const ColumnPlan& plan, const char* data, int recordSize, qint64 endRecord) {
+    const double first = LoadTick(plan, data);
+    if (timestamp.rollover <= 0.0) return first;
+    double previous = first;
+    double wrapped = 0.0;
+    for (qint64 r = 1; r <= endRecord; ++r) {
+        const double tick = LoadTick(plan, data + r * recordSize);
+        if (tick < previous) wrapped += timestamp.rollover;
+        previous = tick;
+    }
+    return first - wrapped;
+}
+
+// 解析前的格式检查与逐信号取样计划，ParseFile 与 ParsePreview 共用
+bool BuildParsePlans(const FormatDefinition& format,
+                     QVector<ColumnPlan>& plans,
+                     QVector<SamplePlan>& samplePlans,
+                     ColumnPlan& timestampPlan,
+                     bool& allFullRate,
+                     QString& errorMessage) {
+    if (format.signalFormats.empty()) {
         errorMessage = QStringLiteral("格式未包含信号定义");
         return false;
     }
-    if (format_.recordSize <= 0) {
+    if (format.recordSize <= 0) {
         errorMessage = QStringLiteral("record_size 非法");
         return false;
     }
-    if (format_.endianness != QStringLiteral("little")) {
+    if (format.endianness != QStringLiteral("little")) {
         errorMessage = QStringLiteral("当前仅支持 little-endian");
         return false;
     }
 
+    const int signalCount = static_cast<int>(format.signalFormats.size());
+    plans = QVector<ColumnPlan>(signalCount);
+    samplePlans = QVector<SamplePlan>(signalCount);
+    allFullRate = true;
+    for (int s = 0; s < signalCount; ++s) {
+        const auto& sig = format.signalFormats[s];
+        const int size = TypeSize(sig.valueType);
+        plans[s].kind = ResolveValueKind(sig.valueType);
+        if (plans[s].kind == ValueKind::Unknown) {
+            errorMessage = QStringLiteral("信号 '%1' 类型不支持：%2").arg(sig.name, sig.valueType);
+            return false;
+        }
+        if (sig.byteOffset + size > format.recordSize) {
+            errorMessage = QStringLiteral("信号 '%1' 超出记录长度").arg(sig.name);
+            return false;
+        }
+        plans[s].byteOffset = sig.byteOffset;
+        plans[s].scale = sig.scale;
+        plans[s].bias = sig.bias;
+
+        if (sig.recordStride < 1 || sig.recordPhase < 0 || sig.recordPhase >= sig.recordStride) {
+            errorMessage = QStringLiteral("信号 '%1' 的 record_stride/record_phase 非法").arg(sig.name);
+            return false;
+        }
+        if (sig.hasFrameId && !format.frameIdField.enabled) {
+            errorMessage = QStringLiteral("信号 '%1' 指定了 frame_id，但格式未定义 frame_id_field").arg(sig.name);
+            return false;
+        }
+        if (format.recordTypes.enabled) {
+            const int typeCount = static_cast<int>(format.recordTypes.types.size());
+            if (sig.recordType < 0 || sig.recordType >= typeCount ||
+                sig.byteOffset + size > format.recordTypes.types[static_cast<size_t>(sig.recordType)].recordSize) {
+                errorMessage = QStringLiteral("信号 '%1' 的记录类型非法或超出该类型长度").arg(sig.name);
+                return false;
+            }
+        }
+        samplePlans[s].stride = sig.recordStride;
+        samplePlans[s].phase = sig.recordPhase;
+        samplePlans[s].byFrame = sig.hasFrameId;
+        samplePlans[s].frameId = sig.frameId;
+        allFullRate = allFullRate && samplePlans[s].FullRate();
+    }
+
+    const TimestampField& timestamp = format.timestamp;
+    timestampPlan = ColumnPlan{};
+    if (timestamp.enabled) {
+        timestampPlan.kind = ResolveValueKind(timestamp.valueType);
+        timestampPlan.byteOffset = timestamp.byteOffset;
+        if (timestampPlan.kind == ValueKind::Unknown ||
+            timestamp.byteOffset + TypeSize(timestamp.valueType) > format.recordSize) {
+            errorMessage = QStringLiteral("时间戳字段定义非法");
+            return false;
+        }
+    }
+    return true;
+}
+
+// 格式声明 compression: none 时不看文件头，一律按原始记录解析
+CompressionKind DetectDataCompression(const FormatDefinition& format, const char* data, qint64 size) {
+    return format.detectCompression ? DetectCompression(data, size) : CompressionKind::None;
+}
+
+}  // namespace
+
+RecordParser::RecordParser(FormatDefinition format) : format_(std::move(format)) {}
+
+bool RecordParser::ParseFile(const QString& path,
+                             QVector<Series>& outSeries,
+                             QString& errorMessage,
+                             ParseReport* report) const {
+    const TraceScope trace("RecordParser::ParseFile", "parse");
+    return ParseRange(path, RecordRange(), outSeries, errorMessage, report);
+}
+
+bool RecordParser::ParseRange(const QString& path,
+                              const RecordRange& range,
+                              QVector<Series>& outSeries,
+                              QString& errorMessage,
+                              ParseReport* report) const {
+    const TraceScope trace("RecordParser::ParseRange", "parse");
+    const int signalCount = static_cast<int>(format_.signalFormats.size());
+    QVector<ColumnPlan> plans;
+    QVector<SamplePlan> samplePlans;
+    ColumnPlan timestampPlan;
+    bool allFullRate = true;
+    if (!BuildParsePlans(format_, plans, samplePlans, timestampPlan, allFullRate, errorMessage)) return false;
+    const TimestampField& timestamp = format_.timestamp;
+    const bool partial = !range.IsFull();
+    if (partial && (format_.syncWord.enabled || format_.recordTypes.enabled)) {
+        errorMessage = QStringLiteral("同步字与多记录类型格式无法按记录序号定位，不支持部分加载");
+        return false;
+    }
+
     QFile file(path);
     if (!file.open(QIODevice::ReadOnly)) {
         errorMessage = QStringLiteral("无法打开数据文件：%1").arg(path);
         return false;
     }
 
-    const QByteArray buffer = file.readAll();
-    if (buffer.size() < format_.recordSize) {
+    qint64 fileSize = file.size();
+    const int minRecordSize = format_.recordTypes.enabled ? format_.recordTypes.MinRecordSize() : format_.recordSize;
+    if (fileSize <= 0) {
         errorMessage = QStringLiteral("数据长度不足一个记录");
         return false;
     }
 
-    const int recordCount = buffer.size() / format_.recordSize;
-    const int signalCount = static_cast<int>(format_.signalFormats.size());
+    // 分块读取：顺序可解析的格式边读边解码（Async 时后续块的读取与当前块的解码重叠）；
+    // 同步字与多记录类型需要随机访问，整份读入内存。压缩文件仍走映射后解压的路径
+    QByteArray fallback;
+    const char* data = nullptr;
+    if (readBackend_ != ReadBackend::Mmap && !partial) {
+        char magic[4] = {};
+        const qint64 magicBytes = file.read(magic, sizeof(magic));
+        if (DetectDataCompression(format_, magic, std::max<qint64>(0, magicBytes)) == CompressionKind::None) {
+            file.close();
+            if (!format_.syncWord.enabled && !format_.recordTypes.enabled) {
+                const RecordSource source = [&](const ReadSink& sink, QString& error) {
+                    return ReadFileBlocks(path, readBackend_, sink, error);
+                };
+                return ParseRecordStream(format_, plans, samplePlans, timestampPlan, fileSize, source, outSeries, errorMessage,
+                                         report);
+            }
+            fallback.reserve(fileSize);
+            const ReadSink append = [&fallback](const char* chunk, qint64 length) {
+                fallback.append(chunk, length);
+                return true;
+            };
+            if (!ReadFileBlocks(path, readBackend_, append, errorMessage)) return false;
+            data = fallback.constData();
+            fileSize = fallback.size();
+        } else {
+            file.seek(0);
+        }
+    }
+
+    // 优先内存映射，避免整文件拷贝；映射失败（如非本地文件）时退回 readAll
+    if (!data) {
+        data = reinterpret_cast<const char*>(file.map(0, fileSize));
+        if (!data) {
+            fallback = file.readAll();
+            data = fallback.constData();
+        }
+    }
+
+    // gzip/zstd 压缩文件：顺序读取即可解析的格式边解压边解码；同步字与多记录类型需要随机访问，解压到内存后照常解析
+    QByteArray inflated;
+    const CompressionKind compression = DetectDataCompression(format_, data, fileSize);
+    if (compression != CompressionKind::None && partial) {
+        errorMessage = QStringLiteral("压缩数据文件不支持部分加载");
+        return false;
+    }
+    if (compression != CompressionKind::None) {
+        if (!format_.syncWord.enabled && !format_.recordTypes.enabled) {
+            const RecordSource source = [&](const ReadSink& sink, QString& error) {
+                return DecompressStream(data, fileSize, compression, sink, error);
+            };
+            return ParseRecordStream(format_, plans, samplePlans, timestampPlan, DecompressedSizeHint(data, fileSize, compression),
+                                     source, outSeries, errorMessage, report);
+        }
+        const qint64 hint = DecompressedSizeHint(data, fileSize, compression);
+        if (hint > 0) inflated.reserve(hint);
+        const DecompressSink append = [&inflated](const char* chunk, qint64 length) {
+            inflated.append(chunk, length);
+            return true;
+        };
+        if (!DecompressStream(data, fileSize, compression, append, errorMessage)) return false;
+        data = inflated.constData();
+        fileSize = inflated.size();
+    }
+    if (fileSize < minRecordSize) {
+        errorMessage = QStringLiteral("数据长度不足一个记录");
+        return false;
+    }
+
+    if (format_.recordTypes.enabled) {
+        return ParseTypedRecords(format_, data, fileSize, plans, samplePlans, timestampPlan, outSeries, errorMessage, report);
+    }
+
+    // 有同步字时先扫描出完整记录段并跳过损坏区域，否则整个文件（或部分加载的记录范围）视为一段
+    SyncScanResult layout;
+    qint64 recordBase = 0;
+    if (format_.syncWord.enabled) {
+        layout = ScanSyncRecords(data, fileSize, format_.recordSize, format_.syncWord.pattern, format_.syncWord.byteOffset);
+        if (layout.recordCount == 0) {
+            errorMessage = QStringLiteral("未找到同步字，无法定位记录");
+            return false;
+        }
+    } else {
+        const qint64 totalRecords = fileSize / format_.recordSize;
+        recordBase = std::clamp<qint64>(range.firstRecord, 0, totalRecords);
+        layout.recordCount = range.recordCount < 0 ? totalRecords - recordBase : std::min(range.recordCount, totalRecords - recordBase);
+        if (layout.recordCount <= 0) {
+            errorMessage = QStringLiteral("记录范围超出文件：共 %1 条记录").arg(totalRecords);
+            return false;
+        }
+        layout.runs.append(RecordRun{recordBase * format_.recordSize, 0, layout.recordCount});
+    }
+    const qint64 recordCount = layout.recordCount;
+    // stride 信号的 phase 按文件内的绝对序号定义，换算到窗口内的相对序号；帧 ID 信号在 BuildFrameSelections 中按窗口之前的命中数换算
+    for (auto& sample : samplePlans) {
+        if (!sample.byFrame && recordBase > 0) sample.phase = static_cast<int>(((sample.phase - recordBase) % sample.stride + sample.stride) % sample.stride);
+    }
+    if (report) {
+        report->recordCount = recordCount - layout.missingRecords;
+        report->missingRecords = layout.missingRecords;
+        report->skippedBytes = layout.skippedBytes;
+        report->gaps = layout.gaps;
+        report->invalidRecords = 0;
+    }
+
+    // 按帧 ID 取样的信号：先扫描一遍帧 ID 列，为用到的每个 ID 建记录下标表
+    if (!BuildFrameSelections(format_, data, layout.runs, recordBase, samplePlans, errorMessage)) return false;
+    for (auto& sample : samplePlans) {
+        if (sample.byFrame) {
+            sample.sampleCount = sample.records.size();
+        } else {
+            sample.sampleCount = sample.phase < recordCount ? (recordCount - sample.phase + sample.stride - 1) / sample.stride : 0;
+        }
+    }
 
     outSeries.clear();
     outSeries.resize(signalCount);
     for (int i = 0; i < signalCount; ++i) {
-        outSeries[i].name = format_.signalFormats[i].name;
-        outSeries[i].unit = format_.signalFormats[i].unit;
+        const auto& sig = format_.signalFormats[i];
+        const SamplePlan& sample = samplePlans[i];
+        outSeries[i].name = sig.name;
+        outSeries[i].unit = sig.unit;
+        outSeries[i].timeOrigin = sample.byFrame ? 0.0 : sig.timeScale * static_cast<double>(recordBase + sample.phase);
+        outSeries[i].timeStep = sig.timeScale * sample.stride;
+        outSeries[i].values.resize(static_cast<qsizetype>(sample.sampleCount));
     }
+    QVector<double> timeAxis;
+    if (timestamp.enabled) timeAxis.resize(static_cast<qsizetype>(recordCount));
 
-    for (int recordIndex = 0; recordIndex < recordCount; ++recordIndex) {
-        const char* recordBase = buffer.constData() + recordIndex * format_.recordSize;
+    // 记录级有效位图，在解码同一块时顺带校验，记录仍在缓存中
+    const ChecksumField& checksum = format_.checksum;
+    QVector<quint64> recordValid;
+    if (checksum.enabled || layout.missingRecords > 0) recordValid = QVector<quint64>((recordCount + 63) / 64, ~quint64{0});
+    qint64 invalidRecords = 0;
+    // 失步区域折合的缺失记录只占序号，样本保持为零并标记无效，不参与绘图、统计与导出
+    if (layout.missingRecords > 0) {
+        qint64 expected = 0;
+        for (const RecordRun& run : layout.runs) {
+            for (qint64 record = expected; record < run.firstRecord; ++record) {
+                recordValid[record >> 6] &= ~(quint64{1} << (record & 63));
+            }
+            expected = run.firstRecord + run.count;
+        }
+    }
+
+    // 格式指纹命中 pat_codegen 生成的解码器时，走编译期确定偏移/类型的路径（仅全速率格式）
+    CompiledDecoder compiled;
+    const bool useCompiled = allFullRate && FindCompiledDecoder(format_, compiled);
+    std::vector<double*> columns(useCompiled ? signalCount : 0);
+
+    ForEachBlock(layout.runs, format_.recordSize, [&](qint64 first, qint64 count, qint64 runBias) {
+        const qint64 last = first + count;
+        const char* records = data + runBias + first * format_.recordSize;
+        if (checksum.enabled) invalidRecords += ValidateBlock(checksum, records, format_.recordSize, first, count, recordValid);
+        if (timestamp.enabled) {
+            DecodeColumnBlock(timestampPlan, records, format_.recordSize, count, timeAxis.data() + first);
+        }
+        if (useCompiled) {
+            for (int s = 0; s < signalCount; ++s) columns[s] = outSeries[s].values.data() + first;
+            compiled.decode(records, count, columns.data());
+            return;
+        }
         for (int s = 0; s < signalCount; ++s) {
-            const auto& sig = format_.signalFormats[s];
-            const int size = TypeSize(sig.valueType);
-            if (sig.byteOffset + size > format_.recordSize) {
-                errorMessage = QStringLiteral("信号 '%1' 超出记录长度").arg(sig.name);
-                return false;
+            SamplePlan& sample = samplePlans[s];
+            double* out = outSeries[s].values.data();
+            if (sample.FullRate()) {
+                DecodeColumnBlock(plans[s], records, format_.recordSize, count, out + first);
+            } else if (sample.byFrame) {
+                // 下标表有序，只取落在本块内的部分
+                const qint64 begin = sample.cursor;
+                qint64 end = begin;
+                while (end < sample.sampleCount && sample.records[end] < last) ++end;
+                GatherColumnBlock(plans[s], data, runBias, format_.recordSize, sample.records.constData() + begin, end - begin,
+                                  out + begin);
+                sample.cursor = end;
+            } else {
+                // 落在缺失记录上的样本不解码，从本块内的第一个样本开始
+                const qint64 begin = std::max(sample.cursor, first > sample.phase ? (first - sample.phase + sample.stride - 1) / sample.stride : 0);
+                const qint64 end = std::min(sample.sampleCount, (last - sample.phase + sample.stride - 1) / sample.stride);
+                if (end <= begin) continue;
+                const char* firstRecord = data + runBias + (sample.phase + begin * sample.stride) * format_.recordSize;
+                DecodeColumnBlock(plans[s], firstRecord, static_cast<qint64>(format_.recordSize) * sample.stride, end - begin, out + begin);
+                sample.cursor = end;
             }
-            double value{};
-            if (!DecodeValue(sig, recordBase, value)) {
-                errorMessage = QStringLiteral("信号 '%1' 类型不支持：%2").arg(sig.name, sig.valueType);
-                return false;
+        }
+    });
+
+    const bool anyInvalid = invalidRecords > 0 || layout.missingRecords > 0;
+    if (timestamp.enabled) {
+        // 部分加载时以文件首条记录为零点，窗口内显示的是文件内的绝对时间
+        const double originTick = partial ? RangeOriginTick(timestamp, timestampPlan, data, format_.recordSize, recordBase) : 0.0;
+        if (!BuildTimestampAxis(timestamp, anyInvalid ? &recordValid : nullptr, timeAxis, errorMessage,
+                                partial ? &originTick : nullptr)) {
+            outSeries.clear();
+            return false;
+        }
+    }
+    AssignTimeAxes(format_, samplePlans, timestamp.enabled ? &timeAxis : nullptr, outSeries, recordBase);
+    if (anyInvalid) AssignValidity(samplePlans, recordValid, outSeries);
+    if (report) report->invalidRecords = invalidRecords;
+
+    return true;
+}
+
+
+bool RecordParser::ParsePreview(const QString& path,
+                                qint64 maxRecords,
+                                QVector<Series>& outSeries,
+                                qint64& outRecordStep,
+                                QString& errorMessage,
+                                ParseReport* report) const {
+    const TraceScope trace("RecordParser::ParsePreview", "parse");
+    QVector<ColumnPlan> plans;
+    QVector<SamplePlan> samplePlans;
+    ColumnPlan timestampPlan;
+    bool allFullRate = true;
+    if (!BuildParsePlans(format_, plans, samplePlans, timestampPlan, allFullRate, errorMessage)) return false;
+    const TimestampField& timestamp = format_.timestamp;
+    const bool anyByFrame = std::any_of(samplePlans.cbegin(), samplePlans.cend(), [](const SamplePlan& p) { return p.byFrame; });
+    if (format_.syncWord.enabled || format_.recordTypes.enabled || anyByFrame || (timestamp.enabled && timestamp.rollover > 0.0)) {
+        errorMessage = QStringLiteral("该格式需要顺序扫描整个文件，不支持抽样预览");
+        return false;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorMessage = QStringLiteral("无法打开数据文件：%1").arg(path);
+        return false;
+    }
+    const qint64 fileSize = file.size();
+    const qint64 recordSize = format_.recordSize;
+    const qint64 recordCount = fileSize / recordSize;
+    if (recordCount <= 0) {
+        errorMessage = QStringLiteral("数据长度不足一个记录");
+        return false;
+    }
+    // 只能映射：映射后仅被取到的记录所在页会读入，readAll 会退化为整文件读取
+    const char* data = reinterpret_cast<const char*>(file.map(0, fileSize));
+    if (!data) {
+        errorMessage = QStringLiteral("无法映射数据文件，不支持抽样预览");
+        return false;
+    }
+    if (DetectDataCompression(format_, data, fileSize) != CompressionKind::None) {
+        errorMessage = QStringLiteral("压缩数据文件不支持抽样预览");
+        return false;
+    }
+
+    const qint64 step = std::max<qint64>(1, (recordCount + std::max<qint64>(1, maxRecords) - 1) / std::max<qint64>(1, maxRecords));
+    const int signalCount = static_cast<int>(format_.signalFormats.size());
+    double originTick = 0.0;
+    if (timestamp.enabled) DecodeColumnBlock(timestampPlan, data, recordSize, 1, &originTick);
+
+    // stride 信号按自身样本抽取：取样间隔取 step 向上对齐到 stride 的整数倍，phase 不变；
+    // 取样方式相同的信号共享时间列与校验位图
+    struct PreviewAxis {
+        qint64 sampleCount = 0;
+        Series axis;
+        QVector<quint64> validity;
+    };
+    QHash<QString, int> axisByKey;
+    std::vector<PreviewAxis> axes;
+    qint64 invalidRecords = 0;
+    outSeries.clear();
+    outSeries.resize(signalCount);
+    for (int s = 0; s < signalCount; ++s) {
+        const auto& sig = format_.signalFormats[s];
+        const SamplePlan& sample = samplePlans[s];
+        const qint64 recordStep = sample.stride * ((step + sample.stride - 1) / sample.stride);
+        const qint64 count = sample.phase < recordCount ? (recordCount - sample.phase + recordStep - 1) / recordStep : 0;
+        const char* firstRecord = data + sample.phase * recordSize;
+        Series& series = outSeries[s];
+        series.name = sig.name;
+        series.unit = sig.unit;
+        series.timeOrigin = sig.timeScale * sample.phase;
+        series.timeStep = sig.timeScale * recordStep;
+        series.values.resize(count);
+        DecodeColumnBlock(plans[s], firstRecord, recordSize * recordStep, count, series.values.data());
+
+        const QString key = QStringLiteral("%1/%2").arg(recordStep).arg(sample.phase);
+        int axisIndex = axisByKey.value(key, -1);
+        if (axisIndex < 0) {
+            PreviewAxis preview;
+            preview.sampleCount = count;
+            if (format_.checksum.enabled) {
+                preview.validity = QVector<quint64>((count + 63) / 64, ~quint64{0});
+                const qint64 invalid = ValidateBlock(format_.checksum, firstRecord, recordSize * recordStep, 0, count, preview.validity);
+                if (invalid == 0) preview.validity.clear();
+                invalidRecords = std::max(invalidRecords, invalid);  // 预览只能报告取到的记录中的失败数
+            }
+            if (timestamp.enabled) {
+                preview.axis.times.resize(count);
+                DecodeColumnBlock(timestampPlan, firstRecord, recordSize * recordStep, count, preview.axis.times.data());
+                if (!BuildTimestampAxis(timestamp, preview.validity.isEmpty() ? nullptr : &preview.validity, preview.axis.times,
+                                        errorMessage, &originTick)) {
+                    outSeries.clear();
+                    return false;
+                }
+                preview.axis.BuildTimeIndex();
+            }
+            axisIndex = static_cast<int>(axes.size());
+            axisByKey.insert(key, axisIndex);
+            axes.push_back(std::move(preview));
+        }
+        const PreviewAxis& preview = axes[static_cast<size_t>(axisIndex)];
+        series.validity = preview.validity;
+        if (timestamp.enabled) {
+            series.times = preview.axis.times;
+            series.timeIndex = preview.axis.timeIndex;
+            series.timeOrigin = 0.0;
+            if (series.times.size() > 1) {
+                series.timeStep = (series.times.last() - series.times.first()) / static_cast<double>(series.times.size() - 1);
+            }
+        }
+    }
+
+    outRecordStep = step;
+    if (report) {
+        report->recordCount = recordCount;
+        report->skippedBytes = 0;
+        report->gaps.clear();
+        report->invalidRecords = invalidRecords;
+    }
+    return true;
+}
+
+bool RecordParser::ResolveTimeWindow(const QString& path,
+                                     double startTime,
+                                     double endTime,
+                                     RecordRange& outRange,
+                                     QString& errorMessage) const {
+    QVector<ColumnPlan> plans;
+    QVector<SamplePlan> samplePlans;
+    ColumnPlan timestampPlan;
+    bool allFullRate = true;
+    if (!BuildParsePlans(format_, plans, samplePlans, timestampPlan, allFullRate, errorMessage)) return false;
+    if (format_.syncWord.enabled || format_.recordTypes.enabled) {
+        errorMessage = QStringLiteral("同步字与多记录类型格式无法按记录序号定位，不支持部分加载");
+        return false;
+    }
+    if (endTime < startTime) std::swap(startTime, endTime);
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorMessage = QStringLiteral("无法打开数据文件：%1").arg(path);
+        return false;
+    }
+    const qint64 fileSize = file.size();
+    const int recordSize = format_.recordSize;
+    const qint64 totalRecords = fileSize / recordSize;
+    const char* data = totalRecords > 0 ? reinterpret_cast<const char*>(file.map(0, fileSize)) : nullptr;
+    if (!data) {
+        errorMessage = totalRecords > 0 ? QStringLiteral("无法映射数据文件") : QStringLiteral("数据长度不足一个记录");
+        return false;
+    }
+    if (DetectDataCompression(format_, data, fileSize) != CompressionKind::None) {
+        errorMessage = QStringLiteral("压缩数据文件不支持部分加载");
+        return false;
+    }
+
+    qint64 first = 0;
+    qint64 end = 0;
+    const TimestampField& timestamp = format_.timestamp;
+    if (!timestamp.enabled) {
+        // 合成时间轴：第 r 条记录在信号 s 上的时间为 r × time_scale，取各信号覆盖时间窗的记录并集
+        first = totalRecords;
+        for (const auto& sig : format_.signalFormats) {
+            first = std::min(first, static_cast<qint64>(std::floor(std::max(0.0, startTime) / sig.timeScale)));
+            end = std::max(end, static_cast<qint64>(std::floor(std::max(0.0, endTime) / sig.timeScale)) + 1);
+        }
+    } else if (timestamp.rollover <= 0.0) {
+        // 计数单调，按计数二分查找
+        const double origin = LoadTick(timestampPlan, data);
+        const double lowTick = origin + startTime / timestamp.scale;
+        const double highTick = origin + endTime / timestamp.scale;
+        const auto lowerBound = [&](double tick, bool inclusive) {
+            qint64 lo = 0;
+            qint64 hi = totalRecords;
+            while (lo < hi) {
+                const qint64 mid = lo + (hi - lo) / 2;
+                const double value = LoadTick(timestampPlan, data + mid * recordSize);
+                if (inclusive ? value <= tick : value < tick) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
             }
-            outSeries[s].samples.append(QPointF(static_cast<double>(recordIndex) * sig.timeScale, value));
+            return lo;
+        };
+        first = lowerBound(lowTick, false);
+        end = lowerBound(highTick, true);
+    } else {
+        // 回绕计数无法二分，顺序展开计数列
+        const double origin = LoadTick(timestampPlan, data);
+        double previous = origin;
+        double wrapped = 0.0;
+        first = -1;
+        for (qint64 r = 0; r < totalRecords; ++r) {
+            const double tick = LoadTick(timestampPlan, data + r * recordSize);
+            if (tick < previous) wrapped += timestamp.rollover;
+            previous = tick;
+            const double time = (tick + wrapped - origin) * timestamp.scale;
+            if (first < 0 && time >= startTime) first = r;
+            if (time > endTime) {
+                end = r;
+                break;
+            }
+            end = r + 1;
         }
+        if (first < 0) first = totalRecords;
     }
 
+    first = std::clamp<qint64>(first, 0, totalRecords);
+    end = std::clamp<qint64>(end, first, totalRecords);
+    if (end <= first) {
+        errorMessage = QStringLiteral("时间窗内没有记录");
+        return false;
+    }
+    outRange.firstRecord = first;
+    outRange.recordCount = end - first;
     return true;
 }
 
@@ -1,26 +1,68 @@
-#pragma once
+﻿#pragma once
 
+#include "core/FileReader.h"
 #include "core/FormatDefinition.h"
+#include "core/Series.h"
+#include "core/SyncScanner.h"
 
-#include <QPointF>
 #include <QVector>
 
 namespace pat {
 
-struct Series {
-    QString name;
-    QString unit;
-    QVector<QPointF> samples;
+struct ParseReport {
+    qint64 recordCount = 0;
+    qint64 missingRecords = 0;  // 失步区域折合的缺失记录数，占用时间轴位置，样本标记为无效
+    qint64 skippedBytes = 0;
+    QVector<SyncGap> gaps;  // 同步字失步后跳过的区域
+    qint64 invalidRecords = 0;  // 校验失败的记录数，其样本在 Series::validity 中标记为无效
+};
+
+// 部分加载的记录范围 [firstRecord, firstRecord + recordCount)，recordCount < 0 表示到文件末尾
+struct RecordRange {
+    qint64 firstRecord = 0;
+    qint64 recordCount = -1;
+
+    bool IsFull() const { return firstRecord <= 0 && recordCount < 0; }
 };
 
 class RecordParser {
 public:
     explicit RecordParser(FormatDefinition format);
 
-    bool ParseFile(const QString& path, QVector<Series>& outSeries, QString& errorMessage) const;
+    // 默认整文件映射；批处理大量文件时可改用 Async，读取与解码重叠
+    void SetReadBackend(ReadBackend backend) { readBackend_ = backend; }
+
+    bool ParseFile(const QString& path,
+                   QVector<Series>& outSeries,
+                   QString& errorMessage,
+                   ParseReport* report = nullptr) const;
+
+    // 只解码指定记录范围：按 record_size 直接定位字节偏移，内存与耗时只与范围大小有关；
+    // 时间轴保持文件内的绝对时间。同步字、多记录类型与压缩文件无法定位，不支持部分加载
+    bool ParseRange(const QString& path,
+                    const RecordRange& range,
+                    QVector<Series>& outSeries,
+                    QString& errorMessage,
+                    ParseReport* report = nullptr) const;
+    // 时间窗换算为记录范围：有时间戳时按计数二分查找（回绕计数需顺序扫描计数列），否则按各信号 time_scale
+    bool ResolveTimeWindow(const QString& path,
+                           double startTime,
+                           double endTime,
+                           RecordRange& outRange,
+                           QString& errorMessage) const;
+
+    // 抽样预览：每 outRecordStep 条记录取一条（使总数不超过约 maxRecords），只访问被取到的记录，
+    // 耗时与预览规模成正比。同步字、多记录类型、帧 ID、回绕时间戳与压缩文件需要顺序扫描，不支持预览
+    bool ParsePreview(const QString& path,
+                      qint64 maxRecords,
+                      QVector<Series>& outSeries,
+                      qint64& outRecordStep,
+                      QString& errorMessage,
+                      ParseReport* report = nullptr) const;
 
 private:
     FormatDefinition format_;
+    ReadBackend readBackend_ = ReadBackend::Mmap;
 };
 
 }  // namespace pat
@@ -0,0 +1,237 @@
+﻿#include "core/RecordTypeIndex.h"
+
+#include "core/RawDecode.h"
+#include "core/TaskScheduler.h"
+#include "core/Trace.h"
+
+#include <QHash>
+
+#include <algorithm>
+
+namespace pat {
+namespace {
+
+constexpr qint64 kMinChunkBytes = 4 * 1024 * 1024;
+constexpr qint64 kDenseIdLimit = 1 << 16;
+
+// 类型 ID 到类型下标：ID 较小时用稠密表，否则用哈希
+class TypeLookup {
+public:
+    explicit TypeLookup(const RecordTypeTable& table) : idOffset_(table.idOffset) {
+        const QString t = table.idValueType;
+        idSize_ = (t == "int8" || t == "uint8") ? 1 : (t == "int16" || t == "uint16") ? 2 : 4;
+        signed_ = !t.startsWith(QStringLiteral("u"));
+        bool dense = true;
+        for (const auto& type : table.types) dense = dense && type.id >= 0 && type.id < kDenseIdLimit;
+        for (int i = 0; i < static_cast<int>(table.types.size()); ++i) {
+            const RecordType& type = table.types[static_cast<size_t>(i)];
+            sizes_.push_back(type.recordSize);
+            if (dense) {
+                if (type.id >= static_cast<qint64>(dense_.size())) dense_.resize(static_cast<size_t>(type.id + 1), -1);
+                dense_[static_cast<size_t>(type.id)] = i;
+            } else {
+                sparse_.insert(type.id, i);
+            }
+        }
+        useDense_ = dense;
+        minSize_ = table.MinRecordSize();
+    }
+
+    int MinSize() const { return minSize_; }
+
+    // 返回 pos 处记录的类型下标；ID 未知或记录超出文件时返回 -1
+    int TypeAt(const char* data, qint64 size, qint64 pos) const {
+        if (pos + minSize_ > size) return -1;
+        const qint64 id = ReadId(data + pos + idOffset_);
+        int slot = -1;
+        if (useDense_) {
+            if (id >= 0 && id < static_cast<qint64>(dense_.size())) slot = dense_[static_cast<size_t>(id)];
+        } else {
+            slot = sparse_.value(id, -1);
+        }
+        if (slot < 0 || pos + sizes_[static_cast<size_t>(slot)] > size) return -1;
+        return slot;
+    }
+
+    int SizeOf(int slot) const { return sizes_[static_cast<size_t>(slot)]; }
+
+private:
+    qint64 ReadId(const char* p) const {
+        switch (idSize_) {
+        case 1:
+            return signed_ ? static_cast<qint64>(ReadLittle<qint8>(p)) : static_cast<qint64>(ReadLittle<quint8>(p));
+        case 2:
+            return signed_ ? static_cast<qint64>(ReadLittle<qint16>(p)) : static_cast<qint64>(ReadLittle<quint16>(p));
+        default:
+            return signed_ ? static_cast<qint64>(ReadLittle<qint32>(p)) : static_cast<qint64>(ReadLittle<quint32>(p));
+        }
+    }
+
+    int idOffset_ = 0;
+    int idSize_ = 1;
+    bool signed_ = false;
+    bool useDense_ = true;
+    int minSize_ = 0;
+    std::vector<int> dense_;
+    QHash<qint64, int> sparse_;
+    std::vector<int> sizes_;
+};
+
+// 一个分块的遍历结果：positions 为记录起点，gaps 为逐字节跳过的区间；exit 为第一个 >= 块尾的位置
+struct ChunkWalk {
+    std::vector<qint64> positions;
+    QVector<SyncGap> gaps;
+    qint64 exit = 0;
+};
+
+void AppendGap(QVector<SyncGap>& gaps, qint64 pos, qint64 length) {
+    if (!gaps.isEmpty() && gaps.last().fileOffset + gaps.last().length == pos) {
+        gaps.last().length += length;
+    } else {
+        gaps.append(SyncGap{pos, length});
+    }
+}
+
+// 从 pos 遍历到 end；stopAt 非空时遇到其中已访问的位置即停止，返回停止位置（未命中时为块出口）
+qint64 Walk(const TypeLookup& lookup,
+            const char* data,
+            qint64 size,
+            qint64 pos,
+            qint64 end,
+            ChunkWalk& out,
+            const ChunkWalk* stopAt = nullptr,
+            bool* converged = nullptr) {
+    size_t cursor = 0;
+    qsizetype gapCursor = 0;
+    while (pos < end && pos < size) {
+        if (stopAt) {
+            // 两条遍历的位置都单调递增，游标只前进
+            while (cursor < stopAt->positions.size() && stopAt->positions[cursor] < pos) ++cursor;
+            while (gapCursor < stopAt->gaps.size() &&
+                   stopAt->gaps[gapCursor].fileOffset + stopAt->gaps[gapCursor].length <= pos) {
+                ++gapCursor;
+            }
+            const bool atRecord = cursor < stopAt->positions.size() && stopAt->positions[cursor] == pos;
+            const bool inGap = gapCursor < stopAt->gaps.size() && stopAt->gaps[gapCursor].fileOffset <= pos;
+            if (atRecord || inGap) {
+                *converged = true;
+                return pos;
+            }
+        }
+        const int slot = lookup.TypeAt(data, size, pos);
+        if (slot < 0) {
+            if (size - pos < lookup.MinSize()) {
+                AppendGap(out.gaps, pos, size - pos);  // 尾部不完整
+                pos = size;
+                break;
+            }
+            AppendGap(out.gaps, pos, 1);
+            ++pos;
+            continue;
+        }
+        out.positions.push_back(pos);
+        pos += lookup.SizeOf(slot);
+    }
+    out.exit = std::min(pos, size);
+    return out.exit;
+}
+
+}  // namespace
+
+RecordTypeIndex BuildRecordTypeIndex(const char* data, qint64 size, const RecordTypeTable& table) {
+    const TraceScope trace("BuildRecordTypeIndex", "parse");
+    RecordTypeIndex index;
+    index.offsets.resize(table.types.size());
+    if (!data || size <= 0 || table.types.empty()) return index;
+
+    const TypeLookup lookup(table);
+    TaskScheduler& scheduler = TaskScheduler::Instance();
+    const int threadCount = static_cast<int>(std::clamp<qint64>(size / kMinChunkBytes, 1, scheduler.WorkerCount() + 1));
+    const qint64 chunkBytes = (size + threadCount - 1) / threadCount;
+
+    // 第一遍：各块从块起点推测性遍历
+    std::vector<ChunkWalk> walks(static_cast<size_t>(threadCount));
+    scheduler.ParallelFor(0, threadCount, 1, [&](qint64 first, qint64 last) {
+        for (qint64 c = first; c < last; ++c) {
+            const qint64 begin = chunkBytes * c;
+            walks[static_cast<size_t>(c)].positions.reserve(static_cast<size_t>(chunkBytes / std::max(1, lookup.MinSize())));
+            Walk(lookup, data, size, begin, std::min(size, begin + chunkBytes), walks[static_cast<size_t>(c)]);
+        }
+    });
+
+    // 拼接：前一块的出口即本块真实的入口；入口不在推测遍历上时重走前缀直到重合
+    qint64 entry = walks[0].exit;
+    for (size_t c = 1; c < walks.size(); ++c) {
+        ChunkWalk& walk = walks[c];
+        const qint64 begin = chunkBytes * static_cast<qint64>(c);
+        const qint64 end = std::min(size, begin + chunkBytes);
+        if (entry >= end) {
+            // 上一块最后一条记录跨过了整个本块
+            walk.positions.clear();
+            walk.gaps.clear();
+            walk.exit = entry;
+            continue;
+        }
+        ChunkWalk prefix;
+        bool converged = false;
+        const qint64 meet = Walk(lookup, data, size, entry, end, prefix, &walk, &converged);
+        if (converged) {
+            // 丢弃推测遍历中 meet 之前的部分，换成重走的前缀
+            const auto first = std::lower_bound(walk.positions.begin(), walk.positions.end(), meet);
+            QVector<SyncGap> gaps = prefix.gaps;
+            for (const SyncGap& gap : walk.gaps) {
+                const qint64 gapEnd = gap.fileOffset + gap.length;
+                if (gapEnd <= meet) continue;
+                const qint64 from = std::max(gap.fileOffset, meet);
+                AppendGap(gaps, from, gapEnd - from);
+            }
+            prefix.positions.insert(prefix.positions.end(), first, walk.positions.end());
+            walk.positions = std::move(prefix.positions);
+            walk.gaps = std::move(gaps);
+        } else {
+            walk.positions = std::move(prefix.positions);
+            walk.gaps = std::move(prefix.gaps);
+            walk.exit = prefix.exit;
+        }
+        entry = walk.exit;
+    }
+
+    // 第二遍：按类型计数后并行分桶，每块写入各自预留的区间，结果保持文件顺序
+    const size_t typeCount = table.types.size();
+    std::vector<std::vector<qint64>> counts(walks.size(), std::vector<qint64>(typeCount, 0));
+    auto forEachChunk = [&](auto&& fn) {
+        scheduler.ParallelFor(0, static_cast<qint64>(walks.size()), 1, [&fn](qint64 first, qint64 last) {
+            for (qint64 c = first; c < last; ++c) fn(static_cast<size_t>(c));
+        });
+    };
+    forEachChunk([&](size_t c) {
+        for (const qint64 pos : walks[c].positions) ++counts[c][static_cast<size_t>(lookup.TypeAt(data, size, pos))];
+    });
+    std::vector<std::vector<qint64>> starts(walks.size(), std::vector<qint64>(typeCount, 0));
+    for (size_t t = 0; t < typeCount; ++t) {
+        qint64 total = 0;
+        for (size_t c = 0; c < walks.size(); ++c) {
+            starts[c][t] = total;
+            total += counts[c][t];
+        }
+        index.offsets[t].resize(total);
+        index.recordCount += total;
+    }
+    forEachChunk([&](size_t c) {
+        std::vector<qint64> cursor = starts[c];
+        for (const qint64 pos : walks[c].positions) {
+            const size_t t = static_cast<size_t>(lookup.TypeAt(data, size, pos));
+            index.offsets[t][cursor[t]++] = pos;
+        }
+    });
+
+    for (const auto& walk : walks) {
+        for (const SyncGap& gap : walk.gaps) {
+            AppendGap(index.gaps, gap.fileOffset, gap.length);
+            index.skippedBytes += gap.length;
+        }
+    }
+    return index;
+}
+
+}  // namespace pat
@@ -0,0 +1,24 @@
+﻿#pragma once
+
+#include "core/FormatDefinition.h"
+#include "core/SyncScanner.h"
+
+#include <QVector>
+
+#include <vector>
+
+namespace pat {
+
+// 多记录类型文件的首遍索引：按类型分桶的记录起始偏移（升序）
+struct RecordTypeIndex {
+    std::vector<QVector<qint64>> offsets;  // offsets[t] 对应 RecordTypeTable::types[t]
+    QVector<SyncGap> gaps;                 // 类型 ID 未知或尾部不完整而跳过的区间
+    qint64 recordCount = 0;
+    qint64 skippedBytes = 0;
+};
+
+// 记录边界依赖前一条记录的长度，各分块先从块起点推测性遍历，再按前一块的出口位置拼接：
+// 两条遍历一旦落在同一位置就会一直重合，未重合时只重走不重合的前缀
+RecordTypeIndex BuildRecordTypeIndex(const char* data, qint64 size, const RecordTypeTable& table);
+
+}  // namespace pat
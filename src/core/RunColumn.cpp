@@ -0,0 +1,45 @@
+﻿#include "core/RunColumn.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace pat {
+
+bool RunColumn::Encode(const QVector<double>& values, qsizetype maxRuns, RunColumn& out) {
+    out = RunColumn();
+    const qsizetype n = values.size();
+    const double* data = values.constData();
+    for (qsizetype i = 0; i < n;) {
+        if (static_cast<qsizetype>(out.runs_.size()) >= maxRuns) {
+            out = RunColumn();
+            return false;
+        }
+        const quint64 bits = std::bit_cast<quint64>(data[i]);
+        qsizetype j = i + 1;
+        while (j < n && std::bit_cast<quint64>(data[j]) == bits) ++j;
+        out.runs_.push_back(Run{i, j - i, data[i]});
+        i = j;
+    }
+    out.runs_.shrink_to_fit();
+    out.size_ = n;
+    return true;
+}
+
+qsizetype RunColumn::FindRun(qsizetype index) const {
+    const auto it = std::upper_bound(runs_.begin(), runs_.end(), static_cast<qint64>(index),
+                                     [](qint64 value, const Run& run) { return value < run.start; });
+    return static_cast<qsizetype>(it - runs_.begin()) - 1;
+}
+
+void RunColumn::Expand(qsizetype first, qsizetype count, double* out) const {
+    const qsizetype end = first + count;
+    for (qsizetype r = FindRun(first); first < end; ++r) {
+        const Run& run = runs_[static_cast<size_t>(r)];
+        const qsizetype stop = std::min<qsizetype>(end, run.start + run.length);
+        std::fill(out, out + (stop - first), run.value);
+        out += stop - first;
+        first = stop;
+    }
+}
+
+}  // namespace pat
@@ -0,0 +1,38 @@
+﻿#pragma once
+
+#include <QVector>
+
+#include <vector>
+
+namespace pat {
+
+// 游程编码列：长时间停在同一值的信号（挡位、模式字）只存 (start, length, value)。
+// 相等按位判断，-0.0 与 NaN 原样还原
+class RunColumn {
+public:
+    struct Run {
+        qint64 start = 0;
+        qint64 length = 0;
+        double value = 0.0;
+    };
+
+    // 游程数超过 maxRuns 时立即放弃并返回 false，变化频繁的信号只扫描开头一小段
+    static bool Encode(const QVector<double>& values, qsizetype maxRuns, RunColumn& out);
+
+    qsizetype Size() const { return size_; }
+    qint64 ByteSize() const { return static_cast<qint64>(runs_.size() * sizeof(Run)); }
+    qsizetype RunCount() const { return static_cast<qsizetype>(runs_.size()); }
+    const Run& RunAt(qsizetype run) const { return runs_[static_cast<size_t>(run)]; }
+    // 包含 index 的游程序号
+    qsizetype FindRun(qsizetype index) const;
+    double At(qsizetype index) const { return RunAt(FindRun(index)).value; }
+
+    // 把 [first, first + count) 展开到 out
+    void Expand(qsizetype first, qsizetype count, double* out) const;
+
+private:
+    qsizetype size_ = 0;
+    std::vector<Run> runs_;
+};
+
+}  // namespace pat
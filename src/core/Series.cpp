@@ -0,0 +1,197 @@
+﻿#include "core/Series.h"
+
+#include "core/ChunkStore.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace pat {
+namespace {
+
+static_assert(ChunkStore::kChunkSamples % Series::kTimeIndexStride == 0, "稀疏索引的区间须落在同一块内");
+
+// 游程列与单精度列按固定窗口展开给成批读取，窗口留在 L1/L2 中
+constexpr qsizetype kExpandWindowSamples = 4096;
+
+// 均匀时间轴先按公式估计，再按 TimeAt 校正，保证与逐点比较结果一致
+template <typename Less>
+qsizetype UniformBound(const Series& series, double t, Less less) {
+    const qsizetype n = series.Size();
+    if (n == 0) return 0;
+    double estimate = series.timeStep > 0.0 ? std::ceil((t - series.timeOrigin) / series.timeStep) : 0.0;
+    estimate = std::clamp(estimate, 0.0, static_cast<double>(n));
+    qsizetype index = static_cast<qsizetype>(estimate);
+    while (index > 0 && !less(series.TimeAt(index - 1), t)) --index;
+    while (index < n && less(series.TimeAt(index), t)) ++index;
+    return index;
+}
+
+// 先在稀疏索引上定位块，再在块内二分；块长固定，块内查找始终落在少数缓存行。
+// 外存模式下索引区间整体落在一个存储块内，只需换入该块
+template <typename Bound>
+qsizetype IndexedBound(const Series& series, double t, Bound bound) {
+    const qsizetype n = series.Size();
+    qsizetype begin = 0;
+    qsizetype end = n;
+    if (!series.timeIndex.isEmpty()) {
+        const double* index = series.timeIndex.constData();
+        const qsizetype block = bound(index, index + series.timeIndex.size(), t) - index;
+        begin = block > 0 ? (block - 1) * Series::kTimeIndexStride : 0;
+        end = std::min(n, block * Series::kTimeIndexStride);
+    }
+    if (!series.IsChunked()) {
+        const double* data = series.times.constData();
+        return bound(data + begin, data + end, t) - data;
+    }
+    if (begin >= end) return begin;
+    SeriesReader reader(series);
+    qsizetype first = 0;
+    qsizetype count = 0;
+    const double* chunk = reader.TimeSpan(begin, first, count);
+    if (!chunk) return begin;
+    end = std::min(end, first + count);
+    return first + (bound(chunk + (begin - first), chunk + (end - first), t) - chunk);
+}
+
+}  // namespace
+
+qsizetype Series::LowerBound(double t) const {
+    if (IsUniform()) {
+        return UniformBound(*this, t, [](double time, double value) { return time < value; });
+    }
+    return IndexedBound(*this, t, [](const double* first, const double* last, double value) {
+        return std::lower_bound(first, last, value);
+    });
+}
+
+qsizetype Series::UpperBound(double t) const {
+    if (IsUniform()) {
+        return UniformBound(*this, t, [](double time, double value) { return time <= value; });
+    }
+    return IndexedBound(*this, t, [](const double* first, const double* last, double value) {
+        return std::upper_bound(first, last, value);
+    });
+}
+
+void Series::BuildTimeIndex() {
+    timeIndex.clear();
+    if (IsUniform() || Size() <= kTimeIndexStride) return;
+    timeIndex.reserve((Size() + kTimeIndexStride - 1) / kTimeIndexStride);
+    if (!store) {
+        for (qsizetype i = 0; i < times.size(); i += kTimeIndexStride) timeIndex.append(times[i]);
+        return;
+    }
+    SeriesReader reader(*this);
+    for (qsizetype i = 0; i < Size(); i += kTimeIndexStride) timeIndex.append(reader.Time(i));
+}
+
+bool Series::SharesTimeAxis(const Series& other) const {
+    if (IsUniform() != other.IsUniform()) return false;
+    if (IsUniform()) return timeOrigin == other.timeOrigin && timeStep == other.timeStep;
+    if (store || other.store) return store == other.store && timeColumn == other.timeColumn;
+    return times.constData() == other.times.constData() || times == other.times;
+}
+
+double Series::StoredAt(int column, qsizetype index) const {
+    qsizetype first = 0;
+    qsizetype count = 0;
+    const double* chunk = store->Pin(column, index, first, count);
+    if (!chunk) return std::numeric_limits<double>::quiet_NaN();
+    const double value = chunk[index - first];
+    store->Unpin(column, index);
+    return value;
+}
+
+SeriesReader::SeriesReader(const Series& series) : series_(series) {
+    values_.column = series.valueColumn;
+    times_.column = series.timeColumn;
+}
+
+SeriesReader::~SeriesReader() {
+    Release(values_);
+    Release(times_);
+}
+
+const double* SeriesReader::ValueSpan(qsizetype index, qsizetype& outFirst, qsizetype& outCount) {
+    const double* data = values_.Contains(index) ? values_.data : Fetch(values_, series_.values, index);
+    outFirst = values_.first;
+    outCount = values_.count;
+    return data;
+}
+
+const double* SeriesReader::TimeSpan(qsizetype index, qsizetype& outFirst, qsizetype& outCount) {
+    const double* data = times_.Contains(index) ? times_.data : Fetch(times_, series_.times, index);
+    outFirst = times_.first;
+    outCount = times_.count;
+    return data;
+}
+
+double SeriesReader::Load(Window& window, qsizetype index) {
+    const double* data = Fetch(window, &window == &values_ ? series_.values : series_.times, index);
+    return data ? data[index - window.first] : std::numeric_limits<double>::quiet_NaN();
+}
+
+bool SeriesReader::ValueBlockSummary(qsizetype index,
+                                     qsizetype& outFirst,
+                                     qsizetype& outCount,
+                                     double& outMin,
+                                     double& outMax) const {
+    if (series_.runs) {
+        const RunColumn::Run& run = series_.runs->RunAt(series_.runs->FindRun(index));
+        outFirst = run.start;
+        outCount = run.length;
+        outMin = outMax = run.value;
+        return true;
+    }
+    if (!series_.packed) return false;
+    const qsizetype block = index / PackedColumn::kBlockSamples;
+    outFirst = block * PackedColumn::kBlockSamples;
+    outCount = series_.packed->BlockLength(block);
+    outMin = series_.packed->BlockMin(block);
+    outMax = series_.packed->BlockMax(block);
+    return true;
+}
+
+const double* SeriesReader::Fetch(Window& window, const QVector<double>& array, qsizetype index) {
+    if (series_.packed && &window == &values_) {
+        const qsizetype block = index / PackedColumn::kBlockSamples;
+        decoded_.resize(static_cast<size_t>(PackedColumn::kBlockSamples));
+        series_.packed->DecodeBlock(block, decoded_.data());
+        window.data = decoded_.data();
+        window.first = block * PackedColumn::kBlockSamples;
+        window.count = series_.packed->BlockLength(block);
+        return window.data;
+    }
+    if ((series_.runs || !series_.values32.isEmpty()) && &window == &values_) {
+        window.first = index / kExpandWindowSamples * kExpandWindowSamples;
+        window.count = std::min(kExpandWindowSamples, series_.Size() - window.first);
+        decoded_.resize(static_cast<size_t>(kExpandWindowSamples));
+        if (series_.runs) {
+            series_.runs->Expand(window.first, window.count, decoded_.data());
+        } else {
+            const float* source = series_.values32.constData() + window.first;
+            for (qsizetype k = 0; k < window.count; ++k) decoded_[static_cast<size_t>(k)] = static_cast<double>(source[k]);
+        }
+        window.data = decoded_.data();
+        return window.data;
+    }
+    if (!series_.store) {
+        window.data = array.constData();
+        window.first = 0;
+        window.count = array.size();
+        return window.data;
+    }
+    Release(window);
+    window.data = series_.store->Pin(window.column, index, window.first, window.count);
+    if (!window.data) window.count = 0;
+    return window.data;
+}
+
+void SeriesReader::Release(Window& window) {
+    if (series_.store && window.data) series_.store->Unpin(window.column, window.first);
+    window.data = nullptr;
+    window.count = 0;
+}
+
+}  // namespace pat
@@ -0,0 +1,144 @@
+﻿#pragma once
+
+#include "core/PackedColumn.h"
+#include "core/RunColumn.h"
+
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace pat {
+
+class ChunkStore;
+
+// 列式存储：数值列 + 时间轴。均匀采样时时间由 origin/step 隐式给出，
+// 非均匀采样时 times 与 values 等长且单调不减，timeIndex 为其稀疏索引。
+// 外存模式下 values/times 为空，样本存于 store 的列中；压缩列模式下 values 为空，样本存于 packed 或 runs；
+// 单精度存储时样本存于 values32。
+// 成批访问经 SeriesReader 按块读取。
+struct Series {
+    QString name;
+    QString unit;
+    double timeOrigin = 0.0;
+    double timeStep = 1.0;
+    QVector<double> times;
+    QVector<double> values;
+    QVector<float> values32;
+    QVector<double> timeIndex;  // times[k * kTimeIndexStride]
+    QVector<quint64> validity;  // 每样本 1 位，1 为有效（记录校验通过）；为空表示全部有效
+    std::shared_ptr<ChunkStore> store;
+    int valueColumn = -1;
+    int timeColumn = -1;  // 外存模式下 < 0 表示均匀时间轴
+    qsizetype storedSize = 0;
+    std::shared_ptr<const PackedColumn> packed;
+    std::shared_ptr<const RunColumn> runs;
+
+    static constexpr qsizetype kTimeIndexStride = 1024;
+
+    bool IsChunked() const { return store != nullptr; }
+    // values 为连续的 double 数组（可直接取指针）
+    bool IsPlain() const { return !store && !packed && !runs && values32.isEmpty(); }
+    qsizetype Size() const {
+        if (store) return storedSize;
+        if (packed) return packed->Size();
+        if (runs) return runs->Size();
+        return values32.isEmpty() ? values.size() : values32.size();
+    }
+    bool IsEmpty() const { return Size() == 0; }
+    bool IsUniform() const { return store ? timeColumn < 0 : times.isEmpty(); }
+    double TimeAt(qsizetype index) const {
+        if (IsUniform()) return timeOrigin + timeStep * static_cast<double>(index);
+        return store ? StoredAt(timeColumn, index) : times[index];
+    }
+    double ValueAt(qsizetype index) const {
+        if (store) return StoredAt(valueColumn, index);
+        if (packed) return packed->At(index);
+        if (runs) return runs->At(index);
+        return values32.isEmpty() ? values[index] : static_cast<double>(values32[index]);
+    }
+    QPointF PointAt(qsizetype index) const { return QPointF(TimeAt(index), ValueAt(index)); }
+    bool HasInvalid() const { return !validity.isEmpty(); }
+    bool IsValid(qsizetype index) const {
+        return validity.isEmpty() || ((validity[index >> 6] >> (index & 63)) & 1u) != 0;
+    }
+
+    // 第一个时间 >= t / > t 的下标
+    qsizetype LowerBound(double t) const;
+    qsizetype UpperBound(double t) const;
+
+    // times 赋值后调用；多个信号共享同一时间列时索引也可共享
+    void BuildTimeIndex();
+    bool SharesTimeAxis(const Series& other) const;
+
+private:
+    // 单点访问：每次固定并释放所在块，成批访问应改用 SeriesReader
+    double StoredAt(int column, qsizetype index) const;
+};
+
+// 按块访问样本的游标：外存模式下固定当前块，下标越出该块时才换入下一块；内存中的 Series 直接取数组。
+// 不可跨线程共享，每个线程各自构造
+class SeriesReader {
+public:
+    explicit SeriesReader(const Series& series);
+    ~SeriesReader();
+    SeriesReader(const SeriesReader&) = delete;
+    SeriesReader& operator=(const SeriesReader&) = delete;
+
+    double Value(qsizetype index) { return values_.Contains(index) ? values_.data[index - values_.first] : Load(values_, index); }
+    double Time(qsizetype index) {
+        if (series_.IsUniform()) return series_.timeOrigin + series_.timeStep * static_cast<double>(index);
+        return times_.Contains(index) ? times_.data[index - times_.first] : Load(times_, index);
+    }
+    QPointF Point(qsizetype index) { return QPointF(Time(index), Value(index)); }
+
+    // 返回包含 index 的连续片段（外存模式为一个块），outFirst/outCount 为片段覆盖的样本范围
+    const double* ValueSpan(qsizetype index, qsizetype& outFirst, qsizetype& outCount);
+    const double* TimeSpan(qsizetype index, qsizetype& outFirst, qsizetype& outCount);
+    // 压缩列不解码即可给出 index 所在块（游程列为所在游程）的范围与最小/最大值；其他存储返回 false
+    bool ValueBlockSummary(qsizetype index, qsizetype& outFirst, qsizetype& outCount, double& outMin, double& outMax) const;
+
+    // 把 [begin, end) 按片段交给 fn(first, const double* values, count)。
+    // fn 的 values 参数为泛型（const auto*）时，单精度列整段以 const float* 交出，不经展开
+    template <typename Fn>
+    void ForEachValueSpan(qsizetype begin, qsizetype end, Fn&& fn) {
+        if constexpr (std::is_invocable_v<Fn&, qsizetype, const float*, qsizetype>) {
+            if (!series_.values32.isEmpty()) {
+                if (begin < end) fn(begin, series_.values32.constData() + begin, end - begin);
+                return;
+            }
+        }
+        while (begin < end) {
+            qsizetype first = 0;
+            qsizetype count = 0;
+            const double* data = ValueSpan(begin, first, count);
+            const qsizetype stop = std::min(end, first + count);
+            if (!data || stop <= begin) return;
+            fn(begin, data + (begin - first), stop - begin);
+            begin = stop;
+        }
+    }
+
+private:
+    struct Window {
+        int column = -1;
+        const double* data = nullptr;
+        qsizetype first = 0;
+        qsizetype count = 0;
+        bool Contains(qsizetype index) const { return data && index >= first && index < first + count; }
+    };
+    double Load(Window& window, qsizetype index);
+    const double* Fetch(Window& window, const QVector<double>& array, qsizetype index);
+    void Release(Window& window);
+
+    const Series& series_;
+    Window values_;
+    Window times_;
+    std::vector<double> decoded_;  // 压缩列当前块 / 游程列与单精度列当前窗口的展开结果
+};
+
+}  // namespace pat
@@ -0,0 +1,312 @@
+﻿#include "core/SeriesExport.h"
+
+#include "core/ArrowExport.h"
+#include "core/Trace.h"
+
+#include <QByteArray>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+namespace pat {
+namespace {
+
+constexpr qsizetype kFlushThreshold = 1 << 20;
+constexpr int kMaxCsvField = 32;  // 分隔符 + %.15g 的最长输出
+constexpr char kBinaryMagic[4] = {'P', 'A', 'T', 'X'};
+constexpr quint32 kBinaryVersion = 1;
+constexpr qint64 kBinaryRowCountOffset = 12;
+
+struct ExportCursor {
+    const Series* series = nullptr;
+    std::shared_ptr<SeriesReader> reader;  // 外存模式下按块顺序换入
+    qsizetype index = 0;
+    qsizetype end = 0;
+    bool singlePrecision = false;  // 单精度存储的列，CSV 按 float 的最短往返表示写出，避免展宽后多出的尾数
+};
+
+// 行写出器：直接在预分配缓冲区里格式化，满 1 MiB 写盘一次
+class RowWriter {
+public:
+    RowWriter(QSaveFile& file, ExportFileFormat format, int columnCount) : file_(file), format_(format) {
+        const qsizetype rowBytes =
+            static_cast<qsizetype>(columnCount + 1) * (format == ExportFileFormat::Csv ? kMaxCsvField : 8) + 1;
+        buffer_.resize(kFlushThreshold + rowBytes);
+    }
+
+    bool WriteHeader(const QVector<ExportCursor>& cursors, QString& errorMessage) {
+        QByteArray header;
+        if (format_ == ExportFileFormat::Csv) {
+            header.append("time");
+            for (const auto& cursor : cursors) {
+                header.append(',');
+                AppendCsvField(header, cursor.series->name);
+            }
+            header.append('\n');
+        } else {
+            header.append(kBinaryMagic, sizeof(kBinaryMagic));
+            AppendLittle(header, kBinaryVersion);
+            AppendLittle(header, static_cast<quint32>(cursors.size()));
+            AppendLittle(header, quint64{0});  // 行数，结束时回填
+            for (const auto& cursor : cursors) {
+                AppendText(header, cursor.series->name);
+                AppendText(header, cursor.series->unit);
+            }
+        }
+        return WriteBytes(header.constData(), header.size(), errorMessage);
+    }
+
+    void BeginRow(double time) {
+        if (format_ == ExportFileFormat::Csv) {
+            pos_ = FormatNumber(time, 15);
+        } else {
+            StoreDouble(time);
+        }
+    }
+
+    void Value(double value, bool singlePrecision) {
+        if (format_ == ExportFileFormat::Csv) {
+            buffer_.data()[pos_++] = ',';
+            pos_ = singlePrecision ? FormatShortest(static_cast<float>(value)) : FormatNumber(value, 12);
+        } else {
+            StoreDouble(value);
+        }
+    }
+
+    void Missing() {
+        if (format_ == ExportFileFormat::Csv) {
+            buffer_.data()[pos_++] = ',';
+        } else {
+            StoreDouble(std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+
+    void EndRow() {
+        if (format_ == ExportFileFormat::Csv) buffer_.data()[pos_++] = '\n';
+        ++rows_;
+    }
+
+    bool NeedsFlush() const { return pos_ >= kFlushThreshold; }
+
+    bool Flush(QString& errorMessage) {
+        if (pos_ == 0) return true;
+        if (!WriteBytes(buffer_.constData(), pos_, errorMessage)) return false;
+        pos_ = 0;
+        return true;
+    }
+
+    bool Finish(QString& errorMessage) {
+        if (!Flush(errorMessage)) return false;
+        if (format_ != ExportFileFormat::Binary) return true;
+        uchar rowCount[8];
+        qToLittleEndian(static_cast<quint64>(rows_), rowCount);
+        const qint64 end = file_.pos();
+        if (!file_.seek(kBinaryRowCountOffset) ||
+            !WriteBytes(reinterpret_cast<const char*>(rowCount), sizeof(rowCount), errorMessage) || !file_.seek(end)) {
+            if (errorMessage.isEmpty()) errorMessage = QStringLiteral("回填行数失败：%1").arg(file_.errorString());
+            return false;
+        }
+        return true;
+    }
+
+private:
+    template <typename T>
+    static void AppendLittle(QByteArray& out, T value) {
+        uchar bytes[sizeof(T)];
+        qToLittleEndian(value, bytes);
+        out.append(reinterpret_cast<const char*>(bytes), sizeof(T));
+    }
+
+    static void AppendText(QByteArray& out, const QString& text) {
+        const QByteArray utf8 = text.toUtf8().left(std::numeric_limits<quint16>::max());
+        AppendLittle(out, static_cast<quint16>(utf8.size()));
+        out.append(utf8);
+    }
+
+    // RFC 4180：含分隔符、引号或换行的字段整体加引号，内部引号写成两个
+    static void AppendCsvField(QByteArray& out, const QString& text) {
+        const QByteArray utf8 = text.toUtf8();
+        if (utf8.indexOf(',') < 0 && utf8.indexOf('"') < 0 && utf8.indexOf('\n') < 0 && utf8.indexOf('\r') < 0) {
+            out.append(utf8);
+            return;
+        }
+        out.append('"');
+        for (const char ch : utf8) {
+            if (ch == '"') out.append('"');
+            out.append(ch);
+        }
+        out.append('"');
+    }
+
+    qsizetype FormatNumber(double value, int precision) {
+        char* first = buffer_.data() + pos_;
+        const auto result = std::to_chars(first, first + kMaxCsvField, value, std::chars_format::general, precision);
+        return result.ptr - buffer_.data();
+    }
+
+    qsizetype FormatShortest(float value) {
+        char* first = buffer_.data() + pos_;
+        const auto result = std::to_chars(first, first + kMaxCsvField, value);
+        return result.ptr - buffer_.data();
+    }
+
+    void StoreDouble(double value) {
+        quint64 bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        qToLittleEndian(bits, buffer_.data() + pos_);
+        pos_ += 8;
+    }
+
+    bool WriteBytes(const char* data, qint64 size, QString& errorMessage) {
+        if (file_.write(data, size) != size) {
+            errorMessage = QStringLiteral("写入导出文件失败：%1").arg(file_.errorString());
+            return false;
+        }
+        return true;
+    }
+
+    QSaveFile& file_;
+    ExportFileFormat format_;
+    QByteArray buffer_;
+    qsizetype pos_ = 0;
+    qint64 rows_ = 0;
+};
+
+// 所有信号共享同一时间轴且区间一致时，可按下标直接成行，无需归并
+bool SharesTimeAxis(const QVector<ExportCursor>& cursors) {
+    const ExportCursor& first = cursors.first();
+    for (const auto& cursor : cursors) {
+        if (!cursor.series->SharesTimeAxis(*first.series) || cursor.index != first.index || cursor.end != first.end) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+ExportFileFormat ExportFormatFromPath(const QString& path) {
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "patx" || suffix == "bin") return ExportFileFormat::Binary;
+    if (suffix == "arrow" || suffix == "feather" || suffix == "ipc") return ExportFileFormat::Arrow;
+    return ExportFileFormat::Csv;
+}
+
+bool ExportSeries(const QString& path,
+                  const QVector<Series>& series,
+                  const ExportOptions& options,
+                  QString& errorMessage,
+                  const ExportProgressCallback& progress) {
+    const TraceScope trace("ExportSeries", "export");
+    if (options.fileFormat == ExportFileFormat::Arrow) {
+        return ExportSeriesArrow(path, series, options, errorMessage, progress);
+    }
+
+    QVector<int> indices = options.signalIndices;
+    if (indices.isEmpty()) {
+        for (int i = 0; i < series.size(); ++i) indices.append(i);
+    }
+    if (indices.isEmpty()) {
+        errorMessage = QStringLiteral("没有可导出的信号");
+        return false;
+    }
+
+    QVector<ExportCursor> cursors;
+    cursors.reserve(indices.size());
+    qint64 totalSamples = 0;
+    for (int idx : indices) {
+        if (idx < 0 || idx >= series.size()) {
+            errorMessage = QStringLiteral("导出信号索引越界：%1").arg(idx);
+            return false;
+        }
+        ExportCursor cursor;
+        cursor.series = &series[idx];
+        cursor.reader = std::make_shared<SeriesReader>(series[idx]);
+        cursor.index = 0;
+        cursor.end = cursor.series->Size();
+        cursor.singlePrecision = !cursor.series->values32.isEmpty();
+        if (options.hasTimeWindow) {
+            cursor.index = cursor.series->LowerBound(options.startTime);
+            cursor.end = std::max(cursor.index, cursor.series->UpperBound(options.endTime));
+        }
+        totalSamples += cursor.end - cursor.index;
+        cursors.append(cursor);
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorMessage = QStringLiteral("无法写入导出文件：%1").arg(path);
+        return false;
+    }
+
+    RowWriter writer(file, options.fileFormat, static_cast<int>(cursors.size()));
+    if (!writer.WriteHeader(cursors, errorMessage)) return false;
+
+    qint64 doneSamples = 0;
+    auto flush = [&]() {
+        if (!writer.Flush(errorMessage)) return false;
+        if (progress && !progress(doneSamples, totalSamples)) {
+            errorMessage = QStringLiteral("导出已取消");
+            return false;
+        }
+        return true;
+    };
+
+    if (SharesTimeAxis(cursors)) {
+        const ExportCursor& axis = cursors.first();
+        for (qsizetype i = axis.index; i < axis.end; ++i) {
+            writer.BeginRow(axis.reader->Time(i));
+            for (const auto& cursor : cursors) {
+                if (cursor.series->IsValid(i)) {
+                    writer.Value(cursor.reader->Value(i), cursor.singlePrecision);
+                } else {
+                    writer.Missing();  // 校验失败的样本导出为空
+                }
+            }
+            writer.EndRow();
+            doneSamples += cursors.size();
+            if (writer.NeedsFlush() && !flush()) return false;
+        }
+    } else {
+        // 各信号时间轴不同，按时间多路归并，缺失的列留空
+        while (true) {
+            double rowTime = std::numeric_limits<double>::infinity();
+            for (const auto& cursor : cursors) {
+                if (cursor.index < cursor.end) rowTime = std::min(rowTime, cursor.reader->Time(cursor.index));
+            }
+            if (rowTime == std::numeric_limits<double>::infinity()) break;
+
+            writer.BeginRow(rowTime);
+            for (auto& cursor : cursors) {
+                if (cursor.index < cursor.end && cursor.reader->Time(cursor.index) == rowTime) {
+                    if (cursor.series->IsValid(cursor.index)) {
+                        writer.Value(cursor.reader->Value(cursor.index), cursor.singlePrecision);
+                    } else {
+                        writer.Missing();
+                    }
+                    ++cursor.index;
+                    ++doneSamples;
+                } else {
+                    writer.Missing();
+                }
+            }
+            writer.EndRow();
+            if (writer.NeedsFlush() && !flush()) return false;
+        }
+    }
+
+    if (!flush() || !writer.Finish(errorMessage)) return false;
+    if (!file.commit()) {
+        errorMessage = QStringLiteral("导出文件提交失败：%1").arg(file.errorString());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace pat
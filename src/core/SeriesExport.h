@@ -0,0 +1,39 @@
+﻿#pragma once
+
+#include "core/Series.h"
+
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+namespace pat {
+
+enum class ExportFileFormat {
+    Csv,
+    Binary,  // PATX：小端 float64 行式表，见 docs/design_log.md
+    Arrow,   // Arrow IPC 文件（Feather V2）
+};
+
+struct ExportOptions {
+    QVector<int> signalIndices;  // 为空时导出全部信号
+    bool hasTimeWindow = false;
+    double startTime = 0.0;
+    double endTime = 0.0;
+    ExportFileFormat fileFormat = ExportFileFormat::Csv;
+    QString timeUnit;                  // 写入元数据，可为空
+    bool implicitUniformTime = false;  // Arrow：均匀时间轴只写 origin/step 元数据，不写时间列
+};
+
+// 参数为已处理/总样本数；返回 false 取消导出
+using ExportProgressCallback = std::function<bool(qint64 doneSamples, qint64 totalSamples)>;
+
+ExportFileFormat ExportFormatFromPath(const QString& path);
+
+bool ExportSeries(const QString& path,
+                  const QVector<Series>& series,
+                  const ExportOptions& options,
+                  QString& errorMessage,
+                  const ExportProgressCallback& progress = ExportProgressCallback());
+
+}  // namespace pat
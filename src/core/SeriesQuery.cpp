@@ -0,0 +1,210 @@
+﻿#include "core/SeriesQuery.h"
+
+#include "core/Trace.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace pat {
+namespace {
+
+// 逐个样本更新最值与首次出现的下标；最值放在局部变量里，编译器可以全程留在寄存器中
+template <typename T>
+void ScanMinMaxScalar(const T* values, qsizetype first, qsizetype count, T& lo, qsizetype& loIndex, T& hi, qsizetype& hiIndex) {
+    for (qsizetype k = 0; k < count; ++k) {
+        if (values[k] < lo) {
+            lo = values[k];
+            loIndex = first + k;
+        }
+        if (values[k] > hi) {
+            hi = values[k];
+            hiIndex = first + k;
+        }
+    }
+}
+
+// 先按分段求各通道的最值（无分支，可向量化；单精度每条向量多装一倍样本），
+// 只有可能刷新当前最值的分段才逐个样本找下标。通道以当前最值起步，NaN 与逐个比较时一样被忽略
+template <typename T>
+void ScanMinMax(const T* values, qsizetype first, qsizetype count, double& minValue, qsizetype& minIndex, double& maxValue, qsizetype& maxIndex) {
+    constexpr int kLanes = static_cast<int>(64 / sizeof(T));
+    constexpr qsizetype kSegment = 256;
+    T lo = static_cast<T>(minValue);
+    T hi = static_cast<T>(maxValue);
+    qsizetype k = 0;
+    for (; k + kSegment <= count; k += kSegment) {
+        const T* segment = values + k;
+        T laneMin[kLanes];
+        T laneMax[kLanes];
+        for (int j = 0; j < kLanes; ++j) {
+            laneMin[j] = lo;
+            laneMax[j] = hi;
+        }
+        for (qsizetype i = 0; i < kSegment; i += kLanes) {
+            for (int j = 0; j < kLanes; ++j) {
+                const T x = segment[i + j];
+                laneMin[j] = x < laneMin[j] ? x : laneMin[j];
+                laneMax[j] = x > laneMax[j] ? x : laneMax[j];
+            }
+        }
+        bool update = false;
+        for (int j = 0; j < kLanes; ++j) update |= laneMin[j] < lo || laneMax[j] > hi;
+        if (update) ScanMinMaxScalar(segment, first + k, kSegment, lo, minIndex, hi, maxIndex);
+    }
+    ScanMinMaxScalar(values + k, first + k, count - k, lo, minIndex, hi, maxIndex);
+    minValue = static_cast<double>(lo);
+    maxValue = static_cast<double>(hi);
+}
+
+}  // namespace
+
+QVector<QPointF> DecimateSamples(const Series& series, double minX, double maxX, int maxPoints) {
+    const TraceScope trace("DecimateSamples", "query");
+    if (series.IsEmpty()) return {};
+    if (maxPoints <= 0) return {};
+    if (maxX < minX) std::swap(minX, maxX);
+
+    const qsizetype start = series.LowerBound(minX);
+    const qsizetype end = std::max(start, series.UpperBound(maxX));
+    const qsizetype count = end - start;
+    if (count <= 0) return {};
+
+    // 校验失败的样本不参与绘制
+    const bool checkValid = series.HasInvalid();
+    SeriesReader reader(series);
+    QVector<QPointF> out;
+    // 游程列：区间内的游程放得下时每段只输出首尾两点，连出的折线与逐点绘制相同
+    if (series.runs && !checkValid) {
+        const RunColumn& runs = *series.runs;
+        const qsizetype firstRun = runs.FindRun(start);
+        const qsizetype lastRun = runs.FindRun(end - 1);
+        if ((lastRun - firstRun + 1) * 2 <= maxPoints) {
+            out.reserve((lastRun - firstRun + 1) * 2);
+            for (qsizetype r = firstRun; r <= lastRun; ++r) {
+                const RunColumn::Run& run = runs.RunAt(r);
+                const qsizetype head = std::max<qsizetype>(start, run.start);
+                const qsizetype tail = std::min<qsizetype>(end, run.start + run.length) - 1;
+                out.append(QPointF(reader.Time(head), run.value));
+                if (tail != head) out.append(QPointF(reader.Time(tail), run.value));
+            }
+            return out;
+        }
+    }
+    if (count <= maxPoints) {
+        out.reserve(count);
+        for (qsizetype i = start; i < end; ++i) {
+            if (!checkValid || series.IsValid(i)) out.append(reader.Point(i));
+        }
+        return out;
+    }
+
+    const int bucketCount = std::max(1, maxPoints / 2);
+    const double span = maxX - minX;
+    const double bucketSize = span > 0.0 ? span / bucketCount : 1.0;
+
+    out.reserve(maxPoints);
+    if (!checkValid || series.IsValid(start)) out.append(reader.Point(start));
+    qsizetype b0 = start;
+    for (int b = 0; b < bucketCount; ++b) {
+        const double bx0 = minX + bucketSize * b;
+        const double bx1 = (b == bucketCount - 1) ? maxX : (bx0 + bucketSize);
+        b0 = std::max(b0, series.LowerBound(bx0));
+        const qsizetype b1 = std::clamp(series.LowerBound(bx1), b0, end);
+        if (b0 == b1) continue;
+        qsizetype minIndex = b0;
+        qsizetype maxIndex = b0;
+        if (!checkValid) {
+            // 压缩列先看块头（游程列为整段游程）：常量块的最值就是块内首个样本，不可能刷新当前最值的块整块跳过，都不解码
+            qsizetype blockFirst = 0;
+            qsizetype blockCount = 0;
+            double blockMin = 0.0;
+            double blockMax = 0.0;
+            const bool constantHead = reader.ValueBlockSummary(b0, blockFirst, blockCount, blockMin, blockMax) && blockMin == blockMax;
+            double minValue = constantHead ? blockMin : reader.Value(b0);
+            double maxValue = minValue;
+            for (qsizetype i = b0; i < b1;) {
+                qsizetype stop = b1;
+                if (reader.ValueBlockSummary(i, blockFirst, blockCount, blockMin, blockMax)) {
+                    stop = std::min(b1, blockFirst + blockCount);
+                    if (blockMin == blockMax || (blockMin >= minValue && blockMax <= maxValue)) {
+                        if (blockMin < minValue) {
+                            minValue = blockMin;
+                            minIndex = i;
+                        }
+                        if (blockMax > maxValue) {
+                            maxValue = blockMax;
+                            maxIndex = i;
+                        }
+                        i = stop;
+                        continue;
+                    }
+                }
+                reader.ForEachValueSpan(i, stop, [&](qsizetype first, const auto* values, qsizetype count) {
+                    ScanMinMax(values, first, count, minValue, minIndex, maxValue, maxIndex);
+                });
+                i = stop;
+            }
+        } else {
+            minIndex = maxIndex = -1;
+            double minValue = 0.0;
+            double maxValue = 0.0;
+            reader.ForEachValueSpan(b0, b1, [&](qsizetype first, const auto* values, qsizetype count) {
+                for (qsizetype k = 0; k < count; ++k) {
+                    if (!series.IsValid(first + k)) continue;
+                    if (minIndex < 0 || values[k] < minValue) {
+                        minValue = values[k];
+                        minIndex = first + k;
+                    }
+                    if (maxIndex < 0 || values[k] > maxValue) {
+                        maxValue = values[k];
+                        maxIndex = first + k;
+                    }
+                }
+            });
+            if (minIndex < 0) {
+                b0 = b1;
+                continue;
+            }
+        }
+        const qsizetype first = std::min(minIndex, maxIndex);
+        const qsizetype second = std::max(minIndex, maxIndex);
+        out.append(reader.Point(first));
+        if (second != first) out.append(reader.Point(second));
+        b0 = b1;
+        if (out.size() >= maxPoints) break;
+    }
+    if (!checkValid || series.IsValid(end - 1)) out.append(reader.Point(end - 1));
+    return out;
+}
+
+bool InterpolateSample(const Series& series, double x, double& outValue) {
+    if (series.IsEmpty()) return false;
+
+    const qsizetype n = series.Size();
+    const double seriesMinX = series.TimeAt(0);
+    const double seriesMaxX = series.TimeAt(n - 1);
+    if (x < seriesMinX) x = seriesMinX;
+    if (x > seriesMaxX) x = seriesMaxX;
+
+    // 在两侧最近的有效样本之间插值；全部无效时不给值
+    qsizetype hi = series.LowerBound(x);
+    qsizetype lo = hi - 1;
+    while (hi < n && !series.IsValid(hi)) ++hi;
+    while (lo >= 0 && !series.IsValid(lo)) --lo;
+    if (lo < 0 && hi >= n) return false;
+    if (lo < 0) {
+        outValue = series.ValueAt(hi);
+    } else if (hi >= n) {
+        outValue = series.ValueAt(lo);
+    } else {
+        const double x0 = series.TimeAt(lo);
+        const double x1 = series.TimeAt(hi);
+        const double y0 = series.ValueAt(lo);
+        const double y1 = series.ValueAt(hi);
+        const double dx = x1 - x0;
+        outValue = dx == 0.0 ? y1 : (y0 + (y1 - y0) * (x - x0) / dx);
+    }
+    return true;
+}
+
+}  // namespace pat
@@ -0,0 +1,13 @@
+﻿#pragma once
+
+#include "core/Series.h"
+
+#include <QPointF>
+#include <QVector>
+
+namespace pat {
+
+QVector<QPointF> DecimateSamples(const Series& series, double minX, double maxX, int maxPoints);
+bool InterpolateSample(const Series& series, double x, double& outValue);
+
+}  // namespace pat
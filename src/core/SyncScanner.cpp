@@ -0,0 +1,97 @@
+﻿#include "core/SyncScanner.h"
+
+#include "core/Trace.h"
+
+#include <cstring>
+
+namespace pat {
+namespace {
+
+class SyncMatcher {
+public:
+    SyncMatcher(const char* data, qint64 size, int recordSize, const QByteArray& pattern, int syncOffset)
+        : data_(data),
+          size_(size),
+          recordSize_(recordSize),
+          pattern_(pattern.constData()),
+          patternSize_(pattern.size()),
+          syncOffset_(syncOffset) {}
+
+    // pos 处存在一条完整且同步字正确的记录
+    bool RecordAt(qint64 pos) const {
+        if (pos < 0 || pos + recordSize_ > size_) return false;
+        return std::memcmp(data_ + pos + syncOffset_, pattern_, static_cast<size_t>(patternSize_)) == 0;
+    }
+
+    // 从 from 起寻找下一个可确认的记录起点，找不到返回 -1
+    qint64 Resync(qint64 from) const {
+        const char first = pattern_[0];
+        qint64 cursor = from + syncOffset_;
+        const qint64 limit = size_ - recordSize_ + syncOffset_;
+        while (cursor <= limit) {
+            const void* hit = std::memchr(data_ + cursor, first, static_cast<size_t>(limit - cursor + 1));
+            if (!hit) return -1;
+            const qint64 candidate = static_cast<const char*>(hit) - data_ - syncOffset_;
+            if (RecordAt(candidate)) {
+                const qint64 next = candidate + recordSize_;
+                if (next + recordSize_ > size_ || RecordAt(next)) return candidate;
+            }
+            cursor = candidate + syncOffset_ + 1;
+        }
+        return -1;
+    }
+
+private:
+    const char* data_;
+    qint64 size_;
+    int recordSize_;
+    const char* pattern_;
+    qsizetype patternSize_;
+    int syncOffset_;
+};
+
+}  // namespace
+
+SyncScanResult ScanSyncRecords(const char* data, qint64 size, int recordSize, const QByteArray& pattern, int syncOffset) {
+    const TraceScope trace("ScanSyncRecords", "parse");
+    SyncScanResult result;
+    if (!data || recordSize <= 0 || pattern.isEmpty() || syncOffset < 0 || syncOffset + pattern.size() > recordSize) {
+        return result;
+    }
+
+    const SyncMatcher matcher(data, size, recordSize, pattern, syncOffset);
+    // 其后还有记录的区域按字节数折合成缺失记录，四舍五入：插入几个字节不占序号，丢失整条记录占一个
+    auto addGap = [&result, recordSize](qint64 offset, qint64 length, bool occupiesRecords) {
+        if (length <= 0) return;
+        const qint64 missing = occupiesRecords ? (length + recordSize / 2) / recordSize : 0;
+        result.gaps.append(SyncGap{offset, length, missing});
+        result.skippedBytes += length;
+        result.recordCount += missing;
+        result.missingRecords += missing;
+    };
+
+    qint64 pos = 0;
+    while (pos + recordSize <= size) {
+        if (!matcher.RecordAt(pos)) {
+            const qint64 next = matcher.Resync(pos + 1);
+            if (next < 0) break;
+            addGap(pos, next - pos, true);
+            pos = next;
+        }
+
+        // 同步状态下连续校验，直到失步或到达文件尾
+        RecordRun run;
+        run.fileOffset = pos;
+        run.firstRecord = result.recordCount;
+        while (pos + recordSize <= size && matcher.RecordAt(pos)) {
+            pos += recordSize;
+            ++run.count;
+        }
+        result.recordCount += run.count;
+        result.runs.append(run);
+    }
+    addGap(pos, size - pos, false);
+    return result;
+}
+
+}  // namespace pat
@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include <QByteArray>
+#include <QVector>
+
+namespace pat {
+
+// 文件中连续排布的一段完整记录；firstRecord 为全局记录序号。
+// 跳过的区域按字节数折合成缺失记录占用序号，合成时间轴（序号 × time_scale）在失步之后仍与文件对齐
+struct RecordRun {
+    qint64 fileOffset = 0;
+    qint64 firstRecord = 0;
+    qint64 count = 0;
+};
+
+// 失步后跳过的字节区间
+struct SyncGap {
+    qint64 fileOffset = 0;
+    qint64 length = 0;
+    qint64 missingRecords = 0;  // 占用的记录序号数：round(length / recordSize)
+};
+
+struct SyncScanResult {
+    QVector<RecordRun> runs;
+    QVector<SyncGap> gaps;
+    qint64 recordCount = 0;     // 记录序号总数，含缺失记录
+    qint64 missingRecords = 0;  // 跳过区域折合的缺失记录数
+    qint64 skippedBytes = 0;
+};
+
+// 同步字位于每条记录的 syncOffset 处。同步正常时按记录长度逐条校验；
+// 失步后用 memchr 搜索同步字首字节，并要求下一条记录同样同步才确认重新锁定
+SyncScanResult ScanSyncRecords(const char* data, qint64 size, int recordSize, const QByteArray& pattern, int syncOffset);
+
+}  // namespace pat
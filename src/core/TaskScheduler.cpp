@@ -0,0 +1,267 @@
+﻿#include "core/TaskScheduler.h"
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
+
+namespace pat {
+namespace {
+
+// 当前线程所属的任务池与工作线程序号
+thread_local const TaskScheduler* currentScheduler = nullptr;
+thread_local int currentWorkerIndex = -1;
+// 当前线程正在执行的任务所属的组，新建的组以它为父组
+thread_local const TaskGroup* currentGroup = nullptr;
+
+}  // namespace
+
+QString TaskPriorityName(TaskPriority priority) {
+    switch (priority) {
+        case TaskPriority::Interactive:
+            return QStringLiteral("interactive");
+        case TaskPriority::Normal:
+            return QStringLiteral("normal");
+        case TaskPriority::Background:
+            return QStringLiteral("background");
+    }
+    return QStringLiteral("normal");
+}
+
+CancellationToken::CancellationToken() : cancelled_(std::make_shared<std::atomic<bool>>(false)) {}
+
+void CancellationToken::Cancel() const {
+    cancelled_->store(true, std::memory_order_relaxed);
+}
+
+bool CancellationToken::IsCancelled() const {
+    return cancelled_->load(std::memory_order_relaxed);
+}
+
+qint64 TaskSchedulerStats::QueuedTotal() const {
+    qint64 total = 0;
+    for (const qint64 count : queued) total += count;
+    return total;
+}
+
+double TaskSchedulerStats::StealRate() const {
+    return executed > 0 ? static_cast<double>(stolen) / static_cast<double>(executed) : 0.0;
+}
+
+TaskScheduler& TaskScheduler::Instance() {
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+TaskScheduler::TaskScheduler(int workerCount) {
+    if (workerCount <= 0) workerCount = std::max(1, QThread::idealThreadCount() - 1);
+    workers_.reserve(static_cast<size_t>(workerCount));
+    for (int i = 0; i < workerCount; ++i) workers_.push_back(std::make_unique<Worker>());
+    threads_.reserve(static_cast<size_t>(workerCount));
+    for (int i = 0; i < workerCount; ++i) threads_.emplace_back([this, i]() { WorkerLoop(i); });
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        QMutexLocker locker(&sleepMutex_);
+        stopping_ = true;
+        wake_.wakeAll();
+    }
+    for (auto& thread : threads_) thread.join();
+}
+
+int TaskScheduler::CurrentWorker() const {
+    return currentScheduler == this ? currentWorkerIndex : -1;
+}
+
+void TaskScheduler::Submit(std::function<void()> task, TaskPriority priority) {
+    Enqueue(Task{std::move(task), nullptr}, priority);
+}
+
+void TaskScheduler::Enqueue(Task task, TaskPriority priority) {
+    const int self = CurrentWorker();
+    const size_t target = self >= 0 ? static_cast<size_t>(self)
+                                    : nextWorker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    const auto level = static_cast<size_t>(priority);
+    {
+        Worker& worker = *workers_[target];
+        QMutexLocker locker(&worker.mutex);
+        worker.queues[level].push_back(std::move(task));
+        queued_[level].fetch_add(1, std::memory_order_relaxed);
+    }
+    QMutexLocker locker(&sleepMutex_);
+    wake_.wakeOne();
+}
+
+bool TaskScheduler::TakeTask(int self, const TaskGroup* scope, Task& outTask) {
+    const auto inScope = [scope](const Task& task) {
+        return scope == nullptr || (task.group != nullptr && task.group->IsWithin(scope));
+    };
+    const int count = static_cast<int>(workers_.size());
+    for (size_t level = 0; level < queued_.size(); ++level) {
+        if (queued_[level].load(std::memory_order_relaxed) <= 0) continue;
+        // 自己的队列从队尾取（刚派生的子任务，数据还在缓存里），其他队列从队首窃取
+        if (self >= 0) {
+            Worker& own = *workers_[static_cast<size_t>(self)];
+            QMutexLocker locker(&own.mutex);
+            auto& queue = own.queues[level];
+            const auto found = std::find_if(queue.rbegin(), queue.rend(), inScope);
+            if (found != queue.rend()) {
+                outTask = std::move(*found);
+                queue.erase(std::next(found).base());
+                queued_[level].fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        const int start = self >= 0 ? self + 1 : 0;
+        for (int k = 0; k < count; ++k) {
+            const int victim = (start + k) % count;
+            if (victim == self) continue;
+            Worker& other = *workers_[static_cast<size_t>(victim)];
+            QMutexLocker locker(&other.mutex);
+            auto& queue = other.queues[level];
+            const auto found = std::find_if(queue.begin(), queue.end(), inScope);
+            if (found == queue.end()) continue;
+            outTask = std::move(*found);
+            queue.erase(found);
+            queued_[level].fetch_sub(1, std::memory_order_relaxed);
+            stolen_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::WorkerLoop(int index) {
+    currentScheduler = this;
+    currentWorkerIndex = index;
+    Task task;
+    while (true) {
+        if (TakeTask(index, nullptr, task)) {
+            task.run();
+            task = Task{};
+            executed_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        QMutexLocker locker(&sleepMutex_);
+        if (stopping_) return;
+        // 入队在加锁唤醒之前完成，这里看到计数为零后再等待不会错过唤醒
+        bool pending = false;
+        for (const auto& count : queued_) pending = pending || count.load(std::memory_order_relaxed) > 0;
+        if (!pending) wake_.wait(&sleepMutex_);
+    }
+}
+
+TaskSchedulerStats TaskScheduler::Stats() const {
+    TaskSchedulerStats stats;
+    stats.workerCount = WorkerCount();
+    for (size_t level = 0; level < queued_.size(); ++level) {
+        stats.queued[level] = std::max<qint64>(0, queued_[level].load(std::memory_order_relaxed));
+    }
+    stats.executed = executed_.load(std::memory_order_relaxed);
+    stats.stolen = stolen_.load(std::memory_order_relaxed);
+    stats.cancelled = cancelled_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool TaskScheduler::ParallelFor(qint64 begin,
+                                qint64 end,
+                                qint64 grain,
+                                const std::function<void(qint64, qint64)>& body,
+                                TaskPriority priority,
+                                const CancellationToken& token) {
+    if (end <= begin) return !token.IsCancelled();
+    const qint64 count = end - begin;
+    // 自动切分时每个线程约 4 块，给窃取留出余地
+    if (grain <= 0) grain = std::max<qint64>(1, count / (static_cast<qint64>(WorkerCount() + 1) * 4));
+    if (count <= grain) {
+        if (token.IsCancelled()) return false;
+        body(begin, end);
+        return !token.IsCancelled();
+    }
+    TaskGroup group(priority, token, *this);
+    for (qint64 first = begin; first < end; first += grain) {
+        const qint64 last = std::min(end, first + grain);
+        group.Run([&body, first, last]() { body(first, last); });
+    }
+    return group.Wait();
+}
+
+TaskGroup::TaskGroup(TaskPriority priority, const CancellationToken& token, TaskScheduler& scheduler)
+    : scheduler_(scheduler), parent_(currentGroup), priority_(priority), token_(token) {}
+
+TaskGroup::~TaskGroup() {
+    try {
+        Wait();
+    } catch (...) {
+        // 析构中不再抛出；需要异常的调用方应显式 Wait
+    }
+}
+
+void TaskGroup::Run(std::function<void()> task) {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    auto run = [this, task = std::move(task)]() {
+        if (token_.IsCancelled()) {
+            scheduler_.cancelled_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            const TaskGroup* outer = currentGroup;
+            currentGroup = this;
+            try {
+                task();
+            } catch (...) {
+                QMutexLocker locker(&mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+            currentGroup = outer;
+        }
+        Finish();
+    };
+    // 入队与唤醒都在组锁内：任务要取同一把锁才能完成，组在这里不会被析构；
+    // 其他线程可能正在 Wait 中休眠，唤醒它来执行新任务
+    QMutexLocker locker(&mutex_);
+    scheduler_.Enqueue(TaskScheduler::Task{std::move(run), this}, priority_);
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    done_.wakeAll();
+}
+
+bool TaskGroup::IsWithin(const TaskGroup* scope) const {
+    for (const TaskGroup* group = this; group != nullptr; group = group->parent_) {
+        if (group == scope) return true;
+    }
+    return false;
+}
+
+// 计数在锁内递减：Wait 返回前要取同一把锁，组不会在这里唤醒的途中被析构
+void TaskGroup::Finish() {
+    QMutexLocker locker(&mutex_);
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) done_.wakeAll();
+}
+
+bool TaskGroup::Wait() {
+    const int self = scheduler_.CurrentWorker();
+    TaskScheduler::Task task;
+    while (pending_.load(std::memory_order_acquire) > 0) {
+        const qint64 submitted = submitted_.load(std::memory_order_relaxed);
+        if (scheduler_.TakeTask(self, this, task)) {
+            task.run();
+            task = TaskScheduler::Task{};
+            scheduler_.executed_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        // 本组及子组没有排队的任务，余下的都在其他线程上执行（子组由创建它的线程自己等待），
+        // 休眠到最后一个任务完成或本组又加入新任务
+        QMutexLocker locker(&mutex_);
+        if (pending_.load(std::memory_order_acquire) > 0 && submitted_.load(std::memory_order_relaxed) == submitted) {
+            done_.wait(&mutex_);
+        }
+    }
+    std::exception_ptr error;
+    {
+        QMutexLocker locker(&mutex_);
+        std::swap(error, error_);
+    }
+    if (error) std::rethrow_exception(error);
+    return !token_.IsCancelled();
+}
+
+}  // namespace pat
@@ -0,0 +1,141 @@
+﻿#pragma once
+
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace pat {
+
+// 数值越小越优先：交互（图表抽稀）先于普通（加载、压缩）先于后台（统计）
+enum class TaskPriority { Interactive, Normal, Background };
+constexpr int kTaskPriorityCount = 3;
+
+QString TaskPriorityName(TaskPriority priority);
+
+// 可复制的取消标志，副本共享同一状态
+class CancellationToken {
+public:
+    CancellationToken();
+
+    void Cancel() const;
+    bool IsCancelled() const;
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+struct TaskSchedulerStats {
+    int workerCount = 0;
+    std::array<qint64, kTaskPriorityCount> queued{};  // 各优先级排队中的任务数
+    qint64 executed = 0;
+    qint64 stolen = 0;     // 从其他线程的队列取走执行的任务
+    qint64 cancelled = 0;  // 开始前已取消而跳过的任务
+
+    qint64 QueuedTotal() const;
+    double StealRate() const;
+};
+
+// 进程内共享的任务池：每个工作线程按优先级各有一个双端队列，自己从队尾取，空闲时从其他线程的队首窃取；
+// 取任务时总是先看更高优先级，交互任务在后台任务的分块之间插队。
+// 等待任务组的线程（含非工作线程）在等待期间只执行本组及其子组的任务，嵌套并行不会占满线程而死锁，
+// 也不会把无关的任务（如另一个文件的加载）嵌进自己的调用栈
+class TaskGroup;
+
+class TaskScheduler {
+public:
+    static TaskScheduler& Instance();
+
+    // workerCount <= 0 时取 CPU 核数减一（调用线程在等待时也参与执行）
+    explicit TaskScheduler(int workerCount = 0);
+    ~TaskScheduler();
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    int WorkerCount() const { return static_cast<int>(threads_.size()); }
+    void Submit(std::function<void()> task, TaskPriority priority = TaskPriority::Normal);
+    TaskSchedulerStats Stats() const;
+
+    // 把 [begin, end) 按 grain 切块并行执行 body(first, last)，返回前等待全部完成；
+    // grain <= 0 时按线程数自动切分。取消后未开始的块不再执行，返回 false。块内抛出的异常在此重新抛出
+    bool ParallelFor(qint64 begin,
+                     qint64 end,
+                     qint64 grain,
+                     const std::function<void(qint64, qint64)>& body,
+                     TaskPriority priority = TaskPriority::Normal,
+                     const CancellationToken& token = CancellationToken());
+
+private:
+    friend class TaskGroup;
+
+    struct Task {
+        std::function<void()> run;
+        const TaskGroup* group = nullptr;  // 所属任务组，直接 Submit 的任务为空
+    };
+
+    struct Worker {
+        QMutex mutex;
+        std::array<std::deque<Task>, kTaskPriorityCount> queues;
+    };
+
+    void Enqueue(Task task, TaskPriority priority);
+    void WorkerLoop(int index);
+    // 取一个任务，优先级高的先取；scope 非空时只取属于该组或其子组的任务。
+    // self 为调用者所在工作线程，非工作线程为 -1
+    bool TakeTask(int self, const TaskGroup* scope, Task& outTask);
+    int CurrentWorker() const;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::array<std::atomic<qint64>, kTaskPriorityCount> queued_{};
+    std::atomic<qint64> executed_{0};
+    std::atomic<qint64> stolen_{0};
+    std::atomic<qint64> cancelled_{0};
+    std::atomic<unsigned> nextWorker_{0};
+    QMutex sleepMutex_;
+    QWaitCondition wake_;
+    bool stopping_ = false;
+};
+
+// 一组同优先级的任务，Wait 等待全部完成。析构时自动等待。
+// 在某组的任务内创建的组是该组的子组，Wait 时可以代为执行
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskPriority priority = TaskPriority::Normal,
+                       const CancellationToken& token = CancellationToken(),
+                       TaskScheduler& scheduler = TaskScheduler::Instance());
+    ~TaskGroup();
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void Run(std::function<void()> task);
+    // 取消时返回 false；任务抛出的第一个异常在此重新抛出
+    bool Wait();
+    const CancellationToken& Token() const { return token_; }
+
+private:
+    friend class TaskScheduler;
+
+    void Finish();
+    bool IsWithin(const TaskGroup* scope) const;
+
+    TaskScheduler& scheduler_;
+    const TaskGroup* parent_;  // 创建时所在任务的组；子组总在父组的任务内构造和析构，指针在其生存期内有效
+    TaskPriority priority_;
+    CancellationToken token_;
+    std::atomic<qint64> pending_{0};
+    std::atomic<qint64> submitted_{0};  // Run 的次数，Wait 据此判断休眠前是否有新任务入队
+    QMutex mutex_;
+    QWaitCondition done_;
+    std::exception_ptr error_;
+};
+
+}  // namespace pat
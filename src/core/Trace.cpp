@@ -0,0 +1,122 @@
+﻿#include "core/Trace.h"
+
+#include <QByteArray>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+#include <chrono>
+
+namespace pat {
+namespace {
+
+// 线程按首次记录的先后编号，Chrome 按 tid 分行显示
+std::atomic<int> nextThreadNumber{1};
+thread_local int threadNumber = 0;
+
+int CurrentThreadNumber() {
+    if (threadNumber == 0) threadNumber = nextThreadNumber.fetch_add(1, std::memory_order_relaxed);
+    return threadNumber;
+}
+
+void AppendJsonString(QByteArray& out, const char* text) {
+    out.append('"');
+    for (const char* p = text; p && *p; ++p) {
+        if (*p == '"' || *p == '\\') out.append('\\');
+        out.append(*p);
+    }
+    out.append('"');
+}
+
+// trace_event 的时间单位为微秒
+void AppendMicroseconds(QByteArray& out, qint64 ns) {
+    out.append(QByteArray::number(ns / 1000));
+    out.append('.');
+    out.append(QByteArray::number(ns % 1000).rightJustified(3, '0'));
+}
+
+}  // namespace
+
+std::atomic<bool> TraceRecorder::enabled_{false};
+
+TraceRecorder& TraceRecorder::Instance() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+qint64 TraceRecorder::NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TraceRecorder::Start() {
+    QMutexLocker locker(&mutex_);
+    spans_.clear();
+    dropped_ = 0;
+    originNs_ = NowNs();
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void TraceRecorder::Stop() {
+    enabled_.store(false, std::memory_order_relaxed);
+}
+
+qsizetype TraceRecorder::SpanCount() const {
+    QMutexLocker locker(&mutex_);
+    return static_cast<qsizetype>(spans_.size());
+}
+
+qint64 TraceRecorder::DroppedSpans() const {
+    QMutexLocker locker(&mutex_);
+    return dropped_;
+}
+
+void TraceRecorder::Record(const char* name, const char* category, qint64 startNs, qint64 endNs) {
+    const int thread = CurrentThreadNumber();
+    QMutexLocker locker(&mutex_);
+    // 区间跨过了停止或重新开始，丢弃
+    if (!IsEnabled() || startNs < originNs_) return;
+    if (static_cast<qsizetype>(spans_.size()) >= kMaxSpans) {
+        ++dropped_;
+        return;
+    }
+    spans_.push_back(Span{name, category, startNs - originNs_, endNs - startNs, thread});
+}
+
+bool TraceRecorder::WriteChromeJson(const QString& path, QString& errorMessage) const {
+    QByteArray out;
+    {
+        QMutexLocker locker(&mutex_);
+        out.reserve(static_cast<qsizetype>(spans_.size()) * 96 + 256);
+        out.append("{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_spans\":");
+        out.append(QByteArray::number(dropped_));
+        out.append("},\"traceEvents\":[\n");
+        for (size_t i = 0; i < spans_.size(); ++i) {
+            const Span& span = spans_[i];
+            if (i > 0) out.append(",\n");
+            out.append("{\"name\":");
+            AppendJsonString(out, span.name);
+            out.append(",\"cat\":");
+            AppendJsonString(out, span.category);
+            out.append(",\"ph\":\"X\",\"ts\":");
+            AppendMicroseconds(out, span.startNs);
+            out.append(",\"dur\":");
+            AppendMicroseconds(out, span.durationNs);
+            out.append(",\"pid\":1,\"tid\":");
+            out.append(QByteArray::number(span.thread));
+            out.append('}');
+        }
+        out.append("\n]}\n");
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorMessage = QStringLiteral("无法写入跟踪文件：%1").arg(path);
+        return false;
+    }
+    if (file.write(out) != out.size() || !file.commit()) {
+        errorMessage = QStringLiteral("写入跟踪文件失败：%1").arg(path);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace pat
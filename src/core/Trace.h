@@ -0,0 +1,67 @@
+﻿#pragma once
+
+#include <QMutex>
+#include <QString>
+
+#include <atomic>
+#include <vector>
+
+namespace pat {
+
+// 性能跟踪：热点路径上的作用域计时，导出为 Chrome trace_event JSON（chrome://tracing 或 Perfetto 打开）。
+// 未在采集时 TraceScope 只读一次原子标志，不取时间、不加锁
+class TraceRecorder {
+public:
+    // 单次采集最多保留的区间数，超出的丢弃并计数
+    static constexpr qsizetype kMaxSpans = 1000000;
+
+    static TraceRecorder& Instance();
+    static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+    static qint64 NowNs();
+
+    // 开始时清空上一次的记录
+    void Start();
+    void Stop();
+    qsizetype SpanCount() const;
+    qint64 DroppedSpans() const;
+
+    // name、category 须为字符串字面量，只保存指针
+    void Record(const char* name, const char* category, qint64 startNs, qint64 endNs);
+    bool WriteChromeJson(const QString& path, QString& errorMessage) const;
+
+private:
+    struct Span {
+        const char* name = nullptr;
+        const char* category = nullptr;
+        qint64 startNs = 0;
+        qint64 durationNs = 0;
+        int thread = 0;
+    };
+
+    TraceRecorder() = default;
+
+    static std::atomic<bool> enabled_;
+    mutable QMutex mutex_;
+    std::vector<Span> spans_;
+    qint64 originNs_ = 0;
+    qint64 dropped_ = 0;
+};
+
+// 作用域计时：构造时采集已开始才取起始时间，析构时记录一个区间
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, const char* category = "core")
+        : name_(name), category_(category), startNs_(TraceRecorder::IsEnabled() ? TraceRecorder::NowNs() : -1) {}
+    ~TraceScope() {
+        if (startNs_ >= 0) TraceRecorder::Instance().Record(name_, category_, startNs_, TraceRecorder::NowNs());
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    const char* category_;
+    qint64 startNs_;
+};
+
+}  // namespace pat
@@ -0,0 +1,492 @@
+﻿#include "synth/SyntheticRecording.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStringList>
+#include <QThread>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <thread>
+
+namespace pat {
+namespace {
+
+constexpr double kTwoPi = 6.283185307179586476925286766559;
+constexpr qint64 kWriteChunkBytes = 8ll * 1024 * 1024;
+constexpr qint64 kMinRecordsPerThread = 4096;
+constexpr qint64 kMinCompressSliceBytes = 1ll * 1024 * 1024;
+constexpr quint64 kNoiseSalt = 0x243F6A8885A308D3ull;
+constexpr quint64 kStepSalt = 0x13198A2E03707344ull;
+constexpr quint64 kSpikeSalt = 0xA4093822299F31D0ull;
+constexpr quint64 kSpikeSignSalt = 0x082EFA98EC4E6C89ull;
+
+quint64 SplitMix64(quint64& state) {
+    quint64 z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+double UniformFromBits(quint64 bits) {
+    return static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);
+}
+
+struct WeightedName {
+    QString name;
+    int weight = 0;
+};
+
+bool ParseWeightedList(const QString& mix,
+                       const QStringList& allowed,
+                       const QString& what,
+                       std::vector<WeightedName>& outEntries,
+                       int& outTotalWeight,
+                       QString& errorMessage) {
+    outEntries.clear();
+    outTotalWeight = 0;
+    const QStringList parts = mix.split(',', Qt::SkipEmptyParts);
+    for (const auto& part : parts) {
+        const QStringList kv = part.split(':');
+        WeightedName entry;
+        entry.name = kv.value(0).trimmed().toLower();
+        bool ok = true;
+        entry.weight = kv.size() > 1 ? kv.value(1).trimmed().toInt(&ok) : 1;
+        if (!allowed.contains(entry.name) || !ok || entry.weight < 0) {
+            errorMessage = QStringLiteral("%1非法：%2").arg(what, part);
+            return false;
+        }
+        if (entry.weight > 0) {
+            outTotalWeight += entry.weight;
+            outEntries.push_back(entry);
+        }
+    }
+    if (outEntries.empty()) {
+        errorMessage = QStringLiteral("%1为空").arg(what);
+        return false;
+    }
+    return true;
+}
+
+const WeightedName& PickWeighted(const std::vector<WeightedName>& entries, int totalWeight, quint64& rng) {
+    int pick = static_cast<int>(SplitMix64(rng) % static_cast<quint64>(totalWeight));
+    for (const auto& entry : entries) {
+        if (pick < entry.weight) return entry;
+        pick -= entry.weight;
+    }
+    return entries.front();
+}
+
+int TypeSize(const QString& type) {
+    if (type == "int16" || type == "uint16") return 2;
+    if (type == "int32" || type == "uint32" || type == "float32") return 4;
+    return 8;
+}
+
+template <typename T>
+void StoreLittle(T value, char* out) {
+    qToLittleEndian(value, out);
+}
+
+template <typename T>
+T ClampRound(double raw) {
+    const double lo = static_cast<double>(std::numeric_limits<T>::min());
+    const double hi = static_cast<double>(std::numeric_limits<T>::max());
+    return static_cast<T>(std::clamp(std::round(raw), lo, hi));
+}
+
+}  // namespace
+
+bool SyntheticRecording::Configure(const SyntheticSpec& spec, QString& errorMessage) {
+    if (spec.signalCount <= 0) {
+        errorMessage = QStringLiteral("信号数必须 > 0");
+        return false;
+    }
+    if (spec.timeScale <= 0.0) {
+        errorMessage = QStringLiteral("time_scale 必须 > 0");
+        return false;
+    }
+    if (spec.groupCount < 0 || spec.spikeRate < 0.0 || spec.spikeRate > 1.0) {
+        errorMessage = QStringLiteral("分组数或尖峰概率非法");
+        return false;
+    }
+
+    std::vector<WeightedName> types;
+    int typeWeight = 0;
+    const QStringList typeNames = {QStringLiteral("int16"), QStringLiteral("uint16"), QStringLiteral("int32"),
+                                   QStringLiteral("uint32"), QStringLiteral("float32"), QStringLiteral("float64")};
+    if (!ParseWeightedList(spec.typeMix, typeNames, QStringLiteral("类型配比"), types, typeWeight, errorMessage)) {
+        return false;
+    }
+    std::vector<WeightedName> patterns;
+    int patternWeight = 0;
+    const QStringList patternNames = {QStringLiteral("sine"), QStringLiteral("steps"), QStringLiteral("noise"),
+                                      QStringLiteral("spikes")};
+    if (!ParseWeightedList(spec.patternMix, patternNames, QStringLiteral("波形配比"), patterns, patternWeight,
+                           errorMessage)) {
+        return false;
+    }
+
+    spec_ = spec;
+    plans_.assign(static_cast<size_t>(spec.signalCount), SignalPlan{});
+    quint64 rng = spec.seed;
+
+    // 每个顶层分组下再挂两条总线子分组，另留一个槽位给不分组的独立信号
+    constexpr int kSlotsPerGroup = 3;
+    QJsonArray groupsArray;
+    for (int g = 0; g < spec.groupCount; ++g) {
+        const QString top = QStringLiteral("Sys%1").arg(g, 2, 10, QChar('0'));
+        groupsArray.append(QJsonObject{{QStringLiteral("path"), top},
+                                       {QStringLiteral("description"), QStringLiteral("合成子系统 %1").arg(g)}});
+        for (int k = 1; k < kSlotsPerGroup; ++k) {
+            groupsArray.append(QJsonObject{{QStringLiteral("path"), QStringLiteral("%1/Bus%2").arg(top).arg(k)},
+                                           {QStringLiteral("description"), QStringLiteral("总线 %1").arg(k)}});
+        }
+    }
+
+    static const char* const kUnits[] = {"V", "A", "deg", "m/s", "kPa", "degC", "rpm", "g"};
+    static const char* const kTimeUnits[] = {"s", "ms", "us"};
+    static const double kTimeFactors[] = {1.0, 1e3, 1e6};
+
+    QJsonArray signalsArray;
+    int offset = 0;
+    for (int i = 0; i < spec.signalCount; ++i) {
+        const WeightedName& type = PickWeighted(types, typeWeight, rng);
+        const WeightedName& pattern = PickWeighted(patterns, patternWeight, rng);
+        const int size = TypeSize(type.name);
+
+        offset = (offset + size - 1) / size * size;
+        auto& plan = plans_[static_cast<size_t>(i)];
+        plan.offset = offset;
+        offset += size;
+
+        plan.amplitude = 1.0 + UniformFromBits(SplitMix64(rng)) * 999.0;
+        plan.center = (UniformFromBits(SplitMix64(rng)) * 2.0 - 1.0) * plan.amplitude;
+        plan.phase = UniformFromBits(SplitMix64(rng)) * kTwoPi;
+        const double periodRecords = 50.0 + UniformFromBits(SplitMix64(rng)) * 20000.0;
+        plan.angularStep = kTwoPi / periodRecords;
+        plan.holdRecords = 100 + static_cast<qint64>(UniformFromBits(SplitMix64(rng)) * 50000.0);
+        const double noiseFraction = UniformFromBits(SplitMix64(rng));
+        if (pattern.name == "sine") {
+            plan.pattern = Pattern::Sine;
+            plan.noise = plan.amplitude * 0.05 * noiseFraction;
+        } else if (pattern.name == "steps") {
+            plan.pattern = Pattern::Steps;
+        } else if (pattern.name == "noise") {
+            plan.pattern = Pattern::Noise;
+        } else {
+            plan.pattern = Pattern::Spikes;
+            plan.noise = plan.amplitude * 0.01;
+        }
+
+        // 所有波形都落在 center ± (amplitude + noise) 内，量程留 10% 余量
+        const double span = (plan.amplitude + plan.noise) * 1.1;
+        if (type.name == "int16") {
+            plan.type = RawType::Int16;
+            plan.bias = plan.center;
+            plan.scale = span / 32767.0;
+        } else if (type.name == "uint16") {
+            plan.type = RawType::UInt16;
+            plan.bias = plan.center - span;
+            plan.scale = 2.0 * span / 65535.0;
+        } else if (type.name == "int32") {
+            plan.type = RawType::Int32;
+            plan.bias = plan.center;
+            plan.scale = span / 2147483647.0;
+        } else if (type.name == "uint32") {
+            plan.type = RawType::UInt32;
+            plan.bias = plan.center - span;
+            plan.scale = 2.0 * span / 4294967295.0;
+        } else if (type.name == "float32") {
+            plan.type = RawType::Float32;
+        } else {
+            plan.type = RawType::Float64;
+        }
+
+        QJsonObject sig;
+        sig.insert(QStringLiteral("name"), QStringLiteral("s%1").arg(i, 4, 10, QChar('0')));
+        sig.insert(QStringLiteral("description"), pattern.name);
+        sig.insert(QStringLiteral("byte_offset"), plan.offset);
+        sig.insert(QStringLiteral("value_type"), type.name);
+        sig.insert(QStringLiteral("scale"), plan.scale);
+        sig.insert(QStringLiteral("bias"), plan.bias);
+        const int timeUnitIndex = spec.mixedTimeUnits ? static_cast<int>(SplitMix64(rng) % 3) : 0;
+        sig.insert(QStringLiteral("time_scale"), spec.timeScale * kTimeFactors[timeUnitIndex]);
+        if (spec.mixedTimeUnits) sig.insert(QStringLiteral("time_unit"), QString::fromLatin1(kTimeUnits[timeUnitIndex]));
+        sig.insert(QStringLiteral("unit"), QString::fromLatin1(kUnits[SplitMix64(rng) % std::size(kUnits)]));
+        if (spec.groupCount > 0) {
+            const int slot = static_cast<int>(SplitMix64(rng) % static_cast<quint64>(spec.groupCount * kSlotsPerGroup + 1));
+            if (slot < spec.groupCount * kSlotsPerGroup) {
+                const QString top = QStringLiteral("Sys%1").arg(slot / kSlotsPerGroup, 2, 10, QChar('0'));
+                const int bus = slot % kSlotsPerGroup;
+                sig.insert(QStringLiteral("group"), bus == 0 ? top : QStringLiteral("%1/Bus%2").arg(top).arg(bus));
+            }
+        }
+        signalsArray.append(sig);
+    }
+
+    const int packedSize = (offset + 7) / 8 * 8;
+    int recordSize = spec.recordSize > 0 ? spec.recordSize : packedSize;
+    if (recordSize < offset) {
+        errorMessage = QStringLiteral("record_size %1 小于信号所需的 %2 字节").arg(recordSize).arg(offset);
+        return false;
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("record_size"), recordSize);
+    root.insert(QStringLiteral("endianness"), QStringLiteral("little"));
+    root.insert(QStringLiteral("time_unit"), QStringLiteral("s"));
+    root.insert(QStringLiteral("signals"), signalsArray);
+    if (!groupsArray.isEmpty()) root.insert(QStringLiteral("groups"), groupsArray);
+    formatJson_ = QJsonDocument(root).toJson(QJsonDocument::Indented);
+
+    if (!LoadFormatFromJsonData(formatJson_, format_, errorMessage)) return false;
+    recordCount_ = std::max<qint64>(1, spec.fileBytes / recordSize);
+    return true;
+}
+
+void SyntheticRecording::FillRecords(qint64 firstRecord, qint64 count, char* out) const {
+    std::memset(out, 0, static_cast<size_t>(count * format_.recordSize));
+    for (int s = 0; s < static_cast<int>(plans_.size()); ++s) {
+        FillSignal(s, firstRecord, count, out);
+    }
+}
+
+void SyntheticRecording::FillSignal(int signalIndex, qint64 firstRecord, qint64 count, char* out) const {
+    const int recordSize = format_.recordSize;
+    const auto& plan = plans_[static_cast<size_t>(signalIndex)];
+    char* dst = out + plan.offset;
+
+    switch (plan.pattern) {
+    case Pattern::Sine: {
+        // 以旋转递推代替逐点 sin，块起点重新取精确相位
+        const double angle = plan.phase + plan.angularStep * static_cast<double>(firstRecord);
+        double sinValue = std::sin(angle);
+        double cosValue = std::cos(angle);
+        const double stepSin = std::sin(plan.angularStep);
+        const double stepCos = std::cos(plan.angularStep);
+        for (qint64 r = 0; r < count; ++r) {
+            double value = plan.center + plan.amplitude * sinValue;
+            if (plan.noise != 0.0) {
+                value += (HashUniform(signalIndex, firstRecord + r, kNoiseSalt) * 2.0 - 1.0) * plan.noise;
+            }
+            EncodeValue(plan, value, dst);
+            dst += recordSize;
+            const double nextSin = sinValue * stepCos + cosValue * stepSin;
+            cosValue = cosValue * stepCos - sinValue * stepSin;
+            sinValue = nextSin;
+        }
+        break;
+    }
+    case Pattern::Steps: {
+        // 16 档电平，保持随机时长，产生大段常量
+        qint64 segment = -1;
+        char encoded[8] = {};
+        for (qint64 r = 0; r < count; ++r) {
+            const qint64 current = (firstRecord + r) / plan.holdRecords;
+            if (current != segment) {
+                segment = current;
+                const double level = std::floor(HashUniform(signalIndex, segment, kStepSalt) * 16.0) / 7.5 - 1.0;
+                EncodeValue(plan, plan.center + plan.amplitude * level, encoded);
+            }
+            std::memcpy(dst, encoded, static_cast<size_t>(TypeSizeOf(plan.type)));
+            dst += recordSize;
+        }
+        break;
+    }
+    case Pattern::Noise:
+        for (qint64 r = 0; r < count; ++r) {
+            const double u = HashUniform(signalIndex, firstRecord + r, kNoiseSalt);
+            EncodeValue(plan, plan.center + plan.amplitude * (u * 2.0 - 1.0), dst);
+            dst += recordSize;
+        }
+        break;
+    case Pattern::Spikes:
+        for (qint64 r = 0; r < count; ++r) {
+            const qint64 record = firstRecord + r;
+            double value = plan.center + (HashUniform(signalIndex, record, kNoiseSalt) * 2.0 - 1.0) * plan.noise;
+            if (HashUniform(signalIndex, record, kSpikeSalt) < spec_.spikeRate) {
+                value += HashUniform(signalIndex, record, kSpikeSignSalt) < 0.5 ? -plan.amplitude : plan.amplitude;
+            }
+            EncodeValue(plan, value, dst);
+            dst += recordSize;
+        }
+        break;
+    }
+}
+
+void SyntheticRecording::ParallelFill(qint64 firstRecord, qint64 count, char* out) const {
+    const qint64 byThreads = count / kMinRecordsPerThread;
+    const int threadCount = static_cast<int>(std::clamp<qint64>(byThreads, 1, QThread::idealThreadCount()));
+    if (threadCount == 1) {
+        FillRecords(firstRecord, count, out);
+        return;
+    }
+
+    const qint64 perThread = (count + threadCount - 1) / threadCount;
+    std::vector<std::thread> workers;
+    workers.reserve(static_cast<size_t>(threadCount - 1));
+    for (int t = 1; t < threadCount; ++t) {
+        const qint64 begin = perThread * t;
+        const qint64 part = std::min(perThread, count - begin);
+        if (part <= 0) break;
+        workers.emplace_back([this, firstRecord, begin, part, out]() {
+            FillRecords(firstRecord + begin, part, out + begin * format_.recordSize);
+        });
+    }
+    FillRecords(firstRecord, std::min(perThread, count), out);
+    for (auto& worker : workers) worker.join();
+}
+
+bool SyntheticRecording::WriteFormatFile(const QString& path, QString& errorMessage) const {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorMessage = QStringLiteral("无法写入格式文件：%1").arg(path);
+        return false;
+    }
+    file.write(formatJson_);
+    if (!file.commit()) {
+        errorMessage = QStringLiteral("格式文件写入失败：%1").arg(file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool SyntheticRecording::WriteDataFile(const QString& path,
+                                       QString& errorMessage,
+                                       const ProgressCallback& progress,
+                                       CompressionKind compression) const {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorMessage = QStringLiteral("无法写入数据文件：%1").arg(path);
+        return false;
+    }
+
+    // 双缓冲：后台生成下一块的同时写出当前块，生成侧按记录区间多线程填充
+    const qint64 recordSize = format_.recordSize;
+    const qint64 chunkRecords = std::max<qint64>(1, kWriteChunkBytes / recordSize);
+    const qint64 totalBytes = recordCount_ * recordSize;
+    QByteArray buffers[2];
+    for (auto& buffer : buffers) buffer.resize(static_cast<qsizetype>(chunkRecords * recordSize));
+
+    auto fill = [this, chunkRecords, &buffers](int slot, qint64 first) {
+        ParallelFill(first, std::min(chunkRecords, recordCount_ - first), buffers[slot].data());
+    };
+    std::future<void> pending = std::async(std::launch::async, fill, 0, 0);
+    int slot = 0;
+    for (qint64 first = 0; first < recordCount_; first += chunkRecords, slot ^= 1) {
+        pending.get();
+        const qint64 next = first + chunkRecords;
+        if (next < recordCount_) pending = std::async(std::launch::async, fill, slot ^ 1, next);
+
+        const qint64 bytes = std::min(chunkRecords, recordCount_ - first) * recordSize;
+        if (compression != CompressionKind::None) {
+            QByteArray compressed;
+            if (!CompressChunk(compression, buffers[slot].constData(), bytes, compressed, errorMessage) ||
+                file.write(compressed) != compressed.size()) {
+                if (errorMessage.isEmpty()) errorMessage = QStringLiteral("写入数据文件失败：%1").arg(file.errorString());
+                if (pending.valid()) pending.wait();
+                return false;
+            }
+            if (progress) progress(first * recordSize + bytes, totalBytes);
+            continue;
+        }
+        if (file.write(buffers[slot].constData(), bytes) != bytes) {
+            errorMessage = QStringLiteral("写入数据文件失败：%1").arg(file.errorString());
+            if (pending.valid()) pending.wait();
+            return false;
+        }
+        if (progress) progress(first * recordSize + bytes, totalBytes);
+    }
+    return true;
+}
+
+// 一块数据按线程数切片并行压缩，每片为独立的帧，读取时也能按帧并行解压
+bool SyntheticRecording::CompressChunk(CompressionKind compression,
+                                       const char* data,
+                                       qint64 size,
+                                       QByteArray& out,
+                                       QString& errorMessage) {
+    const qint64 sliceCount = std::clamp<qint64>(size / kMinCompressSliceBytes, 1, QThread::idealThreadCount());
+    const qint64 sliceBytes = (size + sliceCount - 1) / sliceCount;
+    std::vector<std::future<QByteArray>> slices;
+    std::vector<QString> errors(static_cast<size_t>(sliceCount));
+    for (qint64 i = 0; i < sliceCount; ++i) {
+        const qint64 begin = i * sliceBytes;
+        const qint64 length = std::min(sliceBytes, size - begin);
+        slices.push_back(std::async(std::launch::async, [compression, data, begin, length, &errors, i]() {
+            QByteArray frame;
+            CompressFrame(compression, data + begin, length, frame, errors[static_cast<size_t>(i)]);
+            return frame;
+        }));
+    }
+    for (auto& slice : slices) out.append(slice.get());
+    for (const QString& error : errors) {
+        if (!error.isEmpty()) {
+            errorMessage = error;
+            return false;
+        }
+    }
+    return true;
+}
+
+double SyntheticRecording::HashUniform(int signalIndex, qint64 index, quint64 salt) const {
+    quint64 state = spec_.seed ^ salt ^ (static_cast<quint64>(signalIndex) * 0xD1B54A32D192ED03ull) ^
+                    (static_cast<quint64>(index) * 0x8CB92BA72F3D8DD7ull);
+    return UniformFromBits(SplitMix64(state));
+}
+
+int SyntheticRecording::TypeSizeOf(RawType type) {
+    switch (type) {
+    case RawType::Int16:
+    case RawType::UInt16:
+        return 2;
+    case RawType::Int32:
+    case RawType::UInt32:
+    case RawType::Float32:
+        return 4;
+    case RawType::Float64:
+        break;
+    }
+    return 8;
+}
+
+void SyntheticRecording::EncodeValue(const SignalPlan& plan, double value, char* out) {
+    switch (plan.type) {
+    case RawType::Int16:
+        StoreLittle(ClampRound<qint16>((value - plan.bias) / plan.scale), out);
+        break;
+    case RawType::UInt16:
+        StoreLittle(ClampRound<quint16>((value - plan.bias) / plan.scale), out);
+        break;
+    case RawType::Int32:
+        StoreLittle(ClampRound<qint32>((value - plan.bias) / plan.scale), out);
+        break;
+    case RawType::UInt32:
+        StoreLittle(ClampRound<quint32>((value - plan.bias) / plan.scale), out);
+        break;
+    case RawType::Float32: {
+        const float f = static_cast<float>(value);
+        quint32 bits = 0;
+        std::memcpy(&bits, &f, sizeof(bits));
+        StoreLittle(bits, out);
+        break;
+    }
+    case RawType::Float64: {
+        quint64 bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        StoreLittle(bits, out);
+        break;
+    }
+    }
+}
+
+}  // namespace pat
@@ -0,0 +1,78 @@
+﻿#pragma once
+
+#include "core/Compression.h"
+#include "core/FormatDefinition.h"
+
+#include <QByteArray>
+#include <QString>
+
+#include <functional>
+#include <vector>
+
+namespace pat {
+
+struct SyntheticSpec {
+    int signalCount = 64;
+    int recordSize = 0;  // 0 表示按信号自然对齐紧凑排布
+    QString typeMix = QStringLiteral("int16:4,uint16:1,int32:1,uint32:1,float32:2,float64:1");
+    QString patternMix = QStringLiteral("sine:4,steps:2,noise:1,spikes:1");
+    int groupCount = 8;  // 顶层分组数，0 表示不分组
+    bool mixedTimeUnits = true;
+    double spikeRate = 1e-4;  // spikes 模式下每条记录出现尖峰的概率
+    qint64 fileBytes = 32ll * 1024 * 1024;
+    quint64 seed = 1;
+    double timeScale = 0.01;  // 秒
+};
+
+class SyntheticRecording {
+public:
+    using ProgressCallback = std::function<void(qint64 writtenBytes, qint64 totalBytes)>;
+
+    bool Configure(const SyntheticSpec& spec, QString& errorMessage);
+
+    const SyntheticSpec& Spec() const { return spec_; }
+    const FormatDefinition& Format() const { return format_; }
+    const QByteArray& FormatJson() const { return formatJson_; }
+    qint64 RecordCount() const { return recordCount_; }
+
+    void FillRecords(qint64 firstRecord, qint64 count, char* out) const;
+    bool WriteFormatFile(const QString& path, QString& errorMessage) const;
+    // compression 非 None 时按块压缩写出（多帧 zstd / BGZF gzip），用于压缩输入的解析与基准
+    bool WriteDataFile(const QString& path,
+                       QString& errorMessage,
+                       const ProgressCallback& progress = ProgressCallback(),
+                       CompressionKind compression = CompressionKind::None) const;
+
+private:
+    enum class RawType { Int16, UInt16, Int32, UInt32, Float32, Float64 };
+    enum class Pattern { Sine, Steps, Noise, Spikes };
+
+    struct SignalPlan {
+        RawType type = RawType::Int16;
+        Pattern pattern = Pattern::Sine;
+        int offset = 0;
+        double scale = 1.0;
+        double bias = 0.0;
+        double amplitude = 1.0;
+        double angularStep = 0.0;
+        double phase = 0.0;
+        double center = 0.0;
+        double noise = 0.0;
+        qint64 holdRecords = 1;
+    };
+
+    void FillSignal(int signalIndex, qint64 firstRecord, qint64 count, char* out) const;
+    void ParallelFill(qint64 firstRecord, qint64 count, char* out) const;
+    double HashUniform(int signalIndex, qint64 index, quint64 salt) const;
+    static int TypeSizeOf(RawType type);
+    static void EncodeValue(const SignalPlan& plan, double value, char* out);
+    static bool CompressChunk(CompressionKind compression, const char* data, qint64 size, QByteArray& out, QString& errorMessage);
+
+    SyntheticSpec spec_;
+    FormatDefinition format_;
+    QByteArray formatJson_;
+    std::vector<SignalPlan> plans_;
+    qint64 recordCount_ = 0;
+};
+
+}  // namespace pat
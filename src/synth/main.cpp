@@ -0,0 +1,197 @@
+﻿#include "synth/SyntheticRecording.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace {
+
+struct GenOptions {
+    pat::SyntheticSpec spec;
+    QString outDir;
+    QString baseName;
+    pat::CompressionKind compression = pat::CompressionKind::None;
+    bool quiet = false;
+};
+
+// 支持 K/M/G/T 后缀（1024 进制）
+bool ParseByteSize(const QString& text, qint64& outBytes) {
+    QString value = text.trimmed().toUpper();
+    if (value.endsWith('B')) value.chop(1);
+    double multiplier = 1.0;
+    if (!value.isEmpty()) {
+        const QChar suffix = value.back();
+        if (suffix == 'K') multiplier = 1024.0;
+        if (suffix == 'M') multiplier = 1024.0 * 1024.0;
+        if (suffix == 'G') multiplier = 1024.0 * 1024.0 * 1024.0;
+        if (suffix == 'T') multiplier = 1024.0 * 1024.0 * 1024.0 * 1024.0;
+        if (multiplier > 1.0) value.chop(1);
+    }
+    bool ok = false;
+    const double number = value.toDouble(&ok);
+    if (!ok || number <= 0.0) return false;
+    outBytes = static_cast<qint64>(number * multiplier);
+    return true;
+}
+
+bool ParseOptions(const QCoreApplication& app, GenOptions& options, QString& errorMessage) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("PAT 合成数据生成器：输出配套的格式 JSON 与数据文件"));
+    parser.addHelpOption();
+
+    const pat::SyntheticSpec defaults;
+    const QCommandLineOption outOption({QStringLiteral("o"), QStringLiteral("out-dir")}, QStringLiteral("输出目录"), QStringLiteral("dir"), QStringLiteral("."));
+    const QCommandLineOption nameOption({QStringLiteral("n"), QStringLiteral("name")}, QStringLiteral("文件名前缀"), QStringLiteral("name"), QStringLiteral("synthetic"));
+    const QCommandLineOption sizeOption(QStringLiteral("size"), QStringLiteral("数据文件大小，如 512M、4G"), QStringLiteral("bytes"), QStringLiteral("256M"));
+    const QCommandLineOption signalsOption(QStringLiteral("signals"), QStringLiteral("信号数"), QStringLiteral("n"), QString::number(defaults.signalCount));
+    const QCommandLineOption groupsOption(QStringLiteral("groups"), QStringLiteral("顶层分组数（0 为不分组）"), QStringLiteral("n"), QString::number(defaults.groupCount));
+    const QCommandLineOption recordOption(QStringLiteral("record-size"), QStringLiteral("记录长度（0 为紧凑排布）"), QStringLiteral("bytes"), QStringLiteral("0"));
+    const QCommandLineOption typeOption(QStringLiteral("type-mix"), QStringLiteral("类型配比，如 int16:4,float32:2"), QStringLiteral("mix"), defaults.typeMix);
+    const QCommandLineOption patternOption(QStringLiteral("pattern-mix"), QStringLiteral("波形配比，可选 sine/steps/noise/spikes"), QStringLiteral("mix"), defaults.patternMix);
+    const QCommandLineOption spikeOption(QStringLiteral("spike-rate"), QStringLiteral("spikes 波形每条记录的尖峰概率"), QStringLiteral("p"), QString::number(defaults.spikeRate));
+    const QCommandLineOption timeScaleOption(QStringLiteral("time-scale"), QStringLiteral("采样周期（秒）"), QStringLiteral("s"), QString::number(defaults.timeScale));
+    const QCommandLineOption uniformTimeOption(QStringLiteral("uniform-time-unit"), QStringLiteral("所有信号使用秒作为 time_unit"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("随机种子"), QStringLiteral("n"), QStringLiteral("1"));
+    const QCommandLineOption compressOption(QStringLiteral("compress"), QStringLiteral("数据文件压缩：none/gzip/zstd"), QStringLiteral("kind"), QStringLiteral("none"));
+    const QCommandLineOption quietOption({QStringLiteral("q"), QStringLiteral("quiet")}, QStringLiteral("不输出进度"));
+    for (const auto* option : {&outOption, &nameOption, &sizeOption, &signalsOption, &groupsOption, &recordOption, &typeOption,
+                               &patternOption, &spikeOption, &timeScaleOption, &uniformTimeOption, &seedOption, &compressOption, &quietOption}) {
+        parser.addOption(*option);
+    }
+    parser.process(app);
+
+    bool ok = ParseByteSize(parser.value(sizeOption), options.spec.fileBytes);
+    auto toInt = [&](const QCommandLineOption& option) {
+        bool valueOk = false;
+        const int value = parser.value(option).toInt(&valueOk);
+        ok = ok && valueOk;
+        return value;
+    };
+    auto toDouble = [&](const QCommandLineOption& option) {
+        bool valueOk = false;
+        const double value = parser.value(option).toDouble(&valueOk);
+        ok = ok && valueOk;
+        return value;
+    };
+
+    options.spec.signalCount = toInt(signalsOption);
+    options.spec.groupCount = toInt(groupsOption);
+    options.spec.recordSize = toInt(recordOption);
+    options.spec.typeMix = parser.value(typeOption);
+    options.spec.patternMix = parser.value(patternOption);
+    options.spec.spikeRate = toDouble(spikeOption);
+    options.spec.timeScale = toDouble(timeScaleOption);
+    options.spec.mixedTimeUnits = !parser.isSet(uniformTimeOption);
+    bool seedOk = false;
+    options.spec.seed = parser.value(seedOption).toULongLong(&seedOk);
+    ok = ok && seedOk;
+    options.outDir = parser.value(outOption);
+    options.baseName = parser.value(nameOption);
+    options.quiet = parser.isSet(quietOption);
+    const QString compression = parser.value(compressOption).toLower();
+    if (compression == QStringLiteral("gzip")) {
+        options.compression = pat::CompressionKind::Gzip;
+    } else if (compression == QStringLiteral("zstd")) {
+        options.compression = pat::CompressionKind::Zstd;
+    } else if (compression != QStringLiteral("none")) {
+        ok = false;
+    }
+    if (!pat::IsCompressionSupported(options.compression)) {
+        errorMessage = QStringLiteral("当前构建不支持 %1 压缩").arg(pat::CompressionName(options.compression));
+        return false;
+    }
+    if (!ok || options.baseName.isEmpty()) {
+        errorMessage = QStringLiteral("参数非法");
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("pat_gen"));
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    GenOptions options;
+    QString error;
+    if (!ParseOptions(app, options, error)) {
+        err << error << '\n';
+        return 2;
+    }
+
+    pat::SyntheticRecording recording;
+    if (!recording.Configure(options.spec, error)) {
+        err << error << '\n';
+        return 2;
+    }
+
+    const QDir dir(options.outDir);
+    if (!dir.exists() && !QDir().mkpath(options.outDir)) {
+        err << QStringLiteral("无法创建输出目录：%1\n").arg(options.outDir);
+        return 1;
+    }
+    const QString formatPath = dir.filePath(options.baseName + QStringLiteral("_format.json"));
+    QString dataName = options.baseName + QStringLiteral(".bin");
+    if (options.compression == pat::CompressionKind::Gzip) dataName += QStringLiteral(".gz");
+    if (options.compression == pat::CompressionKind::Zstd) dataName += QStringLiteral(".zst");
+    const QString dataPath = dir.filePath(dataName);
+    if (!recording.WriteFormatFile(formatPath, error)) {
+        err << error << '\n';
+        return 1;
+    }
+
+    const qint64 recordSize = recording.Format().recordSize;
+    const qint64 totalBytes = recording.RecordCount() * recordSize;
+    if (!options.quiet) {
+        err << QStringLiteral("生成 %1：%2 条记录 × %3 字节，%4 个信号\n")
+                   .arg(dataPath)
+                   .arg(recording.RecordCount())
+                   .arg(recordSize)
+                   .arg(options.spec.signalCount);
+        err.flush();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    int lastPercent = -1;
+    const auto progress = [&](qint64 written, qint64 total) {
+        if (options.quiet || total <= 0) return;
+        const int percent = static_cast<int>(written * 100 / total);
+        if (percent == lastPercent) return;
+        lastPercent = percent;
+        const double seconds = std::max(1e-9, timer.nsecsElapsed() * 1e-9);
+        err << QStringLiteral("\r%1%  %2 MB/s").arg(percent, 3).arg(written / seconds / (1024.0 * 1024.0), 0, 'f', 1);
+        err.flush();
+    };
+    if (!recording.WriteDataFile(dataPath, error, progress, options.compression)) {
+        if (!options.quiet) err << '\n';
+        err << error << '\n';
+        return 1;
+    }
+    const double seconds = std::max(1e-9, timer.nsecsElapsed() * 1e-9);
+    if (!options.quiet) err << '\n';
+
+    out << QStringLiteral("format: %1\n").arg(formatPath);
+    out << QStringLiteral("data:   %1\n").arg(dataPath);
+    out << QStringLiteral("%1 MB in %2 s (%3 MB/s)\n")
+               .arg(totalBytes / (1024.0 * 1024.0), 0, 'f', 1)
+               .arg(seconds, 0, 'f', 2)
+               .arg(totalBytes / seconds / (1024.0 * 1024.0), 0, 'f', 1);
+    if (options.compression != pat::CompressionKind::None) {
+        const qint64 compressedBytes = QFileInfo(dataPath).size();
+        out << QStringLiteral("compressed: %1 MB (%2, ratio %3)\n")
+                   .arg(compressedBytes / (1024.0 * 1024.0), 0, 'f', 1)
+                   .arg(pat::CompressionName(options.compression))
+                   .arg(compressedBytes > 0 ? double(totalBytes) / compressedBytes : 0.0, 0, 'f', 2);
+    }
+    return 0;
+}
@@ -1,5 +1,9 @@
 ﻿#include "ui/ChartArea.h"
 
+#include "core/PerfCounters.h"
+#include "core/SeriesQuery.h"
+#include "core/TaskScheduler.h"
+#include "core/Trace.h"
 #include "ui/SignalTreeWidget.h"
 
 #include <QApplication>
@@ -33,6 +37,30 @@ QVector<QColor> SeriesPalette() {
     };
 }
 
+// 按 indices 的顺序抽稀各信号，越界的下标给空曲线。信号之间互不依赖，以交互优先级并行，
+// 任务池中排队的后台统计让位于这里的分块
+QVector<QVector<QPointF>> DecimateSignals(const QVector<pat::Series>& series,
+                                          const QVector<int>& indices,
+                                          double minX,
+                                          double maxX,
+                                          int maxPoints) {
+    QVector<QVector<QPointF>> samples(indices.size());
+    QVector<QPointF>* out = samples.data();
+    pat::TaskScheduler::Instance().ParallelFor(
+        0,
+        indices.size(),
+        1,
+        [&](qint64 first, qint64 last) {
+            for (qint64 i = first; i < last; ++i) {
+                const int idx = indices[i];
+                if (idx < 0 || idx >= series.size()) continue;
+                out[i] = pat::DecimateSamples(series[idx], minX, maxX, maxPoints);
+            }
+        },
+        pat::TaskPriority::Interactive);
+    return samples;
+}
+
 }  // namespace
 
 ChartArea::ChartArea(QWidget* parent) : QWidget(parent) {
@@ -78,8 +106,9 @@ void ChartArea::SetStatistics(const pat::SeriesStatistics& stats) {
     stats_ = stats;
     hasStats_ = true;
     minXSpan_ = stats_.minStep;
-    if (!hasCurrentRange_) {
-        currentMinX_ = 0.0;
+    // 新数据与当前视窗不相交（如部分加载了另一段时间）时回到全范围
+    if (!hasCurrentRange_ || currentMaxX_ <= stats_.minX || currentMinX_ >= stats_.maxX) {
+        currentMinX_ = stats_.minX;
         currentMaxX_ = stats_.maxX;
         hasCurrentRange_ = true;
     }
@@ -99,13 +128,37 @@ void ChartArea::SetMaxVisiblePoints(int maxPoints) {
 
 void ChartArea::ResetXRange() {
     if (!hasStats_) return;
-    ApplyXRange(0.0, stats_.maxX);
+    ApplyXRange(stats_.minX, stats_.maxX);
+}
+
+bool ChartArea::CurrentXRange(double& outMinX, double& outMaxX) const {
+    if (!hasCurrentRange_) return false;
+    outMinX = currentMinX_;
+    outMaxX = currentMaxX_;
+    return true;
 }
 
 void ChartArea::RefreshCharts() {
     BuildCharts();
 }
 
+void ChartArea::SetXRange(double minX, double maxX) {
+    ApplyXRange(minX, maxX);
+}
+
+void ChartArea::SetCursorX(double cursorX) {
+    HandleCursorMoved(cursorX);
+}
+
+// 滚动区域内实际露出的图表数，即一帧要等待重绘的图表数
+int ChartArea::VisibleChartCount() const {
+    int count = 0;
+    for (auto* chart : charts_) {
+        if (chart && chart->isVisible() && !chart->visibleRegion().isEmpty()) ++count;
+    }
+    return count;
+}
+
 bool ChartArea::eventFilter(QObject* obj, QEvent* event) {
     if (obj == scrollArea_->viewport() || obj == container_) {
         auto* widget = qobject_cast<QWidget*>(obj);
@@ -285,15 +338,22 @@ void ChartArea::HandleHideSignalsRequested(const QVector<int>& indices) {
 }
 
 void ChartArea::BuildCharts() {
+    const pat::TraceScope trace("ChartArea::BuildCharts", "ui");
     ClearCharts();
 
     if (!series_ || groups_.isEmpty() || !splitter_) return;
     if (!hasStats_) return;
 
-    const double viewMinX = hasCurrentRange_ ? currentMinX_ : 0.0;
+    const double viewMinX = hasCurrentRange_ ? currentMinX_ : stats_.minX;
     const double viewMaxX = hasCurrentRange_ ? currentMaxX_ : stats_.maxX;
     const auto palette = SeriesPalette();
 
+    // 所有组的信号一起抽稀，组内信号少时也能占满线程
+    QVector<int> allIndices;
+    for (const auto& group : groups_) allIndices += group.signalIndices;
+    const QVector<QVector<QPointF>> allSamples = DecimateSignals(*series_, allIndices, viewMinX, viewMaxX, maxVisiblePoints_);
+    qsizetype sampleOffset = 0;
+
     for (int groupIndex = 0; groupIndex < groups_.size(); ++groupIndex) {
         const auto& group = groups_[groupIndex];
         double groupMinY = -1.0;
@@ -303,15 +363,8 @@ void ChartArea::BuildCharts() {
             groupMaxY = 1.0;
         }
 
-        QVector<QVector<QPointF>> seriesSamples;
-        seriesSamples.reserve(group.signalIndices.size());
-        for (int idx : group.signalIndices) {
-            if (!series_ || idx < 0 || idx >= series_->size()) {
-                seriesSamples.append(QVector<QPointF>{});
-                continue;
-            }
-            seriesSamples.append(DecimateSamples(series_->at(idx).samples, viewMinX, viewMaxX, maxVisiblePoints_));
-        }
+        const QVector<QVector<QPointF>> seriesSamples = allSamples.mid(sampleOffset, group.signalIndices.size());
+        sampleOffset += group.signalIndices.size();
 
         auto* view = new SignalChartView(splitter_);
         view->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
@@ -361,7 +414,7 @@ void ChartArea::ClearCharts() {
 
 void ChartArea::ApplyXRange(double minX, double maxX) {
     if (!hasStats_) return;
-    const double boundMin = 0.0;
+    const double boundMin = stats_.minX;
     const double boundMax = stats_.maxX;
     minX = std::max(boundMin, minX);
     maxX = std::min(boundMax, maxX);
@@ -403,73 +456,28 @@ void ChartArea::ApplyXRange(double minX, double maxX) {
 }
 
 void ChartArea::RefreshVisibleSeries(double minX, double maxX) {
+    const pat::TraceScope trace("ChartArea::RefreshVisibleSeries", "ui");
     if (!series_) return;
 
-    for (int i = 0; i < charts_.size(); ++i) {
-        auto* chart = charts_[i];
-        if (!chart) continue;
-        QVector<QVector<QPointF>> samples;
-        const auto& indices = chart->SeriesIndices();
-        samples.reserve(indices.size());
-        for (int idx : indices) {
-            if (idx < 0 || idx >= series_->size()) {
-                samples.append(QVector<QPointF>{});
-                continue;
-            }
-            samples.append(DecimateSamples(series_->at(idx).samples, minX, maxX, maxVisiblePoints_));
-        }
-        chart->SetSeriesSamples(samples);
-    }
-}
-
-QVector<QPointF> ChartArea::DecimateSamples(const QVector<QPointF>& samples,
-                                            double minX,
-                                            double maxX,
-                                            int maxPoints) const {
-    if (samples.isEmpty()) return {};
-    if (maxPoints <= 0) return {};
-    if (maxX < minX) std::swap(minX, maxX);
-
-    auto begin = samples.begin();
-    auto end = samples.end();
-    auto startIt = std::lower_bound(begin, end, minX, [](const QPointF& p, double x) { return p.x() < x; });
-    auto endIt = std::upper_bound(startIt, end, maxX, [](double x, const QPointF& p) { return x < p.x(); });
-    const int count = static_cast<int>(endIt - startIt);
-    if (count <= 0) return {};
-    if (count <= maxPoints) {
-        return QVector<QPointF>(startIt, endIt);
+    // 一帧从抽稀开始，到滚动区域内可见的图表都重绘完为止
+    QVector<int> allIndices;
+    for (auto* chart : charts_) {
+        if (chart) allIndices += chart->SeriesIndices();
     }
-
-    const int bucketCount = std::max(1, maxPoints / 2);
-    const double span = maxX - minX;
-    const double bucketSize = span > 0.0 ? span / bucketCount : 1.0;
-
-    QVector<QPointF> out;
-    out.reserve(maxPoints);
-    out.append(*startIt);
-    for (int b = 0; b < bucketCount; ++b) {
-        const double bx0 = minX + bucketSize * b;
-        const double bx1 = (b == bucketCount - 1) ? maxX : (bx0 + bucketSize);
-        auto b0 = std::lower_bound(startIt, endIt, bx0, [](const QPointF& p, double x) { return p.x() < x; });
-        auto b1 = std::lower_bound(b0, endIt, bx1, [](const QPointF& p, double x) { return p.x() < x; });
-        if (b0 == b1) continue;
-        auto minIt = b0;
-        auto maxIt = b0;
-        for (auto it = b0; it != b1; ++it) {
-            if (it->y() < minIt->y()) minIt = it;
-            if (it->y() > maxIt->y()) maxIt = it;
-        }
-        if (minIt->x() <= maxIt->x()) {
-            out.append(*minIt);
-            if (maxIt != minIt) out.append(*maxIt);
-        } else {
-            out.append(*maxIt);
-            if (maxIt != minIt) out.append(*minIt);
-        }
-        if (out.size() >= maxPoints) break;
+    pat::PerfCounters& perf = pat::PerfCounters::Instance();
+    perf.BeginFrame(VisibleChartCount());
+    const qint64 startNs = pat::TraceRecorder::NowNs();
+    const QVector<QVector<QPointF>> allSamples = DecimateSignals(*series_, allIndices, minX, maxX, maxVisiblePoints_);
+    qint64 points = 0;
+    for (const auto& samples : allSamples) points += samples.size();
+    perf.RecordDecimation(pat::TraceRecorder::NowNs() - startNs, points);
+    qsizetype sampleOffset = 0;
+    for (auto* chart : charts_) {
+        if (!chart) continue;
+        const qsizetype count = chart->SeriesIndices().size();
+        chart->SetSeriesSamples(allSamples.mid(sampleOffset, count));
+        sampleOffset += count;
     }
-    out.append(*(endIt - 1));
-    return out;
 }
 
 bool ChartArea::ComputeGroupRange(const QVector<int>& indices, double& outMinY, double& outMaxY) const {
@@ -481,14 +489,31 @@ bool ChartArea::ComputeGroupRange(const QVector<int>& indices, double& outMinY,
     for (int idx : indices) {
         if (idx < 0 || idx >= series_->size()) continue;
         const auto& series = series_->at(idx);
-        for (const auto& pt : series.samples) {
+        pat::SeriesReader reader(series);
+        const auto include = [&](double low, double high) {
             if (!hasRange) {
-                outMinY = outMaxY = pt.y();
+                outMinY = low;
+                outMaxY = high;
                 hasRange = true;
             } else {
-                outMinY = std::min(outMinY, pt.y());
-                outMaxY = std::max(outMaxY, pt.y());
+                outMinY = std::min(outMinY, low);
+                outMaxY = std::max(outMaxY, high);
+            }
+        };
+        for (qsizetype i = 0; i < series.Size(); ++i) {
+            // 压缩列（含游程列）且无无效样本时直接用块头的最小/最大值
+            qsizetype blockFirst = 0;
+            qsizetype blockCount = 0;
+            double blockMin = 0.0;
+            double blockMax = 0.0;
+            if (!series.HasInvalid() && reader.ValueBlockSummary(i, blockFirst, blockCount, blockMin, blockMax)) {
+                include(blockMin, blockMax);
+                i = blockFirst + blockCount - 1;
+                continue;
             }
+            if (!series.IsValid(i)) continue;
+            const double y = reader.Value(i);
+            include(y, y);
         }
     }
 
@@ -502,6 +527,7 @@ bool ChartArea::ComputeGroupRange(const QVector<int>& indices, double& outMinY,
 }
 
 void ChartArea::UpdateChartHeights() {
+    const pat::TraceScope trace("ChartArea::UpdateChartHeights", "ui");
     if (!splitter_ || !scrollArea_) return;
     const int viewportHeight = scrollArea_->viewport()->height();
     minChartHeight_ = std::max(80, viewportHeight / 6);
@@ -523,7 +549,7 @@ void ChartArea::UpdateChartHeights() {
 
 void ChartArea::UpdateRangeContext() {
     ChartRangeContext context;
-    context.globalMinX = 0.0;
+    context.globalMinX = stats_.minX;
     context.globalMaxX = stats_.maxX;
     context.currentMinX = currentMinX_;
     context.currentMaxX = currentMaxX_;
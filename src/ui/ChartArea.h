@@ -22,7 +22,12 @@ public:
     void SetTimeUnit(const QString& unit);
     void SetMaxVisiblePoints(int maxPoints);
     void ResetXRange();
+    bool CurrentXRange(double& outMinX, double& outMaxX) const;
     void RefreshCharts();
+    // 与鼠标缩放/平移、游标移动等效的入口，供离屏渲染基准按脚本驱动
+    void SetXRange(double minX, double maxX);
+    void SetCursorX(double cursorX);
+    int VisibleChartCount() const;
 
 signals:
     void SignalsDropped(const QVector<int>& indices);
@@ -49,10 +54,6 @@ private:
     void ClearCharts();
     void ApplyXRange(double minX, double maxX);
     void RefreshVisibleSeries(double minX, double maxX);
-    QVector<QPointF> DecimateSamples(const QVector<QPointF>& samples,
-                                     double minX,
-                                     double maxX,
-                                     int maxPoints) const;
     bool ComputeGroupRange(const QVector<int>& indices, double& outMinY, double& outMaxY) const;
     void UpdateChartHeights();
     void UpdateRangeContext();
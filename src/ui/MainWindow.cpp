@@ -1,12 +1,18 @@
 ﻿#include "ui/MainWindow.h"
 
+#include "core/SeriesExport.h"
+#include "core/Trace.h"
 #include "ui/ChartArea.h"
 #include "ui/FormatEditorDialog.h"
+#include "ui/MemoryUsageDialog.h"
+#include "ui/PartialLoadDialog.h"
+#include "ui/PerformanceHud.h"
 #include "ui/SignalTreeController.h"
 #include "ui/SignalTreeWidget.h"
 
 #include <QAction>
 #include <QAbstractItemView>
+#include <QEventLoop>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QInputDialog>
@@ -14,16 +20,31 @@
 #include <QMenu>
 #include <QMenuBar>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QSignalBlocker>
 #include <QStatusBar>
 #include <QHBoxLayout>
 #include <QSplitter>
 #include <QVBoxLayout>
 #include <QWidget>
+#include <QThread>
 #include <QTreeWidgetItem>
 
+#include <atomic>
+#include <memory>
+
 namespace {
 
+// 超过此大小的数据文件先显示抽样预览，完整解析在后台进行
+constexpr qint64 kPreviewMinBytes = 256ll * 1024 * 1024;
+constexpr qint64 kPreviewRecords = 200000;
+
+struct BackgroundLoad {
+    pat::DataSession session;
+    QString error;
+    bool ok = false;
+};
+
 QString FileLeaf(const QString& path) {
     QFileInfo info(path);
     return info.fileName();
@@ -61,9 +82,19 @@ QString DefaultFormatTemplate() {
 }  // namespace
 
 MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
+    dataSession_.SetPackColumns(true);
+    dataSession_.SetValuePrecision(pat::ValuePrecision::Auto);
     SetupUi();
 }
 
+MainWindow::~MainWindow() {
+    // 解析无法中途取消，等待仍在运行的后台解析结束后再释放
+    for (QThread* worker : backgroundLoads_) {
+        worker->wait();
+        delete worker;
+    }
+}
+
 void MainWindow::SetupUi() {
     setWindowTitle(tr("PAT 飞参解析工具"));
 
@@ -73,7 +104,15 @@ void MainWindow::SetupUi() {
     auto* saveFormatAction = new QAction(tr("保存格式"), this);
     auto* saveAsFormatAction = new QAction(tr("格式另存为..."), this);
     auto* openDataAction = new QAction(tr("打开数据..."), this);
+    auto* openDataRangeAction = new QAction(tr("部分加载数据..."), this);
+    auto* exportDataAction = new QAction(tr("导出数据..."), this);
     auto* setMaxPointsAction = new QAction(tr("设置最大显示点数..."), this);
+    auto* setMemoryBudgetAction = new QAction(tr("设置内存上限..."), this);
+    auto* showMemoryUsageAction = new QAction(tr("内存占用..."), this);
+    auto* traceAction = new QAction(tr("记录性能跟踪"), this);
+    traceAction->setCheckable(true);
+    auto* performanceHudAction = new QAction(tr("显示性能信息"), this);
+    performanceHudAction->setCheckable(true);
     auto* exitAction = new QAction(tr("退出"), this);
 
     connect(openFormatAction, &QAction::triggered, this, &MainWindow::OpenFormatFile);
@@ -82,7 +121,13 @@ void MainWindow::SetupUi() {
     connect(saveFormatAction, &QAction::triggered, this, &MainWindow::SaveFormatFile);
     connect(saveAsFormatAction, &QAction::triggered, this, &MainWindow::SaveFormatFileAs);
     connect(openDataAction, &QAction::triggered, this, &MainWindow::OpenDataFile);
+    connect(openDataRangeAction, &QAction::triggered, this, &MainWindow::OpenDataFileRange);
+    connect(exportDataAction, &QAction::triggered, this, &MainWindow::ExportData);
     connect(setMaxPointsAction, &QAction::triggered, this, &MainWindow::SetMaxVisiblePoints);
+    connect(setMemoryBudgetAction, &QAction::triggered, this, &MainWindow::SetMemoryBudget);
+    connect(showMemoryUsageAction, &QAction::triggered, this, &MainWindow::ShowMemoryUsage);
+    connect(traceAction, &QAction::toggled, this, &MainWindow::ToggleTrace);
+    connect(performanceHudAction, &QAction::toggled, this, &MainWindow::TogglePerformanceHud);
     connect(exitAction, &QAction::triggered, this, &MainWindow::close);
 
     auto* fileMenu = menuBar()->addMenu(tr("文件"));
@@ -92,7 +137,13 @@ void MainWindow::SetupUi() {
     fileMenu->addAction(saveFormatAction);
     fileMenu->addAction(saveAsFormatAction);
     fileMenu->addAction(openDataAction);
+    fileMenu->addAction(openDataRangeAction);
+    fileMenu->addAction(exportDataAction);
     fileMenu->addAction(setMaxPointsAction);
+    fileMenu->addAction(setMemoryBudgetAction);
+    fileMenu->addAction(showMemoryUsageAction);
+    fileMenu->addAction(traceAction);
+    fileMenu->addAction(performanceHudAction);
     fileMenu->addSeparator();
     fileMenu->addAction(exitAction);
 
@@ -145,6 +196,8 @@ void MainWindow::SetupUi() {
     layout->addWidget(splitter);
 
     setCentralWidget(central);
+    performanceHud_ = new PerformanceHud(this);
+    statusBar()->addPermanentWidget(performanceHud_);
     statusBar()->showMessage(tr("就绪"));
 }
 
@@ -167,7 +220,9 @@ void MainWindow::OpenFormatFile() {
 
     if (dataSession_.HasData()) {
         const QString dataPath = dataSession_.Path();
-        if (!dataSession_.Load(dataPath, formatDocument_.Format(), error)) {
+        const pat::RecordRange range = dataSession_.LoadedRange();
+        ++loadGeneration_;
+        if (!dataSession_.LoadRange(dataPath, formatDocument_.Format(), range, error)) {
             dataSession_.Clear();
             QMessageBox::warning(this, tr("重解析失败"), error);
         }
@@ -191,7 +246,19 @@ void MainWindow::OpenDataFile() {
                                                       tr("数据文件 (*.bin *.dat);;所有文件 (*)"));
     if (path.isEmpty()) return;
 
+    // 大文件先显示抽样预览，完整解析在后台完成后替换；格式不支持预览时照常同步解析
     QString error;
+    ++loadGeneration_;
+    if (QFileInfo(path).size() >= kPreviewMinBytes &&
+        dataSession_.LoadPreview(path, formatDocument_.Format(), kPreviewRecords, error)) {
+        UpdateCharts();
+        UpdateStatus(tr("预览：%1，每 %2 条记录取 1 条，正在后台完整解析...")
+                         .arg(FileLeaf(path))
+                         .arg(dataSession_.PreviewStep()));
+        StartBackgroundLoad(path);
+        return;
+    }
+
     if (!dataSession_.Load(path, formatDocument_.Format(), error)) {
         QMessageBox::warning(this, tr("解析失败"), error);
         return;
@@ -206,9 +273,148 @@ void MainWindow::OpenDataFile() {
 #endif
 
     UpdateCharts();
+    ReportParseStatus(path);
+}
+
+void MainWindow::OpenDataFileRange() {
+    if (!formatDocument_.HasFormat()) {
+        QMessageBox::information(this, tr("提示"), tr("请先加载格式文件"));
+        return;
+    }
+
+    const QString path = QFileDialog::getOpenFileName(this,
+                                                      tr("选择数据文件"),
+                                                      QString(),
+                                                      tr("数据文件 (*.bin *.dat);;所有文件 (*)"));
+    if (path.isEmpty()) return;
+
+    const pat::FormatDefinition& format = formatDocument_.Format();
+    const qint64 totalRecords = format.recordSize > 0 ? QFileInfo(path).size() / format.recordSize : 0;
+    PartialLoadDialog dialog(totalRecords, format.timeAxisUnit, this);
+    PartialLoadRequest request;
+    if (!dialog.Run(request)) return;
+
+    QString error;
+    ++loadGeneration_;
+    const bool ok = request.byTime
+                        ? dataSession_.LoadTimeWindow(path, format, request.startTime, request.endTime, error)
+                        : dataSession_.LoadRange(path, format, request.range, error);
+    if (!ok) {
+        QMessageBox::warning(this, tr("解析失败"), error);
+        return;
+    }
+
+    UpdateCharts();
+    ReportParseStatus(path);
+}
+
+void MainWindow::StartBackgroundLoad(const QString& path) {
+    const quint64 generation = loadGeneration_;
+    const pat::FormatDefinition format = formatDocument_.Format();
+    auto pending = std::make_shared<BackgroundLoad>();
+    pending->session.SetPackColumns(dataSession_.PackColumns());
+    pending->session.SetValuePrecision(dataSession_.Precision());
+    QThread* worker = QThread::create([pending, path, format]() {
+        pending->ok = pending->session.Load(path, format, pending->error);
+    });
+    backgroundLoads_.append(worker);
+    connect(worker, &QThread::finished, this, [this, worker, pending, generation, path]() {
+        backgroundLoads_.removeOne(worker);
+        worker->deleteLater();
+        if (generation != loadGeneration_) return;  // 期间打开了其他文件或已重解析
+        if (!pending->ok) {
+            QMessageBox::warning(this, tr("解析失败"), pending->error);
+            UpdateStatus(tr("完整解析失败，当前显示的是预览数据"));
+            return;
+        }
+        dataSession_ = std::move(pending->session);
+        UpdateCharts();
+        ReportParseStatus(path);
+    });
+    worker->start();
+}
+
+void MainWindow::ReportParseStatus(const QString& path) {
+    const pat::ParseReport& report = dataSession_.LastParseReport();
+    QString status = tr("解析完成：%1，记录数 %2").arg(FileLeaf(path)).arg(report.recordCount);
+    const pat::RecordRange& range = dataSession_.LoadedRange();
+    if (!range.IsFull()) {
+        status += tr("（自第 %1 条记录起）").arg(range.firstRecord);
+    }
+    if (!report.gaps.isEmpty()) {
+        status += tr("，失步 %1 处，跳过 %2 字节（折合 %3 条缺失记录）")
+                      .arg(report.gaps.size())
+                      .arg(report.skippedBytes)
+                      .arg(report.missingRecords);
+    }
+    if (report.invalidRecords > 0) {
+        status += tr("，校验失败 %1 条记录").arg(report.invalidRecords);
+    }
+    if (dataSession_.Store()) {
+        const pat::ChunkStoreStats stats = dataSession_.Store()->Stats();
+        status += tr("，外存 %1 MB").arg(stats.spilledBytes / (1024 * 1024));
+    }
+    UpdateStatus(status);
+}
+
+void MainWindow::ExportData() {
+    if (!dataSession_.HasData()) {
+        QMessageBox::information(this, tr("提示"), tr("请先加载数据文件"));
+        return;
+    }
+    if (dataSession_.IsPreview()) {
+        QMessageBox::information(this, tr("提示"), tr("完整解析尚未完成，当前仅有预览数据"));
+        return;
+    }
 
-    const int recordCount = dataSession_.Series().isEmpty() ? 0 : dataSession_.Series().first().samples.size();
-    UpdateStatus(tr("解析完成：%1，记录数 %2").arg(FileLeaf(path)).arg(recordCount));
+    const QString path = QFileDialog::getSaveFileName(this,
+                                                      tr("导出数据"),
+                                                      QString(),
+                                                      tr("CSV (*.csv);;PATX 二进制 (*.patx);;Arrow IPC (*.arrow *.feather)"));
+    if (path.isEmpty()) return;
+
+    // 导出勾选的信号；图表已缩放时只导出当前可见时间窗
+    pat::ExportOptions options;
+    options.fileFormat = pat::ExportFormatFromPath(path);
+    options.timeUnit = dataSession_.TimeUnit();
+    if (signalTreeController_) options.signalIndices = signalTreeController_->CollectCheckedSignalIndices();
+#ifdef PAT_ENABLE_QT_CHARTS
+    if (chartArea_) options.hasTimeWindow = chartArea_->CurrentXRange(options.startTime, options.endTime);
+#endif
+
+    constexpr int kProgressSteps = 1000;
+    QProgressDialog progressDialog(tr("正在导出 %1 ...").arg(FileLeaf(path)), tr("取消"), 0, kProgressSteps, this);
+    progressDialog.setWindowModality(Qt::WindowModal);
+    progressDialog.setMinimumDuration(300);
+    std::atomic<bool> canceled{false};
+    connect(&progressDialog, &QProgressDialog::canceled, this, [&canceled]() { canceled = true; });
+
+    // 格式化与写盘在工作线程进行，界面线程只负责进度显示
+    QString error;
+    bool ok = false;
+    const QVector<pat::Series>& series = dataSession_.Series();
+    QThread* worker = QThread::create([&]() {
+        ok = pat::ExportSeries(path, series, options, error, [&](qint64 done, qint64 total) {
+            const int value = total > 0 ? static_cast<int>(done * kProgressSteps / total) : kProgressSteps;
+            QMetaObject::invokeMethod(
+                &progressDialog, [&progressDialog, value]() { progressDialog.setValue(value); }, Qt::QueuedConnection);
+            return !canceled.load();
+        });
+    });
+    QEventLoop loop;
+    connect(worker, &QThread::finished, &loop, &QEventLoop::quit);
+    worker->start();
+    loop.exec();
+    delete worker;
+    progressDialog.reset();
+
+    if (ok) {
+        UpdateStatus(tr("导出完成：%1").arg(FileLeaf(path)));
+    } else if (canceled.load()) {
+        UpdateStatus(tr("导出已取消"));
+    } else {
+        QMessageBox::warning(this, tr("导出失败"), error);
+    }
 }
 
 void MainWindow::NewFormatFile() {
@@ -251,7 +457,9 @@ void MainWindow::EditFormatFile() {
 
     if (dataSession_.HasData()) {
         const QString dataPath = dataSession_.Path();
-        if (!dataSession_.Load(dataPath, formatDocument_.Format(), error)) {
+        const pat::RecordRange range = dataSession_.LoadedRange();
+        ++loadGeneration_;
+        if (!dataSession_.LoadRange(dataPath, formatDocument_.Format(), range, error)) {
             dataSession_.Clear();
             QMessageBox::warning(this, tr("重解析失败"), error);
         }
@@ -313,6 +521,58 @@ void MainWindow::SetMaxVisiblePoints() {
 #endif
 }
 
+void MainWindow::SetMemoryBudget() {
+    pat::MemoryGovernor& governor = pat::MemoryGovernor::Instance();
+    bool ok = false;
+    const int megabytes = QInputDialog::getInt(this,
+                                               tr("内存上限"),
+                                               tr("解码数据的常驻内存上限（MB），对所有已加载与正在加载的数据合计；0 表示不限。\n"
+                                                  "估计放不下的数据改用外存模式，超出部分换出到临时文件；下次加载数据时生效"),
+                                               static_cast<int>(governor.Budget() / (1024 * 1024)),
+                                               0,
+                                               1024 * 1024,
+                                               256,
+                                               &ok);
+    if (!ok) return;
+    governor.SetBudget(static_cast<qint64>(megabytes) * 1024 * 1024);
+    UpdateStatus(megabytes > 0 ? tr("内存上限：%1 MB").arg(megabytes) : tr("内存上限：不限"));
+}
+
+void MainWindow::ShowMemoryUsage() {
+    MemoryUsageDialog dialog(dataSession_, this);
+    dialog.exec();
+}
+
+void MainWindow::TogglePerformanceHud(bool enabled) {
+    if (performanceHud_) performanceHud_->SetActive(enabled);
+}
+
+// 勾选时开始采集，取消勾选时停止并保存为 Chrome trace_event JSON，可在 chrome://tracing 或 Perfetto 中打开
+void MainWindow::ToggleTrace(bool enabled) {
+    pat::TraceRecorder& recorder = pat::TraceRecorder::Instance();
+    if (enabled) {
+        recorder.Start();
+        UpdateStatus(tr("正在记录性能跟踪，再次点击停止并保存"));
+        return;
+    }
+    recorder.Stop();
+    if (recorder.SpanCount() == 0) {
+        UpdateStatus(tr("性能跟踪已停止，没有记录到耗时区间"));
+        return;
+    }
+    const QString path = QFileDialog::getSaveFileName(this,
+                                                      tr("保存性能跟踪"),
+                                                      QStringLiteral("pat_trace.json"),
+                                                      tr("Chrome 跟踪 (*.json)"));
+    if (path.isEmpty()) return;
+    QString error;
+    if (!recorder.WriteChromeJson(path, error)) {
+        QMessageBox::warning(this, tr("保存失败"), error);
+        return;
+    }
+    UpdateStatus(tr("性能跟踪已保存：%1（%2 个区间）").arg(FileLeaf(path)).arg(recorder.SpanCount()));
+}
+
 void MainWindow::HandleSignalTreeItemChanged(QTreeWidgetItem* item, int column) {
     if (signalTreeUpdating_) return;
     if (!signalTree_ || !signalTreeController_ || column != 0) {
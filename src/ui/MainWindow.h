@@ -5,14 +5,17 @@
 #include "ui/DisplayGroupManager.h"
 #include "ui/SignalTreeController.h"
 
+#include <QList>
 #include <QMainWindow>
 
 #include <memory>
 
 class QLabel;
+class QThread;
 class SignalTreeWidget;
 class SignalTreeController;
 class ChartArea;
+class PerformanceHud;
 class QTreeWidgetItem;
 
 class MainWindow : public QMainWindow {
@@ -20,21 +23,30 @@ class MainWindow : public QMainWindow {
 
 public:
     explicit MainWindow(QWidget* parent = nullptr);
+    ~MainWindow() override;
 
 private slots:
     void OpenFormatFile();
     void OpenDataFile();
+    void OpenDataFileRange();
+    void ExportData();
     void NewFormatFile();
     void EditFormatFile();
     void SaveFormatFile();
     void SaveFormatFileAs();
     void SetMaxVisiblePoints();
+    void SetMemoryBudget();
+    void ShowMemoryUsage();
+    void ToggleTrace(bool enabled);
+    void TogglePerformanceHud(bool enabled);
 
 private:
     void SetupUi();
     void HandleSignalTreeItemChanged(QTreeWidgetItem* item, int column);
     void UpdateCharts();
     void UpdateStatus(const QString& text);
+    void ReportParseStatus(const QString& path);
+    void StartBackgroundLoad(const QString& path);
     void BuildSignalTree();
     void ShowSignalTreeMenu(const QPoint& pos);
     void HandleSignalsDropped(const QVector<int>& indices);
@@ -50,6 +62,11 @@ private:
     std::unique_ptr<SignalTreeController> signalTreeController_;
     ChartArea* chartArea_ = nullptr;
     QLabel* statusLabel_ = nullptr;
+    PerformanceHud* performanceHud_ = nullptr;
+
+    // 后台完整解析：每次打开或重解析递增代号，过期的结果直接丢弃
+    QList<QThread*> backgroundLoads_;
+    quint64 loadGeneration_ = 0;
 
     int maxVisiblePoints_ = 5000;
     bool signalTreeUpdating_ = false;
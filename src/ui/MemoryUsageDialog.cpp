@@ -0,0 +1,96 @@
+﻿#include "ui/MemoryUsageDialog.h"
+
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLocale>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+namespace {
+
+QString FormatBytes(qint64 bytes) {
+    return QLocale().formattedDataSize(bytes, 1, QLocale::DataSizeTraditionalFormat);
+}
+
+// 按字节数而不是显示文本排序
+class BytesItem : public QTableWidgetItem {
+public:
+    explicit BytesItem(qint64 bytes) : QTableWidgetItem(FormatBytes(bytes)) {
+        setData(Qt::UserRole, bytes);
+        setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    }
+
+    bool operator<(const QTableWidgetItem& other) const override {
+        return data(Qt::UserRole).toLongLong() < other.data(Qt::UserRole).toLongLong();
+    }
+};
+
+}  // namespace
+
+MemoryUsageDialog::MemoryUsageDialog(const pat::DataSession& session, QWidget* parent) : QDialog(parent), session_(session) {
+    setWindowTitle(tr("内存占用"));
+    resize(760, 480);
+
+    auto* layout = new QVBoxLayout(this);
+    summaryLabel_ = new QLabel(this);
+    summaryLabel_->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    layout->addWidget(summaryLabel_);
+
+    table_ = new QTableWidget(this);
+    table_->setColumnCount(8);
+    table_->setHorizontalHeaderLabels({tr("信号"), tr("存储"), tr("数值"), tr("时间轴"), tr("时间索引"), tr("有效位"), tr("外存块"), tr("合计")});
+    table_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table_->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table_->verticalHeader()->setVisible(false);
+    table_->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    layout->addWidget(table_);
+
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    auto* refreshButton = buttons->addButton(tr("刷新"), QDialogButtonBox::ActionRole);
+    layout->addWidget(buttons);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(refreshButton, &QPushButton::clicked, this, &MemoryUsageDialog::Refresh);
+
+    Refresh();
+}
+
+void MemoryUsageDialog::Refresh() {
+    const pat::SessionMemoryUsage usage = session_.MemoryUsage();
+    table_->setSortingEnabled(false);
+    table_->setRowCount(usage.signalUsage.size());
+    for (int row = 0; row < usage.signalUsage.size(); ++row) {
+        const pat::SignalMemoryUsage& signal = usage.signalUsage[row];
+        table_->setItem(row, 0, new QTableWidgetItem(signal.name));
+        table_->setItem(row, 1, new QTableWidgetItem(signal.storage));
+        table_->setItem(row, 2, new BytesItem(signal.valueBytes));
+        table_->setItem(row, 3, new BytesItem(signal.timeBytes));
+        table_->setItem(row, 4, new BytesItem(signal.indexBytes));
+        table_->setItem(row, 5, new BytesItem(signal.validityBytes));
+        table_->setItem(row, 6, new BytesItem(signal.chunkBytes));
+        table_->setItem(row, 7, new BytesItem(signal.TotalBytes()));
+    }
+    table_->setSortingEnabled(true);
+
+    const pat::MemoryGovernor& governor = pat::MemoryGovernor::Instance();
+    QStringList lines;
+    lines << tr("当前会话：%1（数值列 %2，时间轴 %3，时间索引 %4，有效位 %5，外存块缓存 %6，统计 %7）")
+                 .arg(FormatBytes(usage.TotalBytes()),
+                      FormatBytes(usage.ValueBytes()),
+                      FormatBytes(usage.TimeBytes()),
+                      FormatBytes(usage.IndexBytes()),
+                      FormatBytes(usage.ValidityBytes()),
+                      FormatBytes(usage.ChunkBytes()),
+                      FormatBytes(usage.statisticsBytes));
+    if (usage.chunkBudget > 0) {
+        lines << tr("外存模式：块缓存上限 %1，临时文件 %2").arg(FormatBytes(usage.chunkBudget), FormatBytes(usage.spilledBytes));
+    }
+    const qint64 budget = governor.Budget();
+    lines << tr("所有会话：%1 / 上限 %2").arg(FormatBytes(governor.TotalBytes()), budget > 0 ? FormatBytes(budget) : tr("不限"));
+    for (const auto& account : governor.Accounts()) {
+        if (account.bytes <= 0) continue;
+        lines << tr("  %1：%2").arg(account.label.isEmpty() ? tr("（未命名）") : account.label, FormatBytes(account.bytes));
+    }
+    summaryLabel_->setText(lines.join(QLatin1Char('\n')));
+}
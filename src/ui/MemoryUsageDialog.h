@@ -0,0 +1,23 @@
+﻿#pragma once
+
+#include "core/DataSession.h"
+
+#include <QDialog>
+
+class QLabel;
+class QTableWidget;
+
+// 内存占用面板：当前会话逐信号、按类别的常驻字节，以及进程内所有会话的合计与上限
+class MemoryUsageDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    MemoryUsageDialog(const pat::DataSession& session, QWidget* parent = nullptr);
+
+private:
+    void Refresh();
+
+    const pat::DataSession& session_;
+    QTableWidget* table_ = nullptr;
+    QLabel* summaryLabel_ = nullptr;
+};
@@ -0,0 +1,81 @@
+﻿#include "ui/PartialLoadDialog.h"
+
+#include <QDialogButtonBox>
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+#include <QLabel>
+#include <QRadioButton>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <limits>
+
+PartialLoadDialog::PartialLoadDialog(qint64 totalRecords, const QString& timeUnit, QWidget* parent) : QDialog(parent) {
+    setWindowTitle(tr("部分加载数据"));
+    setModal(true);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->addWidget(new QLabel(tr("文件共约 %1 条记录，只解码选定的一段；图表横轴为文件内的绝对时间。").arg(totalRecords), this));
+
+    // 记录序号用 0 位小数的 QDoubleSpinBox，超过 int 范围的大文件也能输入
+    const double maxRecord = static_cast<double>(std::max<qint64>(1, totalRecords));
+    byRecordButton_ = new QRadioButton(tr("按记录范围"), this);
+    firstRecordBox_ = new QDoubleSpinBox(this);
+    firstRecordBox_->setDecimals(0);
+    firstRecordBox_->setRange(0.0, maxRecord - 1.0);
+    recordCountBox_ = new QDoubleSpinBox(this);
+    recordCountBox_->setDecimals(0);
+    recordCountBox_->setRange(1.0, maxRecord);
+    recordCountBox_->setValue(std::min(maxRecord, 100000.0));
+    auto* recordForm = new QFormLayout();
+    recordForm->addRow(tr("起始记录"), firstRecordBox_);
+    recordForm->addRow(tr("记录数"), recordCountBox_);
+
+    byTimeButton_ = new QRadioButton(tr("按时间窗"), this);
+    const QString unit = timeUnit.trimmed().isEmpty() ? QStringLiteral("s") : timeUnit.trimmed();
+    startTimeBox_ = new QDoubleSpinBox(this);
+    endTimeBox_ = new QDoubleSpinBox(this);
+    for (auto* box : {startTimeBox_, endTimeBox_}) {
+        box->setDecimals(6);
+        box->setRange(0.0, std::numeric_limits<double>::max());
+        box->setSuffix(QStringLiteral(" ") + unit);
+    }
+    endTimeBox_->setValue(600.0);
+    auto* timeForm = new QFormLayout();
+    timeForm->addRow(tr("起点"), startTimeBox_);
+    timeForm->addRow(tr("终点"), endTimeBox_);
+
+    layout->addWidget(byRecordButton_);
+    layout->addLayout(recordForm);
+    layout->addWidget(byTimeButton_);
+    layout->addLayout(timeForm);
+
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    layout->addWidget(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(byRecordButton_, &QRadioButton::toggled, this, &PartialLoadDialog::UpdateEnabledState);
+
+    byTimeButton_->setChecked(true);
+    UpdateEnabledState();
+}
+
+bool PartialLoadDialog::Run(PartialLoadRequest& outRequest) {
+    if (exec() != QDialog::Accepted) {
+        return false;
+    }
+    outRequest.byTime = byTimeButton_->isChecked();
+    outRequest.range.firstRecord = static_cast<qint64>(firstRecordBox_->value());
+    outRequest.range.recordCount = static_cast<qint64>(recordCountBox_->value());
+    outRequest.startTime = startTimeBox_->value();
+    outRequest.endTime = endTimeBox_->value();
+    return true;
+}
+
+void PartialLoadDialog::UpdateEnabledState() {
+    const bool byRecord = byRecordButton_->isChecked();
+    firstRecordBox_->setEnabled(byRecord);
+    recordCountBox_->setEnabled(byRecord);
+    startTimeBox_->setEnabled(!byRecord);
+    endTimeBox_->setEnabled(!byRecord);
+}
@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include "core/RecordParser.h"
+
+#include <QDialog>
+#include <QString>
+
+class QDoubleSpinBox;
+class QRadioButton;
+
+struct PartialLoadRequest {
+    bool byTime = false;
+    pat::RecordRange range;
+    double startTime = 0.0;
+    double endTime = 0.0;
+};
+
+// 部分加载：按记录范围或时间窗选择要解码的一段数据
+class PartialLoadDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    PartialLoadDialog(qint64 totalRecords, const QString& timeUnit, QWidget* parent = nullptr);
+    bool Run(PartialLoadRequest& outRequest);
+
+private:
+    void UpdateEnabledState();
+
+    QRadioButton* byRecordButton_ = nullptr;
+    QRadioButton* byTimeButton_ = nullptr;
+    QDoubleSpinBox* firstRecordBox_ = nullptr;
+    QDoubleSpinBox* recordCountBox_ = nullptr;
+    QDoubleSpinBox* startTimeBox_ = nullptr;
+    QDoubleSpinBox* endTimeBox_ = nullptr;
+};
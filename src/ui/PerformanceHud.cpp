@@ -0,0 +1,67 @@
+﻿#include "ui/PerformanceHud.h"
+
+#include "core/MemoryGovernor.h"
+#include "core/PerfCounters.h"
+#include "core/ProcessMemory.h"
+#include "core/TaskScheduler.h"
+
+#include <QLocale>
+#include <QStringList>
+#include <QTimer>
+
+namespace {
+
+// 低频刷新即可，计数本身随时更新
+constexpr int kRefreshIntervalMs = 500;
+
+QString FormatBytes(qint64 bytes) {
+    return QLocale().formattedDataSize(bytes, 1, QLocale::DataSizeTraditionalFormat);
+}
+
+QString FormatMilliseconds(qint64 ns) {
+    return QStringLiteral("%1 ms").arg(static_cast<double>(ns) * 1e-6, 0, 'f', 1);
+}
+
+}  // namespace
+
+PerformanceHud::PerformanceHud(QWidget* parent) : QLabel(parent) {
+    setTextFormat(Qt::PlainText);
+    timer_ = new QTimer(this);
+    timer_->setInterval(kRefreshIntervalMs);
+    connect(timer_, &QTimer::timeout, this, &PerformanceHud::Refresh);
+    setVisible(false);
+}
+
+void PerformanceHud::SetActive(bool active) {
+    setVisible(active);
+    if (active) {
+        Refresh();
+        timer_->start();
+    } else {
+        timer_->stop();
+    }
+}
+
+void PerformanceHud::Refresh() {
+    const pat::PerfSnapshot perf = pat::PerfCounters::Instance().Snapshot();
+    QStringList parts;
+    if (perf.loadNs > 0) {
+        parts << tr("加载 %1 MB/s，%2 万条/s")
+                     .arg(perf.LoadMegabytesPerSecond(), 0, 'f', 0)
+                     .arg(perf.LoadRecordsPerSecond() * 1e-4, 0, 'f', 1);
+    }
+    // 抽稀耗时高说明慢在 CPU 抽稀，绘制耗时高说明慢在图表渲染
+    parts << tr("抽稀 %1，%2 点，上传 %3，绘制 %4，帧 %5")
+                 .arg(FormatMilliseconds(perf.decimateNs))
+                 .arg(perf.decimatedPoints)
+                 .arg(FormatMilliseconds(perf.uploadNs))
+                 .arg(FormatMilliseconds(perf.renderNs))
+                 .arg(perf.frameNs >= 0 ? FormatMilliseconds(perf.frameNs) : QStringLiteral("-"));
+    const double hitRate = perf.ChunkHitRate();
+    if (hitRate >= 0.0) parts << tr("外存块命中 %1%").arg(hitRate * 100.0, 0, 'f', 1);
+    parts << tr("内存 %1（解码数据 %2）")
+                 .arg(FormatBytes(pat::CurrentResidentBytes()), FormatBytes(pat::MemoryGovernor::Instance().TotalBytes()));
+    const pat::TaskSchedulerStats tasks = pat::TaskScheduler::Instance().Stats();
+    parts << tr("任务排队 %1").arg(tasks.QueuedTotal());
+    setText(parts.join(QStringLiteral("  |  ")));
+}
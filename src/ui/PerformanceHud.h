@@ -0,0 +1,21 @@
+﻿#pragma once
+
+#include <QLabel>
+
+class QTimer;
+
+// 状态栏中的性能信息：最近一次加载的吞吐量，最近一次缩放/平移的抽稀、上传点数、绘制与整帧耗时，
+// 外存块命中率与常驻内存。定时读取原子计数，不与解析、绘制争锁
+class PerformanceHud : public QLabel {
+    Q_OBJECT
+
+public:
+    explicit PerformanceHud(QWidget* parent = nullptr);
+
+    void SetActive(bool active);
+
+private:
+    void Refresh();
+
+    QTimer* timer_ = nullptr;
+};
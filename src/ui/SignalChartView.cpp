@@ -1,5 +1,8 @@
 ﻿#include "ui/SignalChartView.h"
 
+#include "core/PerfCounters.h"
+#include "core/SeriesQuery.h"
+#include "core/Trace.h"
 #include "ui/SignalTreeWidget.h"
 
 #include <QAction>
@@ -113,6 +116,7 @@ void SignalChartView::Configure(const QString& title,
             line->setName(title);
         }
         if (i < seriesSamples.size()) {
+            const pat::TraceScope trace("QLineSeries::replace", "ui");
             line->replace(seriesSamples[i]);
         }
         chart->addSeries(line);
@@ -208,11 +212,14 @@ void SignalChartView::Configure(const QString& title,
 }
 
 void SignalChartView::SetSeriesSamples(const QVector<QVector<QPointF>>& seriesSamples) {
+    const pat::TraceScope trace("QLineSeries::replace", "ui");
+    const qint64 startNs = pat::TraceRecorder::NowNs();
     for (int i = 0; i < series_.size() && i < seriesSamples.size(); ++i) {
         if (series_[i]) {
             series_[i]->replace(seriesSamples[i]);
         }
     }
+    pat::PerfCounters::Instance().RecordUpload(pat::TraceRecorder::NowNs() - startNs);
 }
 
 void SignalChartView::SetRangeContext(const ChartRangeContext& context) {
@@ -395,6 +402,14 @@ bool SignalChartView::viewportEvent(QEvent* event) {
         contextMenuEvent(ctx);
         return true;
     }
+    if (event && event->type() == QEvent::Paint) {
+        // 图表的渲染发生在视口重绘中，计入性能信息的绘制耗时
+        const pat::TraceScope trace("SignalChartView::paint", "ui");
+        const qint64 startNs = pat::TraceRecorder::NowNs();
+        const bool handled = QChartView::viewportEvent(event);
+        pat::PerfCounters::Instance().RecordPaint(pat::TraceRecorder::NowNs() - startNs);
+        return handled;
+    }
     return QChartView::viewportEvent(event);
 }
 
@@ -631,29 +646,8 @@ void SignalChartView::UpdateCursor(double cursorX) {
     for (int i = 0; i < valueLabels_.size() && i < seriesIndices_.size(); ++i) {
         const int idx = seriesIndices_[i];
         if (idx < 0 || idx >= sourceSeries_->size()) continue;
-        const auto& seriesData = sourceSeries_->at(idx);
-        if (seriesData.samples.isEmpty()) continue;
-
-        const double seriesMinX = seriesData.samples.first().x();
-        const double seriesMaxX = seriesData.samples.last().x();
-        double clampedX = cursorX;
-        if (clampedX < seriesMinX) clampedX = seriesMinX;
-        if (clampedX > seriesMaxX) clampedX = seriesMaxX;
-
-        auto begin = seriesData.samples.begin();
-        auto end = seriesData.samples.end();
-        auto it = std::lower_bound(begin, end, clampedX, [](const QPointF& p, double x) { return p.x() < x; });
         double value = 0.0;
-        if (it == begin) {
-            value = it->y();
-        } else if (it == end) {
-            value = (end - 1)->y();
-        } else {
-            const QPointF p0 = *(it - 1);
-            const QPointF p1 = *it;
-            const double dx = p1.x() - p0.x();
-            value = dx == 0.0 ? p1.y() : (p0.y() + (p1.y() - p0.y()) * (clampedX - p0.x()) / dx);
-        }
+        if (!pat::InterpolateSample(sourceSeries_->at(idx), cursorX, value)) continue;
 
         auto* label = valueLabels_[i];
         if (!label) continue;